@@ -3,18 +3,63 @@
 
 #include "trie.h"
 
+// 批量匹配时交错扫描的文档数
+#define AC_BATCH_LANES 8
+// 完全自动机每个状态都有完整的转移，使用数组状态转移表
+#define AC_FULL_STTABLE_TYPE STTABLE_TYPE_ARRAY
+// 不完全自动机只保存trie树转移，使用双数组状态转移表
+#define AC_PART_STTABLE_TYPE STTABLE_TYPE_DBARR
+
 typedef enum {
     AC_LEVEL_PART, // 不完全AC自动机
     AC_LEVEL_FULL  // 完全AC自动机
 } ACLevel;
 
+/**
+ * @brief 完全自动机的输出项
+ */
+typedef struct {
+    int len; // 模式串长度
+    int pid; // 模式串id
+} ac_output_t;
+
+/**
+ * @brief 完全自动机状态的输出列表，在输出项数组中连续存放
+ * 终止状态的列表为自身的模式串加上后缀状态的列表，非终止状态与其后缀状态共用列表
+ */
+typedef struct {
+    int off; // 首个输出项的下标
+    int num; // 输出项数
+} ac_outlist_t;
+
 typedef struct {
     Trie *trie;
     ACLevel level;
     int *suff; // 状态回溯表，当前状态的最长后缀模式串对应的状态
     int *next; // 不完全自动机，失配状态跳转表
+    int *outn; // 状态输出数，即当前状态及其后缀链上的模式串数
+    int size;  // suff、next、outn及失配树数组的容量
+    // 失配树，父节点为失配状态，构建后第一次增量插入或删除时建立
+    int *fkid;  // 首个失配状态为当前状态的状态，-1表示没有
+    int *fnext; // 失配状态相同的下一个状态
+    int *fprev; // 失配状态相同的上一个状态
+    // 完全自动机构建后按有无输出重新编号，无输出的状态在前，主循环只比较转移得到的状态id，
+    // 没有匹配时不访问状态表和后缀链
+    int out_min;        // 首个有输出的状态id
+    ac_outlist_t *outl; // 输出列表，下标为状态id - out_min
+    ac_output_t *outs;  // 输出项数组
 } AC;
 
+/**
+ * @brief AC自动机流式匹配上下文
+ * 保存分块之间的自动机状态，跨块的匹配不会丢失
+ */
+typedef struct {
+    const AC *ac;   // 自动机指针
+    int state;      // 当前自动机状态
+    int64_t offset; // 已扫描的字节数，即下一块首字符的绝对偏移
+} ac_stream_t;
+
 /**
  * @brief 创建AC自动机
  * 
@@ -23,6 +68,19 @@ typedef struct {
  */
 AC* ac_create(ACLevel level);
 
+/**
+ * @brief 创建使用指定状态转移表的AC自动机
+ * 完全自动机支持数组和混合表，混合表只保存各状态与失配链上稠密行不同的转移，
+ * 每个字符仍只查一次表，适合数组内存无法承受的大词典；不完全自动机支持可创建的全部类型，
+ * 转移稀疏时可选STTABLE_TYPE_BITMAP，内存与转移数成正比；
+ * STTABLE_TYPE_HYBRID对浅层和转移多的状态使用稠密行，兼顾速度和内存
+ * 
+ * @param level  自动机等级
+ * @param sttype 状态转移表类型
+ * @return AC* NULL表示类型不支持
+ */
+AC* ac_create_typed(ACLevel level, STTableType sttype);
+
 /**
  * @brief 创建AC自动机
  * 
@@ -42,14 +100,29 @@ void ac_destroy(AC *ac);
 
 /**
  * @brief 插入模式串
+ * 不完全自动机构建后仍可插入，只计算新状态的失配状态，并把失配树中受影响子树内
+ * 以新状态为最长后缀的状态改为失配到新状态，代价与受影响的状态数成正比；
+ * 完全自动机的状态转移已补全，构建后不能插入
  * 
  * @param ac   自动机指针
  * @param p    模式串
  * @param plen 模式串长度
- * @return int 终止状态id
+ * @return int 终止状态id，-1表示失败
  */
 int ac_insert(AC *ac, const char *p, int plen);
 
+/**
+ * @brief 删除模式串
+ * 终止状态改为非终止状态，只更新失配树中以该状态为根的子树的suff和outn，
+ * 状态本身保留在树中，再次插入相同模式串时复用；完全自动机构建后不能删除
+ * 
+ * @param ac   自动机指针
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return int 0:成功 -1:模式串不存在或不支持
+ */
+int ac_remove(AC *ac, const char *p, int plen);
+
 /**
  * @brief 构建AC自动机
  * 
@@ -57,6 +130,49 @@ int ac_insert(AC *ac, const char *p, int plen);
  */
 void ac_build(AC *ac);
 
+/**
+ * @brief 构建AC自动机，可选压缩字母表
+ * 完全自动机按模式串中出现的字节计算等价类，每个状态只保存等价类数项转移，
+ * 模式串使用的字节越少内存越小，匹配时每个字节仍只查一次表。
+ * 完全自动机构建后把有输出的状态重新编号到状态id的末段，并展平各状态的输出列表
+ * 
+ * @param ac       自动机指针
+ * @param compress 1:压缩字母表 0:不压缩，与ac_build相同
+ * @return int 0:成功 -1:失败（映像加载的自动机或内存不足），内存不足时自动机回到未构建状态，可重新构建
+ */
+int ac_build_ex(AC *ac, int compress);
+
+/**
+ * @brief 按广度优先顺序重新编号已构建的自动机状态
+ * 重排trie树状态和状态转移表后重新构建，suff、next、outn随之按新编号生成，
+ * 浅层状态集中在连续的缓存行中，适合在构建完成、开始匹配前调用一次。
+ * 完全自动机重新构建后仍按有无输出分段，map为分段后的最终编号
+ * 
+ * @param ac  自动机指针
+ * @param map 可为NULL，否则写入旧状态id对应的新状态id，大小不小于状态数
+ * @return int 0:成功 -1:内存不足，重排前失败时自动机保持不变，重新构建失败时自动机回到未构建状态
+ */
+int ac_relayout(AC *ac, int *map);
+
+/**
+ * @brief 将已构建的自动机保存为映像文件，散列表实现的状态转移表不支持
+ * 
+ * @param ac   自动机指针
+ * @param path 文件路径
+ * @return int 0:成功 -1:失败
+ */
+int ac_save(const AC *ac, const char *path);
+
+/**
+ * @brief 映射映像文件加载自动机，状态表、状态转移表和输出表直接使用映射的内存，
+ * 不重新插入模式串和构建，多个进程可共享映射的页面；加载的自动机只读，只能用于匹配
+ * 
+ * @param path   文件路径
+ * @param verify 1:校验全部内容的校验和 0:只校验文件头和段表
+ * @return AC* NULL表示文件无效
+ */
+AC* ac_load(const char *path, int verify);
+
 /**
  * @brief AC自动机字符串匹配
  * 
@@ -67,4 +183,132 @@ void ac_build(AC *ac);
  */
 void ac_search(const AC *ac, const char *s, int slen, match_result_t *result);
 
+/**
+ * @brief AC自动机字符串匹配，每个匹配项交给回调函数
+ * 
+ * @param ac   自动机指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param cb   回调函数，返回非0时停止匹配
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+int ac_search_cb(const AC *ac, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 按指定方式报告匹配
+ * 不重叠方式下每个位置只取状态的最长输出，候选起点早于当前状态对应子串的起点时即为最终结果，
+ * 输出后从匹配结尾由初始状态继续扫描，不遍历后缀链
+ * 
+ * @param ac     自动机指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param kind   报告方式
+ * @param result 匹配结果
+ */
+void ac_search_kind(const AC *ac, const char *s, int slen, MatchKind kind, match_result_t *result);
+
+/**
+ * @brief 按指定方式报告匹配，每个匹配项交给回调函数
+ * 
+ * @param ac   自动机指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param kind 报告方式
+ * @param cb   回调函数，返回非0时停止匹配
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+int ac_search_kind_cb(const AC *ac, const char *s, int slen, MatchKind kind, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 统计匹配数，不生成匹配结果
+ * 
+ * @param ac   自动机指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @return int64_t 匹配数
+ */
+int64_t ac_count(const AC *ac, const char *s, int slen);
+
+/**
+ * @brief 判断字符串中是否存在模式串，遇到第一个匹配即返回
+ * 
+ * @param ac   自动机指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @return int 1:存在 0:不存在
+ */
+int ac_contains(const AC *ac, const char *s, int slen);
+
+/**
+ * @brief 创建流式匹配上下文，自动机需已构建，且生命周期长于上下文
+ * 
+ * @param ac 自动机指针
+ * @return ac_stream_t* 
+ */
+ac_stream_t* ac_stream_create(const AC *ac);
+
+/**
+ * @brief 销毁流式匹配上下文
+ * 
+ * @param stream 
+ */
+void ac_stream_destroy(ac_stream_t *stream);
+
+/**
+ * @brief 重置流式匹配上下文，从新的流开始匹配
+ * 
+ * @param stream 
+ */
+void ac_stream_reset(ac_stream_t *stream);
+
+/**
+ * @brief 流式匹配，依次传入流的各个分块，匹配位置为流中的绝对偏移
+ * 
+ * @param stream 流式匹配上下文
+ * @param s      当前分块
+ * @param slen   分块长度
+ * @param result 匹配结果
+ */
+void ac_stream_search(ac_stream_t *stream, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 流式匹配，每个匹配项交给回调函数
+ * 被回调终止时上下文不再推进，继续使用前需重置
+ * 
+ * @param stream 流式匹配上下文
+ * @param s      当前分块
+ * @param slen   分块长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int ac_stream_search_cb(ac_stream_t *stream, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 批量匹配多个短文档
+ * 完全自动机同时交错扫描AC_BATCH_LANES个文档，各文档的状态转移互不依赖，访存延迟可以相互重叠；
+ * 不完全自动机逐个文档扫描
+ * 
+ * @param ac      自动机指针
+ * @param docs    文档数组
+ * @param ndocs   文档数
+ * @param results 匹配结果数组，results[i]接收docs[i]的匹配项
+ */
+void ac_search_batch(const AC *ac, const match_doc_t *docs, int ndocs, match_result_t *results[]);
+
+/**
+ * @brief 批量匹配多个短文档，每个匹配项连同文档下标交给回调函数
+ * 不同文档的匹配项交错输出，同一文档的匹配项按结束位置有序
+ * 
+ * @param ac    自动机指针
+ * @param docs  文档数组
+ * @param ndocs 文档数
+ * @param cb    回调函数，返回非0时停止匹配
+ * @param ctx   回调上下文
+ * @return int  0:扫描完成 -1:被回调终止
+ */
+int ac_search_batch_cb(const AC *ac, const match_doc_t *docs, int ndocs, match_batch_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
@@ -9,12 +9,14 @@
 
 typedef struct {
     int len;
+    int id; // 模式串id
     char str[BNDM_MAX_PATTERN_LEN];
 } _bndm_pattern_t;
 
 typedef struct {
     int pnum;    // 模式串数量
     int min_len; // 最小模式串长度
+    int id_num;  // 已分配的模式串id数，每次插入递增
     bit_array_t int_mask;           // 初始状态位掩码
     bit_array_t fin_mask;           // 终止状态位掩码
     bit_array_t mask[CHARSET_SIZE]; // 字符位掩码表
@@ -71,4 +73,16 @@ void bndm_nfa_build(BndmNFA *nfa);
  */
 void bndm_nfa_search(const BndmNFA *nfa, const char *s, int slen, match_result_t *result);
 
+/**
+ * @brief 在bndm nfa上搜索，每个匹配项交给回调函数
+ * 
+ * @param nfa    bndm nfa指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int bndm_nfa_search_cb(const BndmNFA *nfa, const char *s, int slen, match_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "trie.h"
 
 #define DAT_NODE_DEFAULT_NUM 1024
+// 节点数组每次扩展的最小节点数，扩展时容量至少翻倍
 #define DAT_NODE_INCREMT_NUM 1024
 #define DAT_TAIL_DEFAULT_LEN 1024
 #define DAT_TAIL_INCREMT_LEN 1024
@@ -21,6 +22,7 @@ typedef struct {
 
 /**
  * @brief reduced-trie树字符串后缀结构
+ * 每个后缀字符串以'\0'结尾，其后紧跟int类型的模式串id
  */
 typedef struct {
     int len;   // tail长度
@@ -38,8 +40,12 @@ typedef struct {
  */
 typedef struct {
     int cap;
+    int id_num;        // 已分配的模式串id数，每次插入递增
+    int max_len;       // 最大模式串长度
     dat_node_t *nodes; // trie树节点数组
     dat_tail_t tail;   // 字符串后缀
+    dbfree_t free;     // 节点数组的空闲单元，check为0的单元
+    sm_image_t *image; // 加载的映像，非NULL时节点数组和后缀位于映射中，只能用于匹配
 } DATrie;
 
 /**
@@ -85,6 +91,25 @@ void dat_build(DATrie *dat);
  */
 void dat_delete(DATrie *dat, const char *p, int plen);
 
+/**
+ * @brief 将trie树保存为映像文件
+ * 
+ * @param dat  树指针
+ * @param path 文件路径
+ * @return int 0:成功 -1:失败
+ */
+int dat_save(const DATrie *dat, const char *path);
+
+/**
+ * @brief 映射映像文件加载trie树，节点数组和后缀直接使用映射的内存，
+ * 多个进程可共享映射的页面；加载的树只读，不能再插入或删除模式串
+ * 
+ * @param path   文件路径
+ * @param verify 1:校验全部内容的校验和 0:只校验文件头和段表
+ * @return DATrie* NULL表示文件无效
+ */
+DATrie* dat_load(const char *path, int verify);
+
 /**
  * @brief 搜索字符串
  * 
@@ -95,4 +120,41 @@ void dat_delete(DATrie *dat, const char *p, int plen);
  */
 void dat_search(const DATrie *dat, const char *s, int slen, match_result_t *result);
 
+/**
+ * @brief 搜索字符串，每个匹配项交给回调函数
+ * 
+ * @param dat    树指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int dat_search_cb(const DATrie *dat, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 按指定方式报告匹配
+ * 不重叠方式下只在当前起点选出一个匹配，找到后从匹配结尾继续，否则起点后移一个字符
+ * 
+ * @param dat    树指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param kind   报告方式
+ * @param result 匹配结果
+ */
+void dat_search_kind(const DATrie *dat, const char *s, int slen, MatchKind kind, match_result_t *result);
+
+/**
+ * @brief 按指定方式报告匹配，每个匹配项交给回调函数
+ * 
+ * @param dat  树指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param kind 报告方式
+ * @param cb   回调函数，返回非0时停止匹配
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+int dat_search_kind_cb(const DATrie *dat, const char *s, int slen, MatchKind kind, match_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 #include "trie.h"
 
+// 反转模式串trie树的状态转移表类型
+#define HSP_STTABLE_TYPE STTABLE_TYPE_DBARR
+
 typedef struct {
     Trie* trie;     // trie树
     int size;       // 位移表大小
@@ -63,4 +66,16 @@ void horspool_build(Horspool *hsp);
  */
 void horspool_trie_search(const Horspool *hsp, const char *s, int slen, match_result_t *result);
 
+/**
+ * @brief 多模式串horspool匹配算法，每个匹配项交给回调函数
+ * 
+ * @param hsp    Horspool指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int horspool_trie_search_cb(const Horspool *hsp, const char *s, int slen, match_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
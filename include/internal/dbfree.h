@@ -0,0 +1,162 @@
+#ifndef _DBFREE_H
+#define _DBFREE_H
+
+#include <stdlib.h>
+#include "sttable.h"
+
+/**
+ * 双数组空闲单元链表，供sttable双数组和DATrie构建时寻找基数
+ * 参考darts/cedar：只遍历空闲单元，尝试失败的单元移到链表尾部，
+ * 尝试次数超过DBFREE_MAX_TRIAL时直接在已占用区域之后分配，构建耗时与模式串规模近似线性
+ */
+
+/**
+ * @brief 扩展单元数，新增单元全部加入链表尾部
+ * 
+ * @param f   链表指针
+ * @param cap 新单元数
+ * @return int 0:成功 -1:失败
+ */
+static int dbfree_extend(dbfree_t *f, int cap) {
+    if (cap <= f->cap) {
+        return 0;
+    }
+    int *next = (int *)realloc(f->next, sizeof(int) * cap);
+    if (next == NULL) {
+        return -1;
+    }
+    f->next = next;
+    int *prev = (int *)realloc(f->prev, sizeof(int) * cap);
+    if (prev == NULL) {
+        return -1;
+    }
+    f->prev = prev;
+    for (int i = f->cap; i < cap; i++) {
+        if (f->head == -1) {
+            f->head = i;
+            next[i] = prev[i] = i;
+        } else {
+            int tail = prev[f->head];
+            next[tail] = i;
+            prev[i] = tail;
+            next[i] = f->head;
+            prev[f->head] = i;
+        }
+    }
+    f->cap = cap;
+    return 0;
+}
+
+/**
+ * @brief 初始化，全部单元空闲
+ * 
+ * @param f   链表指针
+ * @param cap 单元数
+ * @return int 0:成功 -1:失败
+ */
+static int dbfree_init(dbfree_t *f, int cap) {
+    f->cap = 0;
+    f->used = 0;
+    f->head = -1;
+    f->next = NULL;
+    f->prev = NULL;
+    return dbfree_extend(f, cap);
+}
+
+static void dbfree_destroy(dbfree_t *f) {
+    free(f->next);
+    free(f->prev);
+}
+
+/**
+ * @brief 单元是否空闲，超出数组的单元视为空闲
+ */
+static inline int dbfree_is_free(const dbfree_t *f, int i) {
+    return i >= f->cap || f->next[i] >= 0;
+}
+
+/**
+ * @brief 占用单元，从链表中移除
+ * 
+ * @param f 链表指针
+ * @param i 单元下标，须小于f->cap
+ */
+static void dbfree_remove(dbfree_t *f, int i) {
+    if (f->next[i] < 0) {
+        return;
+    }
+    if (i >= f->used) {
+        f->used = i + 1;
+    }
+    if (f->next[i] == i) {
+        f->head = -1;
+    } else {
+        f->next[f->prev[i]] = f->next[i];
+        f->prev[f->next[i]] = f->prev[i];
+        if (f->head == i) {
+            f->head = f->next[i];
+        }
+    }
+    f->next[i] = f->prev[i] = -1;
+}
+
+/**
+ * @brief 释放单元，加入链表尾部
+ * 
+ * @param f 链表指针
+ * @param i 单元下标，须小于f->cap
+ */
+static void dbfree_add(dbfree_t *f, int i) {
+    if (f->next[i] >= 0) {
+        return;
+    }
+    if (f->head == -1) {
+        f->head = i;
+        f->next[i] = f->prev[i] = i;
+        return;
+    }
+    int tail = f->prev[f->head];
+    f->next[tail] = i;
+    f->prev[i] = tail;
+    f->next[i] = f->head;
+    f->prev[f->head] = i;
+}
+
+/**
+ * @brief 寻找基数，使base + list[i]全部空闲
+ * 以最小字符对齐每个空闲单元尝试，失败的单元移到链表尾部，
+ * 尝试DBFREE_MAX_TRIAL次仍失败时返回已占用区域之后的基数，调用方负责扩展数组
+ * 
+ * @param f    链表指针
+ * @param list 转移字符集合
+ * @param num  转移字符数，不小于1
+ * @param end  输出数组所需的最小单元数，即base + 最大字符 + 1
+ * @return int 基数值
+ */
+static int dbfree_find_base(dbfree_t *f, const char *list, int num, int *end) {
+    int minc = CHARSET_SIZE;
+    int maxc = 0;
+    for (int i = 0; i < num; i++) {
+        int c = (unsigned char)list[i];
+        minc = c < minc ? c : minc;
+        maxc = c > maxc ? c : maxc;
+    }
+    for (int trial = 0; trial < DBFREE_MAX_TRIAL && f->head != -1; trial++) {
+        int e = f->head;
+        int base = e - minc;
+        int ok = base >= 0;
+        for (int i = 0; ok && i < num; i++) {
+            ok = dbfree_is_free(f, base + (unsigned char)list[i]);
+        }
+        if (ok) {
+            *end = base + maxc + 1;
+            return base;
+        }
+        f->head = f->next[e];
+    }
+    int base = f->used > minc ? f->used - minc : 0;
+    *end = base + maxc + 1;
+    return base;
+}
+
+#endif
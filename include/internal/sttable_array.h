@@ -1,4 +1,5 @@
 #include "trie.h"
+#include "internal/sttable_get.h"
 
 /**
  * @brief 数组设置状态转移
@@ -10,14 +11,17 @@
  * @return int 0:成功 -1:失败
  */
 static int sttable_array_set(struct _sttable_array_s *tbl, int fid, char c, int tid) {
-    int index = fid * CHARSET_SIZE + c;
-    if (tid * CHARSET_SIZE >= tbl->size) {
+    int index = fid * tbl->cnum + tbl->cls[(unsigned char)c];
+    if ((tid + 1) * tbl->cnum > tbl->size) {
         int size = tbl->size * 2;
+        while ((tid + 1) * tbl->cnum > size) {
+            size *= 2;
+        }
         int *stt = (int*)realloc(tbl->stt, size * sizeof(int));
         if (stt == NULL) {
             return -1;
         }
-        memset(stt + tbl->size, -1, tbl->size * sizeof(int));
+        memset(stt + tbl->size, -1, (size - tbl->size) * sizeof(int));
         tbl->size = size;
         tbl->stt = stt;
     }
@@ -26,13 +30,33 @@ static int sttable_array_set(struct _sttable_array_s *tbl, int fid, char c, int
 }
 
 /**
- * @brief 数组获取状态转移
+ * @brief 恢复为每个状态CHARSET_SIZE项，等价类内的字节展开为相同的转移
+ * 从后向前原地展开，每行先读入缓冲区，写入位置不会覆盖前面尚未展开的行
  * 
- * @param tbl 表指针
- * @param id  源状态id
- * @param c   转移字符
- * @return int 目标状态id
+ * @param tbl 表指针，须为32位状态ID
+ * @return int 0:成功 -1:内存不足
  */
-static int sttable_array_get(struct _sttable_array_s *tbl, int id, char c) {
-    return tbl->stt[id * CHARSET_SIZE + c];
-}
\ No newline at end of file
+static int sttable_array_expand(struct _sttable_array_s *tbl) {
+    if (tbl->cnum >= CHARSET_SIZE) {
+        return 0;
+    }
+    int rows = tbl->size / tbl->cnum;
+    int *stt = (int *)realloc(tbl->stt, sizeof(int) * rows * CHARSET_SIZE);
+    if (stt == NULL) {
+        return -1;
+    }
+    int row[CHARSET_SIZE];
+    for (int i = rows - 1; i >= 0; i--) {
+        memcpy(row, stt + i * tbl->cnum, sizeof(int) * tbl->cnum);
+        for (int c = 0; c < CHARSET_SIZE; c++) {
+            stt[i * CHARSET_SIZE + c] = row[tbl->cls[c]];
+        }
+    }
+    for (int c = 0; c < CHARSET_SIZE; c++) {
+        tbl->cls[c] = (uint8_t)c;
+    }
+    tbl->cnum = CHARSET_SIZE;
+    tbl->size = rows * CHARSET_SIZE;
+    tbl->stt = stt;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#ifndef _STTABLE_BITMAP_H
+#define _STTABLE_BITMAP_H
+
+#include "trie.h"
+#include "internal/sttable_get.h"
+
+/**
+ * @brief 初始化位图稀疏表
+ *
+ * @param tbl 表指针
+ */
+static void sttable_bitmap_init(struct _sttable_bitmap_s *tbl) {
+    tbl->nsize = DEFAULT_STATE_NUM;
+    tbl->nodes = (sttable_bitmap_node_t *)calloc(DEFAULT_STATE_NUM, sizeof(sttable_bitmap_node_t));
+    tbl->tsize = STTABLE_BITMAP_DEFAULT_SIZE;
+    tbl->tids = (int *)malloc(sizeof(int) * STTABLE_BITMAP_DEFAULT_SIZE);
+    tbl->tused = 0;
+}
+
+/**
+ * @brief 状态的转移数
+ *
+ * @param node 状态节点
+ * @return int 转移数
+ */
+static inline int sttable_bitmap_num(const sttable_bitmap_node_t *node) {
+    return node->rank[3] + sttable_popcount64(node->bits[3]);
+}
+
+/**
+ * @brief 状态节点数组扩展，容量翻倍直到大于id，新节点没有转移
+ *
+ * @param tbl 表指针
+ * @param id  状态id
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_bitmap_extend(struct _sttable_bitmap_s *tbl, int id) {
+    if (id < tbl->nsize) {
+        return 0;
+    }
+    int nsize = tbl->nsize * 2;
+    while (nsize <= id) {
+        nsize *= 2;
+    }
+    sttable_bitmap_node_t *nodes = (sttable_bitmap_node_t *)realloc(tbl->nodes, sizeof(sttable_bitmap_node_t) * nsize);
+    if (nodes == NULL) {
+        return -1;
+    }
+    memset(nodes + tbl->nsize, 0, sizeof(sttable_bitmap_node_t) * (nsize - tbl->nsize));
+    tbl->nodes = nodes;
+    tbl->nsize = nsize;
+    return 0;
+}
+
+/**
+ * @brief 为状态分配容量为cap的目标状态段，并拷贝已有的num个目标状态
+ * 原段位于数组末尾时原地扩展，否则在末尾分配新段，原段不再使用
+ *
+ * @param tbl  表指针
+ * @param node 状态节点
+ * @param num  已有的转移数
+ * @param cap  新容量
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_bitmap_grow(struct _sttable_bitmap_s *tbl, sttable_bitmap_node_t *node, int num, int cap) {
+    int off = num > 0 && node->off + num == tbl->tused ? node->off : tbl->tused;
+    if (off + cap > tbl->tsize) {
+        int tsize = tbl->tsize * 2;
+        while (tsize < off + cap) {
+            tsize *= 2;
+        }
+        int *tids = (int *)realloc(tbl->tids, sizeof(int) * tsize);
+        if (tids == NULL) {
+            return -1;
+        }
+        tbl->tids = tids;
+        tbl->tsize = tsize;
+    }
+    if (off != node->off && num > 0) {
+        memcpy(tbl->tids + off, tbl->tids + node->off, sizeof(int) * num);
+    }
+    node->off = off;
+    tbl->tused = off + cap;
+    return 0;
+}
+
+/**
+ * @brief 位图稀疏表设置状态转移，新转移按字符顺序插入目标状态段
+ *
+ * @param tbl 表指针
+ * @param fid 源状态
+ * @param c   转移字符
+ * @param tid 目标状态
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_bitmap_set(struct _sttable_bitmap_s *tbl, int fid, char c, int tid) {
+    // 目标状态也须有节点，查询时不判断越界
+    if (sttable_bitmap_extend(tbl, fid > tid ? fid : tid) != 0) {
+        return -1;
+    }
+    unsigned char uc = (unsigned char)c;
+    sttable_bitmap_node_t *node = &tbl->nodes[fid];
+    int w = uc >> 6;
+    uint64_t bit = 1ull << (uc & 63);
+    int idx = node->rank[w] + sttable_popcount64(node->bits[w] & (bit - 1));
+    if (node->bits[w] & bit) {
+        tbl->tids[node->off + idx] = tid;
+        return 0;
+    }
+    int num = sttable_bitmap_num(node);
+    // 容量为不小于转移数的2的幂，转移数为0或2的幂时段已满
+    if ((num & (num - 1)) == 0 && sttable_bitmap_grow(tbl, node, num, num > 0 ? num * 2 : 1) != 0) {
+        return -1;
+    }
+    int *tids = tbl->tids + node->off;
+    memmove(tids + idx + 1, tids + idx, sizeof(int) * (num - idx));
+    tids[idx] = tid;
+    node->bits[w] |= bit;
+    for (int i = w + 1; i < 4; i++) {
+        node->rank[i]++;
+    }
+    return 0;
+}
+
+#endif
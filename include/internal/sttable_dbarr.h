@@ -1,4 +1,6 @@
 #include "trie.h"
+#include "internal/sttable_get.h"
+#include "internal/dbfree.h"
 
 /**
  * @brief 获取转移字符集合
@@ -11,7 +13,6 @@
 static int sttable_dbarr_list_child(char *list, TrieState *states, int id) {
     int num = 0;
     int child = states[id].first;
-    TrieState *state = NULL;
     while (child != 0) {
         list[num++] = states[child].c;
         child = states[child].next;
@@ -20,65 +21,62 @@ static int sttable_dbarr_list_child(char *list, TrieState *states, int id) {
 }
 
 /**
- * @brief 内存扩展
+ * @brief 内存扩展，容量翻倍直到不小于size
  * 
  * @param tbl  表指针
+ * @param size 最小容量
  * @return int 0:成功 -1:失败
  */
-static int sttable_dbarr_extend(struct _sttable_dbarr_s *tbl) {
-    int size = tbl->tsize * 2;
-    int *target = (int *)realloc(tbl->target, sizeof(int) * size);
-    if (target == NULL) {
+static int sttable_dbarr_extend(struct _sttable_dbarr_s *tbl, int size) {
+    if (size <= tbl->tsize) {
+        return 0;
+    }
+    int tsize = tbl->tsize * 2;
+    while (tsize < size) {
+        tsize *= 2;
+    }
+    sttable_dbarr_cell_t *cells = (sttable_dbarr_cell_t *)realloc(tbl->cells, sizeof(sttable_dbarr_cell_t) * tsize);
+    if (cells == NULL) {
+        return -1;
+    }
+    memset(cells + tbl->tsize, -1, sizeof(sttable_dbarr_cell_t) * (tsize - tbl->tsize));
+    tbl->cells = cells;
+    if (dbfree_extend(&tbl->free, tsize) != 0) {
         return -1;
     }
-    memset(target + tbl->tsize, 0, sizeof(int) * tbl->tsize);
-    tbl->tsize = size;
-    tbl->target = target;
+    tbl->tsize = tsize;
     return 0;
 }
 
 /**
- * @brief 计算合法的基数值
+ * @brief 找到使全部转移字符都落在空闲单元的基数，并在基数之后保留CHARSET_SIZE个单元
  * 
  * @param tbl  表指针
- * @param base 基数初始值
- * @param c    转移字符
- * @return int 基数值
+ * @param list 转移字符集合
+ * @param num  转移字符数
+ * @return int -1:失败（内存不足）0-n:基数值
  */
-static int sttable_dbarr_find_base(struct _sttable_dbarr_s *tbl, int base, char c) {
-    int nid = base + c;
-    while (nid < tbl->tsize && tbl->target[nid] != 0) {
-        ++nid;
-    }
-    if (nid >= tbl->tsize) {
-        if (sttable_dbarr_extend(tbl) != 0) {
-            return -1;
-        }
+static int sttable_dbarr_find_base(struct _sttable_dbarr_s *tbl, char *list, int num) {
+    int end = 0;
+    int base = dbfree_find_base(&tbl->free, list, num, &end);
+    if (sttable_dbarr_extend(tbl, base + CHARSET_SIZE) != 0) {
+        return -1;
     }
-    return nid - c;
+    return base;
 }
 
 /**
- * @brief 找到合适的base值
+ * @brief 占用单元
  * 
- * @param tbl  表指针
- * @param base 初始base值
- * @param str  字符数组
- * @param len  字符数
- * @return int -1:失败（内存不足）0-n:base值
+ * @param tbl 表指针
+ * @param pos 单元位置
+ * @param fid 来源状态id
+ * @param tid 目标状态id
  */
-static int sttable_dbarr_find_base_ex(struct _sttable_dbarr_s *tbl, int base, char *str, int len) {
-    int valid_base = -1;
-    while (base != valid_base) {
-        valid_base = base;
-        for (int i = 0; i < len; i++) {
-            base = sttable_dbarr_find_base(tbl, base, str[i]);
-            if (base < 0) {
-                return -1;
-            }
-        }
-    }
-    return base;
+static inline void sttable_dbarr_use(struct _sttable_dbarr_s *tbl, int pos, int fid, int tid) {
+    tbl->cells[pos].check = fid;
+    tbl->cells[pos].tid = tid;
+    dbfree_remove(&tbl->free, pos);
 }
 
 /**
@@ -94,10 +92,12 @@ static int sttable_dbarr_find_base_ex(struct _sttable_dbarr_s *tbl, int base, ch
 static void sttable_dbarr_change_base(struct _sttable_dbarr_s *tbl, 
     int fid, int old_base, int new_base, char* list, int num) {
     for (int i = 0; i < num; i++) {
-        int old_tid = old_base + list[i];
-        int new_tid = new_base + list[i];
-        tbl->target[new_tid] = tbl->target[old_tid];
-        tbl->target[old_tid] = 0;
+        int old_tid = old_base + (unsigned char)list[i];
+        int new_tid = new_base + (unsigned char)list[i];
+        sttable_dbarr_use(tbl, new_tid, fid, tbl->cells[old_tid].tid);
+        tbl->cells[old_tid].check = -1;
+        tbl->cells[old_tid].tid = -1;
+        dbfree_add(&tbl->free, old_tid);
     }
     tbl->base[fid] = new_base;
 }
@@ -113,25 +113,23 @@ static void sttable_dbarr_change_base(struct _sttable_dbarr_s *tbl,
 static int sttable_dbarr_handle_crash(struct _sttable_dbarr_s *tbl, int fid, int cid) {
     char flist[CHARSET_SIZE];
     int fnum = sttable_dbarr_list_child(flist, tbl->trie->states, fid);
-    if (fnum == 1) {
-        int base = sttable_dbarr_find_base(tbl, 0, flist[0]);
-        tbl->base[fid] = base;
-        tbl->target[base + flist[0]] = tbl->trie->states[fid].first;
-        return 0;
-    }
     char clist[CHARSET_SIZE];
     int cnum = sttable_dbarr_list_child(clist, tbl->trie->states, cid);
-    if (fnum <= cnum) {
-        int old_base = tbl->base[fid];
-        int new_base = sttable_dbarr_find_base_ex(tbl, old_base, flist, fnum);
-        sttable_dbarr_change_base(tbl, fid, old_base, new_base, flist + 1, fnum - 1);
+    // 移动子节点较少的一方，新转移flist[0]尚未写入，不需要移动
+    if (fnum <= cnum || fnum == 1) {
+        int new_base = sttable_dbarr_find_base(tbl, flist, fnum);
+        if (new_base < 0) {
+            return -1;
+        }
+        sttable_dbarr_change_base(tbl, fid, tbl->base[fid], new_base, flist + 1, fnum - 1);
     } else {
-        int old_base = tbl->base[cid];
-        int new_base = sttable_dbarr_find_base_ex(tbl, old_base, clist, cnum);
-        sttable_dbarr_change_base(tbl, cid, old_base, new_base, clist, cnum);
+        int new_base = sttable_dbarr_find_base(tbl, clist, cnum);
+        if (new_base < 0) {
+            return -1;
+        }
+        sttable_dbarr_change_base(tbl, cid, tbl->base[cid], new_base, clist, cnum);
     }
-    int tid = tbl->base[fid] + flist[0];
-    tbl->target[tid] = tbl->trie->states[fid].first;
+    sttable_dbarr_use(tbl, tbl->base[fid] + (unsigned char)flist[0], fid, tbl->trie->states[fid].first);
     return 0;
 }
 
@@ -155,35 +153,23 @@ static int sttable_dbarr_set(struct _sttable_dbarr_s *tbl, int fid, char c, int
         tbl->bsize = size;
         tbl->base = base;
     }
-    int pos = tbl->base[fid] + c;
-    if (pos >= tbl->tsize) {
-        sttable_dbarr_extend(tbl);
+    // 源状态的第一个子节点，直接从空闲单元中选取基数，无需处理冲突
+    const TrieState *states = tbl->trie->states;
+    if (states[fid].first == tid && states[tid].next == 0) {
+        int base = sttable_dbarr_find_base(tbl, &c, 1);
+        if (base < 0) {
+            return -1;
+        }
+        tbl->base[fid] = base;
+    }
+    int pos = tbl->base[fid] + (unsigned char)c;
+    int check = tbl->cells[pos].check;
+    if (check == -1) {
+        sttable_dbarr_use(tbl, pos, fid, tid);
+    } else if (check != fid) {
+        return sttable_dbarr_handle_crash(tbl, fid, check);
+    } else {
+        tbl->cells[pos].tid = tid;
     }
-    int id = tbl->target[pos];
-    if (id == 0) {
-        tbl->target[pos] = tid;
-    } else if (id != tid) {
-        sttable_dbarr_handle_crash(tbl, fid, tbl->trie->states[id].parent);
-    } else {}
     return 0;
 }
-
-/**
- * @brief 获取转移状态
- * 
- * @param tbl 表指针
- * @param id  源状态id
- * @param c   转移字符
- * @return int 目标状态id
- */
-static int sttable_dbarr_get(struct _sttable_dbarr_s *tbl, int id, char c) {
-    int pos = tbl->base[id] + c;
-    if (pos >= tbl->tsize) {
-        return -1;
-    }
-    int tid = tbl->target[pos];
-    if (tid > 0 && tbl->trie->states[tid].parent == id) {
-        return tid;
-    }
-    return -1;
-}
\ No newline at end of file
@@ -0,0 +1,314 @@
+#ifndef _STTABLE_GET_H
+#define _STTABLE_GET_H
+
+#include "trie.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * 各状态转移表的查询函数
+ * 强制内联，供匹配主循环直接展开，sttable_get的类型分发只用于构建阶段
+ */
+
+/**
+ * @brief 计算hash值
+ * 
+ * @param id 源状态id
+ * @param c  转移字符
+ * @param base hash桶基数
+ * @return int hash值
+ */
+SM_INLINE int sttable_hasht_hash(int id, char c, int base) {
+    int hash = id * 31 + c;
+    return (hash ^ (hash >> base)) & ((1 << base) - 1);
+}
+
+/**
+ * @brief 有序子节点数组获取状态转移
+ * 转移很少时逐个比较，不超过STTABLE_LIST_SIMD_MAX时SSE2一次比较16个字节，否则二分查找
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_list_get(const struct _sttable_list_s *tbl, int id, char c) {
+    const sttable_list_node_t *node = &tbl->nodes[id];
+    const uint8_t *chars = tbl->chars + node->off;
+    int num = node->num;
+    if (num <= STTABLE_LIST_SCAN_MAX) {
+        for (int i = 0; i < num; i++) {
+            if (chars[i] == (unsigned char)c) {
+                return tbl->tids[node->off + i];
+            }
+        }
+        return -1;
+    }
+#if defined(__SSE2__)
+    if (num <= STTABLE_LIST_SIMD_MAX) {
+        __m128i k = _mm_set1_epi8(c);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)chars), k));
+        if (num > 16) {
+            mask |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(chars + 16)), k)) << 16;
+        }
+        // 段外的字节属于其他状态或填充，只保留前num位
+        mask &= (uint32_t)((1ull << num) - 1);
+        return mask != 0 ? tbl->tids[node->off + __builtin_ctz(mask)] : -1;
+    }
+#endif
+    unsigned char uc = (unsigned char)c;
+    int lo = 0;
+    int hi = num;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (chars[mid] < uc) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < num && chars[lo] == uc ? tbl->tids[node->off + lo] : -1;
+}
+
+/**
+ * @brief 数组获取状态转移
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id
+ */
+SM_INLINE int sttable_array_get(const struct _sttable_array_s *tbl, int id, char c) {
+    return tbl->stt[id * tbl->cnum + tbl->cls[(unsigned char)c]];
+}
+
+/**
+ * @brief 16位数组获取状态转移
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_array16_get(const struct _sttable_array_s *tbl, int id, char c) {
+    int tid = tbl->stt16[id * tbl->cnum + tbl->cls[(unsigned char)c]];
+    return tid == STTABLE_ARRAY16_NONE ? -1 : tid;
+}
+
+/**
+ * @brief 散列表获取状态转移
+ * 
+ * @param tbl 表指针
+ * @param id  源状态
+ * @param c   转移字符
+ * @return int 目标状态，-1表示不存在
+ */
+SM_INLINE int sttable_hasht_get(const struct _sttable_hasht_s *tbl, int id, char c) {
+    int h = sttable_hasht_hash(id, c, tbl->base);
+    const stlist_node_t *node = tbl->lists[h].first;
+    while (node != NULL) {
+        if (node->fid == id && node->c == c) {
+            return node->tid;
+        }
+        node = node->next;
+    }
+    return -1;
+}
+
+/**
+ * @brief 双数组获取状态转移
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_dbarr_get(const struct _sttable_dbarr_s *tbl, int id, char c) {
+    const sttable_dbarr_cell_t *cell = &tbl->cells[tbl->base[id] + (unsigned char)c];
+    return cell->check == id ? cell->tid : -1;
+}
+
+/**
+ * @brief 开放寻址散列表定位起始桶，乘法散列取高位，相邻状态和字符也能均匀分散
+ * 
+ * @param key  键(fid << 8 | c)
+ * @param bits 桶数位数
+ * @return uint32_t 桶下标
+ */
+SM_INLINE uint32_t sttable_ohash_bucket(uint32_t key, int bits) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+/**
+ * @brief 在桶内查找键，SSE2下一次比较4个键
+ * 
+ * @param bkt 桶指针
+ * @param key 键
+ * @return int 槽位下标，-1表示不存在
+ */
+SM_INLINE int sttable_ohash_find(const sttable_ohash_bucket_t *bkt, uint32_t key) {
+#if defined(__SSE2__)
+    __m128i k = _mm_set1_epi32((int)key);
+    __m128i lo = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)bkt->keys), k);
+    __m128i hi = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)(bkt->keys + 4)), k);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(lo)) | (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4);
+    return mask != 0 ? __builtin_ctz(mask) : -1;
+#else
+    for (int i = 0; i < STTABLE_OHASH_SLOTS; i++) {
+        if (bkt->keys[i] == key) {
+            return i;
+        }
+    }
+    return -1;
+#endif
+}
+
+/**
+ * @brief 开放寻址散列表获取状态转移
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_ohash_get(const struct _sttable_ohash_s *tbl, int id, char c) {
+    uint32_t key = (uint32_t)id << 8 | (unsigned char)c;
+    uint32_t mask = (1u << tbl->bits) - 1;
+    uint32_t b = sttable_ohash_bucket(key, tbl->bits);
+    for (int p = 0; p < tbl->max_probe; p++) {
+        const sttable_ohash_bucket_t *bkt = &tbl->buckets[(b + p) & mask];
+        int slot = sttable_ohash_find(bkt, key);
+        if (slot >= 0) {
+            return bkt->tids[slot];
+        }
+        // 桶未满说明探测链到此结束
+        if (bkt->keys[STTABLE_OHASH_SLOTS - 1] == STTABLE_OHASH_EMPTY) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 统计64位整数的置位数，不支持popcnt指令时使用分组求和
+ * 
+ * @param x 整数
+ * @return int 置位数
+ */
+SM_INLINE int sttable_popcount64(uint64_t x) {
+#if defined(__POPCNT__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * @brief 位图稀疏表获取状态转移，下标为位图中低于c的置位数
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_bitmap_get(const struct _sttable_bitmap_s *tbl, int id, char c) {
+    unsigned char uc = (unsigned char)c;
+    const sttable_bitmap_node_t *node = &tbl->nodes[id];
+    uint64_t word = node->bits[uc >> 6];
+    uint64_t bit = 1ull << (uc & 63);
+    if ((word & bit) == 0) {
+        return -1;
+    }
+    return tbl->tids[node->off + node->rank[uc >> 6] + sttable_popcount64(word & (bit - 1))];
+}
+
+/**
+ * @brief 混合表获取状态转移，稠密状态直接按字符索引，稀疏状态查位图
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_hybrid_get(const struct _sttable_hybrid_s *tbl, int id, char c) {
+    int off = tbl->sparse.nodes[id].off;
+    if (off < 0) {
+        return tbl->dense[~off + (unsigned char)c];
+    }
+    return sttable_bitmap_get(&tbl->sparse, id, c);
+}
+
+/**
+ * @brief 补全为完全自动机的混合表获取状态转移，稀疏状态没有的转移取默认稠密行
+ * 
+ * @param tbl 表指针
+ * @param id  源状态id
+ * @param c   转移字符
+ * @return int 目标状态id
+ */
+SM_INLINE int sttable_hybrid_diff_get(const struct _sttable_hybrid_s *tbl, int id, char c) {
+    int off = tbl->sparse.nodes[id].off;
+    if (off < 0) {
+        return tbl->dense[~off + (unsigned char)c];
+    }
+    int tid = sttable_bitmap_get(&tbl->sparse, id, c);
+    return tid != -1 ? tid : tbl->dense[tbl->dflt[id] + (unsigned char)c];
+}
+
+/**
+ * @brief 按指定类型获取状态转移
+ * type为常量时分支在编译期消除，匹配主循环以常量类型实例化，每次调用只分发一次
+ * 
+ * @param tbl  表指针
+ * @param type 状态转移表类型，须与sttable_inst_type(tbl)一致
+ * @param id   源状态id
+ * @param c    转移字符
+ * @return int 目标状态id，-1表示不存在
+ */
+SM_INLINE int sttable_get_typed(const sttable_t *tbl, STTableType type, int id, char c) {
+    switch (type) {
+        case STTABLE_TYPE_ARRAY:
+            return sttable_array_get(&tbl->ast, id, c);
+        case STTABLE_TYPE_ARRAY16:
+            return sttable_array16_get(&tbl->ast, id, c);
+        case STTABLE_TYPE_HASHT:
+            return sttable_hasht_get(&tbl->hst, id, c);
+        case STTABLE_TYPE_LIST:
+            return sttable_list_get(&tbl->lst, id, c);
+        case STTABLE_TYPE_DBARR:
+            return sttable_dbarr_get(&tbl->dst, id, c);
+        case STTABLE_TYPE_OHASH:
+            return sttable_ohash_get(&tbl->ost, id, c);
+        case STTABLE_TYPE_BITMAP:
+            return sttable_bitmap_get(&tbl->bst, id, c);
+        case STTABLE_TYPE_HYBRID:
+            return sttable_hybrid_get(&tbl->yst, id, c);
+        case STTABLE_TYPE_HYBRID_DIFF:
+            return sttable_hybrid_diff_get(&tbl->yst, id, c);
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief 获取主循环实例化使用的类型，收缩后的数组返回STTABLE_TYPE_ARRAY16，
+ * 补全为完全自动机的混合表返回STTABLE_TYPE_HYBRID_DIFF
+ * 
+ * @param tbl 表指针
+ * @return STTableType 实例类型
+ */
+SM_INLINE STTableType sttable_inst_type(const sttable_t *tbl) {
+    if (tbl->type == STTABLE_TYPE_ARRAY && tbl->ast.stt16 != NULL) {
+        return STTABLE_TYPE_ARRAY16;
+    }
+    if (tbl->type == STTABLE_TYPE_HYBRID && tbl->yst.dflt != NULL) {
+        return STTABLE_TYPE_HYBRID_DIFF;
+    }
+    return tbl->type;
+}
+
+#endif
@@ -1,17 +1,5 @@
 #include "trie.h"
-
-/**
- * @brief 计算hash值
- * 
- * @param id 源状态id
- * @param c  转移字符
- * @param base hash桶基数
- * @return int hash值
- */
-inline static int sttable_hasht_hash(int id, char c, int base) {
-    int hash = id * 31 + c;
-    return (hash ^ (hash >> base)) & ((1 << base) - 1);
-}
+#include "internal/sttable_get.h"
 
 /**
  * @brief 获取状态转移节点
@@ -120,18 +108,4 @@ static int sttable_hasht_set(struct _sttable_hasht_s *tbl, int fid, char c, int
     node->next = list->first;
     list->first = node;
     return 0;
-}
-
-/**
- * @brief 散列表获取状态转移
- * 
- * @param tbl 表指针
- * @param id  源状态
- * @param c   转移字符
- * @return int 目标状态
- */
-static int sttable_hasht_get(struct _sttable_hasht_s *tbl, int id, char c) {
-    int h = sttable_hasht_hash(id, c, tbl->base);
-    stlist_node_t *node = sttable_hasht_get_node(tbl, id, c, h);
-    return node != NULL ? node->tid : -1;
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "trie.h"
+#include "internal/sttable_get.h"
+#include "internal/sttable_bitmap.h"
+
+/**
+ * @brief 状态节点数组扩展，已补全为完全自动机时默认稠密行数组保持相同大小
+ *
+ * @param tbl 表指针
+ * @param id  状态id
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_hybrid_extend(struct _sttable_hybrid_s *tbl, int id) {
+    int nsize = tbl->sparse.nsize;
+    if (sttable_bitmap_extend(&tbl->sparse, id) != 0) {
+        return -1;
+    }
+    if (tbl->dflt != NULL && nsize < tbl->sparse.nsize) {
+        int *dflt = (int *)realloc(tbl->dflt, sizeof(int) * tbl->sparse.nsize);
+        if (dflt == NULL) {
+            return -1;
+        }
+        memset(dflt + nsize, -1, sizeof(int) * (tbl->sparse.nsize - nsize));
+        tbl->dflt = dflt;
+    }
+    return 0;
+}
+
+/**
+ * @brief 将稀疏状态转为稠密行，已有转移移入新行，原目标状态段不再使用
+ *
+ * @param tbl 表指针
+ * @param id  状态id
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_hybrid_densify(struct _sttable_hybrid_s *tbl, int id) {
+    if (tbl->rnum >= tbl->rsize) {
+        int rsize = tbl->rsize > 0 ? tbl->rsize * 2 : DEFAULT_STATE_NUM;
+        int *dense = (int *)realloc(tbl->dense, sizeof(int) * CHARSET_SIZE * rsize);
+        if (dense == NULL) {
+            return -1;
+        }
+        tbl->dense = dense;
+        tbl->rsize = rsize;
+    }
+    int start = tbl->rnum++ * CHARSET_SIZE;
+    int *stt = tbl->dense + start;
+    memset(stt, -1, sizeof(int) * CHARSET_SIZE);
+    sttable_bitmap_node_t *node = &tbl->sparse.nodes[id];
+    const int *tids = tbl->sparse.tids + node->off;
+    for (int w = 0, k = 0; w < CHARSET_SIZE / 64; w++) {
+        for (uint64_t bits = node->bits[w]; bits != 0; bits &= bits - 1) {
+            stt[w * 64 + __builtin_ctzll(bits)] = tids[k++];
+        }
+    }
+    memset(node, 0, sizeof(sttable_bitmap_node_t));
+    node->off = ~start;
+    return 0;
+}
+
+/**
+ * @brief 混合表设置状态转移
+ * 浅层状态在第一次设置转移时转为稠密行，其他状态在转移数达到阈值时转为稠密行
+ *
+ * @param tbl 表指针
+ * @param fid 源状态
+ * @param c   转移字符
+ * @param tid 目标状态
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_hybrid_set(struct _sttable_hybrid_s *tbl, int fid, char c, int tid) {
+    if (sttable_hybrid_extend(tbl, fid > tid ? fid : tid) != 0) {
+        return -1;
+    }
+    sttable_bitmap_node_t *node = &tbl->sparse.nodes[fid];
+    if (node->off >= 0 && tbl->trie != NULL && tbl->trie->states[fid].depth < STTABLE_HYBRID_DENSE_DEPTH
+        && sttable_hybrid_densify(tbl, fid) != 0) {
+        return -1;
+    }
+    if (node->off < 0) {
+        tbl->dense[~node->off + (unsigned char)c] = tid;
+        return 0;
+    }
+    if (sttable_bitmap_set(&tbl->sparse, fid, c, tid) != 0) {
+        return -1;
+    }
+    // 转为稠密行失败时保持稀疏，转移仍然有效
+    if (sttable_bitmap_num(node) >= STTABLE_HYBRID_DENSE_FANOUT) {
+        sttable_hybrid_densify(tbl, fid);
+    }
+    return 0;
+}
+
+/**
+ * @brief 混合表补全完全自动机转移，参数同sttable_inherit
+ * 稀疏状态与默认稠密行不同的转移只有自身的转移和失配状态的稀疏转移，
+ * 因此只需合并失配状态的稀疏转移；转移数达到阈值时转为稠密行并补全整行
+ *
+ * @param tbl 表指针
+ * @param id  状态id
+ * @param fid 失配状态id
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_hybrid_inherit(struct _sttable_hybrid_s *tbl, int id, int fid) {
+    if (tbl->dflt == NULL) {
+        tbl->dflt = (int *)malloc(sizeof(int) * tbl->sparse.nsize);
+        if (tbl->dflt == NULL) {
+            return -1;
+        }
+        memset(tbl->dflt, -1, sizeof(int) * tbl->sparse.nsize);
+    }
+    const sttable_bitmap_node_t *fnode = &tbl->sparse.nodes[fid];
+    int start = fnode->off < 0 ? ~fnode->off : tbl->dflt[fid];
+    // 先拷贝失配状态的稀疏转移，设置转移时目标状态数组可能重新分配
+    int num = 0;
+    unsigned char chars[CHARSET_SIZE];
+    int tids[CHARSET_SIZE];
+    if (fnode->off >= 0) {
+        const int *ftids = tbl->sparse.tids + fnode->off;
+        for (int w = 0; w < CHARSET_SIZE / 64; w++) {
+            for (uint64_t bits = fnode->bits[w]; bits != 0; bits &= bits - 1, num++) {
+                chars[num] = (unsigned char)(w * 64 + __builtin_ctzll(bits));
+                tids[num] = ftids[num];
+            }
+        }
+    }
+    sttable_bitmap_node_t *node = &tbl->sparse.nodes[id];
+    for (int i = 0; i < num; i++) {
+        int w = chars[i] >> 6;
+        uint64_t bit = 1ull << (chars[i] & 63);
+        if (node->off < 0 ? tbl->dense[~node->off + chars[i]] == -1 : (node->bits[w] & bit) == 0) {
+            if (sttable_hybrid_set(tbl, id, (char)chars[i], tids[i]) != 0) {
+                return -1;
+            }
+        }
+    }
+    if (node->off < 0) {
+        int *stt = tbl->dense + ~node->off;
+        for (int c = 0; c < CHARSET_SIZE; c++) {
+            if (stt[c] == -1) {
+                stt[c] = tbl->dense[start + c];
+            }
+        }
+    } else {
+        tbl->dflt[id] = start;
+    }
+    return 0;
+}
@@ -1,14 +1,105 @@
 #include "trie.h"
+#include "internal/sttable_get.h"
 
-static int sttable_list_get(struct _sttable_list_s *tbl, int id, char c) {
-    int child = tbl->trie->states[id].first;
-    TrieState *state = NULL;
-    while (child != 0) {
-        state = &tbl->trie->states[child];
-        if (state->c == c) {
-            return child;
+/**
+ * @brief 状态节点数组扩展，容量翻倍直到大于id，新节点没有转移
+ *
+ * @param tbl 表指针
+ * @param id  状态id
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_list_extend(struct _sttable_list_s *tbl, int id) {
+    if (id < tbl->nsize) {
+        return 0;
+    }
+    int nsize = tbl->nsize * 2;
+    while (nsize <= id) {
+        nsize *= 2;
+    }
+    sttable_list_node_t *nodes = (sttable_list_node_t *)realloc(tbl->nodes, sizeof(sttable_list_node_t) * nsize);
+    if (nodes == NULL) {
+        return -1;
+    }
+    memset(nodes + tbl->nsize, 0, sizeof(sttable_list_node_t) * (nsize - tbl->nsize));
+    tbl->nodes = nodes;
+    tbl->nsize = nsize;
+    return 0;
+}
+
+/**
+ * @brief 为状态分配容量为cap的段，并拷贝已有的转移
+ * 原段位于数组末尾时原地扩展，否则在末尾分配新段，原段不再使用
+ *
+ * @param tbl  表指针
+ * @param node 状态节点
+ * @param cap  新容量
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_list_grow(struct _sttable_list_s *tbl, sttable_list_node_t *node, int cap) {
+    int num = node->num;
+    int off = num > 0 && node->off + num == tbl->tused ? node->off : tbl->tused;
+    if (off + cap > tbl->tsize) {
+        int tsize = tbl->tsize * 2;
+        while (tsize < off + cap) {
+            tsize *= 2;
+        }
+        uint8_t *chars = (uint8_t *)realloc(tbl->chars, tsize + STTABLE_LIST_PAD);
+        if (chars == NULL) {
+            return -1;
+        }
+        memset(chars + tbl->tsize + STTABLE_LIST_PAD, 0, tsize - tbl->tsize);
+        tbl->chars = chars;
+        int *tids = (int *)realloc(tbl->tids, sizeof(int) * tsize);
+        if (tids == NULL) {
+            return -1;
         }
-        child = state->next;
+        tbl->tids = tids;
+        tbl->tsize = tsize;
+    }
+    if (off != node->off && num > 0) {
+        memcpy(tbl->chars + off, tbl->chars + node->off, num);
+        memcpy(tbl->tids + off, tbl->tids + node->off, sizeof(int) * num);
+    }
+    node->off = off;
+    tbl->tused = off + cap;
+    return 0;
+}
+
+/**
+ * @brief 有序子节点数组设置状态转移，新转移按字符顺序插入
+ *
+ * @param tbl 表指针
+ * @param fid 源状态
+ * @param c   转移字符
+ * @param tid 目标状态
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_list_set(struct _sttable_list_s *tbl, int fid, char c, int tid) {
+    // 目标状态也须有节点，查询时不判断越界
+    if (sttable_list_extend(tbl, fid > tid ? fid : tid) != 0) {
+        return -1;
+    }
+    unsigned char uc = (unsigned char)c;
+    sttable_list_node_t *node = &tbl->nodes[fid];
+    int num = node->num;
+    int idx = 0;
+    while (idx < num && tbl->chars[node->off + idx] < uc) {
+        idx++;
+    }
+    if (idx < num && tbl->chars[node->off + idx] == uc) {
+        tbl->tids[node->off + idx] = tid;
+        return 0;
+    }
+    // 容量为不小于转移数的2的幂，转移数为0或2的幂时段已满
+    if ((num & (num - 1)) == 0 && sttable_list_grow(tbl, node, num > 0 ? num * 2 : 1) != 0) {
+        return -1;
     }
-    return -1;
-}
\ No newline at end of file
+    uint8_t *chars = tbl->chars + node->off;
+    int *tids = tbl->tids + node->off;
+    memmove(chars + idx + 1, chars + idx, num - idx);
+    memmove(tids + idx + 1, tids + idx, sizeof(int) * (num - idx));
+    chars[idx] = uc;
+    tids[idx] = tid;
+    node->num = num + 1;
+    return 0;
+}
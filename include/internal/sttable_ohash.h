@@ -0,0 +1,123 @@
+#include "trie.h"
+#include "internal/sttable_get.h"
+
+/**
+ * @brief 分配桶数组，按缓存行对齐，所有槽位置空
+ * 
+ * @param tbl  表指针
+ * @param bits 桶数位数
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_ohash_alloc(struct _sttable_ohash_s *tbl, int bits) {
+    size_t bytes = sizeof(sttable_ohash_bucket_t) << bits;
+    void *mem = malloc(bytes + sizeof(sttable_ohash_bucket_t));
+    if (mem == NULL) {
+        return -1;
+    }
+    uintptr_t align = sizeof(sttable_ohash_bucket_t) - 1;
+    tbl->mem = mem;
+    tbl->buckets = (sttable_ohash_bucket_t *)(((uintptr_t)mem + align) & ~align);
+    tbl->bits = bits;
+    tbl->size = 0;
+    tbl->max_probe = 1;
+    memset(tbl->buckets, 0xFF, bytes);
+    return 0;
+}
+
+/**
+ * @brief 插入不存在的键，在最多STTABLE_OHASH_MAX_PROBE个桶中寻找空槽
+ * 
+ * @param tbl 表指针
+ * @param key 键
+ * @param tid 目标状态
+ * @return int 0:成功 -1:探测范围内没有空槽
+ */
+static int sttable_ohash_insert(struct _sttable_ohash_s *tbl, uint32_t key, int tid) {
+    uint32_t mask = (1u << tbl->bits) - 1;
+    uint32_t b = sttable_ohash_bucket(key, tbl->bits);
+    for (int p = 0; p < STTABLE_OHASH_MAX_PROBE; p++) {
+        sttable_ohash_bucket_t *bkt = &tbl->buckets[(b + p) & mask];
+        for (int i = 0; i < STTABLE_OHASH_SLOTS; i++) {
+            if (bkt->keys[i] == STTABLE_OHASH_EMPTY) {
+                bkt->keys[i] = key;
+                bkt->tids[i] = tid;
+                ++tbl->size;
+                if (p + 1 > tbl->max_probe) {
+                    tbl->max_probe = p + 1;
+                }
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 扩容重建，桶数翻倍，重新插入后仍有探测超限时继续翻倍
+ * 
+ * @param tbl 表指针
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_ohash_extend(struct _sttable_ohash_s *tbl) {
+    struct _sttable_ohash_s old = *tbl;
+    int nbuckets = 1 << old.bits;
+    for (int bits = old.bits + 1; bits < 31; bits++) {
+        if (sttable_ohash_alloc(tbl, bits) != 0) {
+            *tbl = old;
+            return -1;
+        }
+        int ok = 1;
+        for (int b = 0; ok && b < nbuckets; b++) {
+            const sttable_ohash_bucket_t *bkt = &old.buckets[b];
+            for (int i = 0; i < STTABLE_OHASH_SLOTS && bkt->keys[i] != STTABLE_OHASH_EMPTY; i++) {
+                if (sttable_ohash_insert(tbl, bkt->keys[i], bkt->tids[i]) != 0) {
+                    ok = 0;
+                    break;
+                }
+            }
+        }
+        if (ok) {
+            free(old.mem);
+            return 0;
+        }
+        free(tbl->mem);
+    }
+    *tbl = old;
+    return -1;
+}
+
+/**
+ * @brief 开放寻址散列表设置状态转移
+ * 
+ * @param tbl 表指针
+ * @param fid 源状态
+ * @param c   转移字符
+ * @param tid 目标状态
+ * @return int 0:成功 -1:失败
+ */
+static int sttable_ohash_set(struct _sttable_ohash_s *tbl, int fid, char c, int tid) {
+    if (fid < 0 || fid >= STTABLE_OHASH_MAX_STATE) {
+        return -1;
+    }
+    uint32_t key = (uint32_t)fid << 8 | (unsigned char)c;
+    uint32_t mask = (1u << tbl->bits) - 1;
+    uint32_t b = sttable_ohash_bucket(key, tbl->bits);
+    for (int p = 0; p < tbl->max_probe; p++) {
+        sttable_ohash_bucket_t *bkt = &tbl->buckets[(b + p) & mask];
+        int slot = sttable_ohash_find(bkt, key);
+        if (slot >= 0) {
+            bkt->tids[slot] = tid;
+            return 0;
+        }
+    }
+    // 负载因子不超过3/4
+    if ((tbl->size + 1) * 4 > (STTABLE_OHASH_SLOTS << tbl->bits) * 3 && sttable_ohash_extend(tbl) != 0) {
+        return -1;
+    }
+    while (sttable_ohash_insert(tbl, key, tid) != 0) {
+        if (sttable_ohash_extend(tbl) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
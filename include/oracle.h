@@ -4,8 +4,11 @@
 #include "trie.h"
 
 #define ORC_DEFAULT_NODE_NUM DEFAULT_STATE_NUM
+// oracle自动机的状态转移表类型，转移稀疏，使用开放寻址散列表
+#define ORC_STTABLE_TYPE STTABLE_TYPE_OHASH
 
 typedef struct _orc_slist_node_s {
+    int id;    // 模式串id
     int len;   // 长度
     char *str; // 模式串
     struct _orc_slist_node_s *next;
@@ -18,8 +21,11 @@ typedef struct {
 typedef struct {
     Trie *trie;  // trie自动机
     int min_len; // 最小模式串长度
+    int max_len; // 最大模式串长度
     int nsize;   // 字符串节点数组大小
     int pnum;    // 模式串数量
+    int id_num;  // 已分配的模式串id数，每次插入递增
+    STTableType sttype; // 状态转移表类型
     int *fids;   // 终止状态ID数组
     orc_slist_t *lists;      // 终止状态对应的字符串链表
     orc_slist_node_t *nodes; // 字符串节点数组
@@ -32,6 +38,15 @@ typedef struct {
  */
 Oracle* oracle_create();
 
+/**
+ * @brief 创建使用指定状态转移表的oracle自动机，转移稀疏时可选STTABLE_TYPE_BITMAP或STTABLE_TYPE_HYBRID
+ * 构建时会增加trie树之外的转移，不支持双数组
+ * 
+ * @param sttype 状态转移表类型
+ * @return Oracle* NULL表示类型不支持
+ */
+Oracle* oracle_create_typed(STTableType sttype);
+
 /**
  * @brief 从模式串集合中创建oracle自动机
  * 
@@ -66,6 +81,25 @@ int oracle_insert(Oracle *orc, const char *p, int plen);
  */
 void oracle_build(Oracle *orc);
 
+/**
+ * @brief 将已构建的自动机保存为映像文件，字符串链表保存为节点下标，散列表实现的状态转移表不支持
+ * 
+ * @param orc  自动机指针
+ * @param path 文件路径
+ * @return int 0:成功 -1:失败
+ */
+int oracle_save(const Oracle *orc, const char *path);
+
+/**
+ * @brief 映射映像文件加载自动机，状态表、状态转移表和模式串直接使用映射的内存，
+ * 只按节点下标重建字符串链表；加载的自动机只读，不能再插入模式串
+ * 
+ * @param path   文件路径
+ * @param verify 1:校验全部内容的校验和 0:只校验文件头和段表
+ * @return Oracle* NULL表示文件无效
+ */
+Oracle* oracle_load(const char *path, int verify);
+
 /**
  * @brief set backward oracle match
  * 
@@ -76,4 +110,36 @@ void oracle_build(Oracle *orc);
  */
 void oracle_search(const Oracle *orc, const char *s, int slen, match_result_t *result);
 
+/**
+ * @brief set backward oracle match，每个匹配项交给回调函数
+ * 
+ * @param orc    Oracle指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int oracle_search_cb(const Oracle *orc, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 统计匹配数，不生成匹配结果
+ * 
+ * @param orc    oracle自动机指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @return int64_t 匹配数
+ */
+int64_t oracle_count(const Oracle *orc, const char *s, int slen);
+
+/**
+ * @brief 判断字符串中是否存在模式串，遇到第一个匹配即返回
+ * 
+ * @param orc    oracle自动机指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @return int   1:存在 0:不存在
+ */
+int oracle_contains(const Oracle *orc, const char *s, int slen);
+
 #endif
\ No newline at end of file
@@ -9,18 +9,30 @@
 
 typedef struct {
     int len;
+    int id; // 模式串id
     char str[SHIFT_MAX_PATTERN_LEN];
 } _snfa_pattern_t;
 
 typedef struct {
     int pnum;    // 模式串数量
     int max_len; // 最大模式串长度
+    int id_num;  // 已分配的模式串id数，每次插入递增
     bit_array_t int_mask;           // 初始状态位掩码
     bit_array_t fin_mask;           // 终止状态位掩码
     bit_array_t mask[CHARSET_SIZE]; // 字符位掩码表
     _snfa_pattern_t patterns[SHIFT_MAX_PATTERN_NUM]; // 模式串数组
 } ShiftNFA;
 
+/**
+ * @brief ShiftNFA流式匹配上下文
+ * 保存分块之间的NFA状态位数组，跨块的匹配不会丢失
+ */
+typedef struct {
+    const ShiftNFA *snfa; // ShiftNFA指针
+    bit_array_t status;   // 当前状态位数组
+    int64_t offset;       // 已扫描的字节数，即下一块首字符的绝对偏移
+} shift_nfa_stream_t;
+
 /**
  * @brief 创建
  * 
@@ -71,4 +83,61 @@ void shift_nfa_build(ShiftNFA *snfa);
  */
 void shift_nfa_search(const ShiftNFA *snfa, const char *s, int slen, match_result_t* result);
 
+/**
+ * @brief 多模式串下shift and匹配算法，每个匹配项交给回调函数
+ * 
+ * @param snfa   ShiftNFA指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int shift_nfa_search_cb(const ShiftNFA *snfa, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 创建流式匹配上下文，ShiftNFA需已构建，且生命周期长于上下文
+ * 
+ * @param snfa ShiftNFA指针
+ * @return shift_nfa_stream_t* 
+ */
+shift_nfa_stream_t* shift_nfa_stream_create(const ShiftNFA *snfa);
+
+/**
+ * @brief 销毁流式匹配上下文
+ * 
+ * @param stream 
+ */
+void shift_nfa_stream_destroy(shift_nfa_stream_t *stream);
+
+/**
+ * @brief 重置流式匹配上下文，从新的流开始匹配
+ * 
+ * @param stream 
+ */
+void shift_nfa_stream_reset(shift_nfa_stream_t *stream);
+
+/**
+ * @brief 流式匹配，依次传入流的各个分块，匹配位置为流中的绝对偏移
+ * 
+ * @param stream 流式匹配上下文
+ * @param s      当前分块
+ * @param slen   分块长度
+ * @param result 匹配结果
+ */
+void shift_nfa_stream_search(shift_nfa_stream_t *stream, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 流式匹配，每个匹配项交给回调函数
+ * 被回调终止时上下文不再推进，继续使用前需重置
+ * 
+ * @param stream 流式匹配上下文
+ * @param s      当前分块
+ * @param slen   分块长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int shift_nfa_stream_search_cb(shift_nfa_stream_t *stream, const char *s, int slen, match_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
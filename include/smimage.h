@@ -0,0 +1,144 @@
+#ifndef _SMIMAGE_H
+#define _SMIMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SM_IMAGE_MAGIC "XSSMIMG"
+#define SM_IMAGE_VERSION 2
+// 字节序标记，加载时与本机不一致说明映像来自不同字节序的机器
+#define SM_IMAGE_ENDIAN 0x01020304u
+// 段起点对齐字节数，保证缓存行对齐的数组在映射后仍然对齐
+#define SM_IMAGE_ALIGN 64
+#define SM_IMAGE_MAX_SECTIONS 64
+
+/**
+ * @brief 映像中保存的对象类型
+ */
+typedef enum {
+    SM_IMAGE_TRIE = 1, // trie树
+    SM_IMAGE_AC,       // AC自动机
+    SM_IMAGE_DAT,      // 双数组trie树
+    SM_IMAGE_WUM,      // Wu-Manber
+    SM_IMAGE_ORACLE,   // oracle自动机
+} SMImageKind;
+
+/**
+ * @brief 段描述，偏移相对于文件起点
+ */
+typedef struct {
+    uint64_t off; // 段偏移
+    uint64_t len; // 段长度
+} sm_image_section_t;
+
+/**
+ * @brief 映像文件头
+ * 文件由文件头和按SM_IMAGE_ALIGN对齐的段依次组成，段内只保存整数和字节，
+ * 对象之间按段下标引用，不含指针，映射到任意地址都可直接使用
+ */
+typedef struct {
+    char magic[8];     // SM_IMAGE_MAGIC
+    uint32_t version;  // SM_IMAGE_VERSION
+    uint32_t endian;   // SM_IMAGE_ENDIAN
+    uint32_t kind;     // 对象类型
+    uint32_t nsec;     // 段数
+    uint64_t size;     // 文件大小
+    uint64_t checksum; // 全部段内容的校验和
+    sm_image_section_t secs[SM_IMAGE_MAX_SECTIONS]; // 段表
+} sm_image_header_t;
+
+/**
+ * @brief 字符串链表节点记录，链表指针保存为节点下标
+ */
+typedef struct {
+    int32_t id;   // 模式串id
+    int32_t len;  // 字符串长度
+    int32_t off;  // 字符串在字符串段中的偏移，字符串以'\0'结尾
+    int32_t next; // 下个节点的下标，-1表示链表结束
+} sm_image_strnode_t;
+
+/**
+ * @brief 映像写入器，只记录各段的数据指针，写文件时才拷贝
+ */
+typedef struct {
+    sm_image_header_t hdr;
+    const void *data[SM_IMAGE_MAX_SECTIONS]; // 各段数据
+    int overflow; // 段数曾超过SM_IMAGE_MAX_SECTIONS，写入时失败
+} sm_image_writer_t;
+
+/**
+ * @brief 已映射的映像
+ */
+typedef struct {
+    void *base;  // 映射起点，即文件头
+    size_t size; // 映射大小
+    const sm_image_header_t *hdr;
+} sm_image_t;
+
+/**
+ * @brief 初始化映像写入器
+ *
+ * @param w    写入器指针
+ * @param kind 对象类型
+ */
+void sm_image_writer_init(sm_image_writer_t *w, SMImageKind kind);
+
+/**
+ * @brief 添加段，数据在sm_image_write之前须保持有效
+ *
+ * @param w    写入器指针
+ * @param data 段数据，len为0时可为NULL
+ * @param len  段长度
+ * @return int 段下标，-1表示段数超过SM_IMAGE_MAX_SECTIONS，随后的sm_image_write失败
+ */
+int sm_image_add(sm_image_writer_t *w, const void *data, uint64_t len);
+
+/**
+ * @brief 计算校验和并写入文件，曾有段添加失败时不写入
+ * 写入同一目录下的临时文件并同步到磁盘后改名替换目标文件，已加载旧映像的进程不受影响
+ *
+ * @param w    写入器指针
+ * @param path 文件路径
+ * @return int 0:成功 -1:失败
+ */
+int sm_image_write(sm_image_writer_t *w, const char *path);
+
+/**
+ * @brief 只读映射映像文件，校验文件头、类型和段表，可选校验全部内容的校验和
+ * 多个进程映射同一文件时共享物理页；校验和需要读取整个文件，大映像不校验时打开只需常数时间
+ *
+ * @param path   文件路径
+ * @param kind   期望的对象类型
+ * @param verify 1:校验校验和 0:不校验，页面在访问时按需读入
+ * @return sm_image_t* NULL表示打开失败或校验不通过
+ */
+sm_image_t* sm_image_open(const char *path, SMImageKind kind, int verify);
+
+/**
+ * @brief 获取段数据
+ *
+ * @param img 映像指针
+ * @param idx 段下标
+ * @param len 可为NULL，否则写入段长度
+ * @return const void* 段数据，下标无效时为NULL
+ */
+const void* sm_image_section(const sm_image_t *img, int idx, uint64_t *len);
+
+/**
+ * @brief 获取长度为len的段，用于校验数组段的大小与对象记录的大小一致
+ *
+ * @param img 映像指针
+ * @param idx 段下标
+ * @param len 期望的段长度
+ * @return const void* 段数据，下标无效或长度不符时为NULL
+ */
+const void* sm_image_get(const sm_image_t *img, int idx, uint64_t len);
+
+/**
+ * @brief 解除映射并释放映像
+ *
+ * @param img 映像指针
+ */
+void sm_image_close(sm_image_t *img);
+
+#endif
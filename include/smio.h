@@ -1,23 +1,96 @@
 #ifndef _SMIO_H
 #define _SMIO_H
 
+#include <stdint.h>
+
 #define CHARSET_SIZE 256
+#define MATCH_RESULT_DEFAULT_CAP 16
+
+// 强制内联，用于各引擎的扫描主循环，使常量回调函数在调用处展开
+#if defined(__GNUC__) || defined(__clang__)
+#define SM_INLINE static inline __attribute__((always_inline))
+#else
+#define SM_INLINE static inline
+#endif
 
 /**
  * @brief 单个匹配项
  */
 typedef struct {
-    int pos; // 匹配位置
+    int64_t pos; // 匹配位置，流式匹配时为流中的绝对偏移
     int len; // 匹配长度
+    int id;  // 模式串id，即模式串的插入序号，单模式串匹配为0
 } match_item_t;
 
+/**
+ * @brief 匹配结果容量不足时的处理方式
+ */
+typedef enum {
+    MATCH_RESULT_FIXED, // 固定容量，容量满后丢弃并计数
+    MATCH_RESULT_GROW,  // 容量满后倍增
+    MATCH_RESULT_SINK,  // 容量满后整块交给输出函数，然后清空
+} MatchResultMode;
+
+/**
+ * @brief 多模式串匹配的报告方式
+ * 不重叠的两种方式在扫描中确定结果，每个位置只比较起点最左的候选，不枚举重叠的匹配
+ */
+typedef enum {
+    MATCH_KIND_STANDARD,         // 报告全部匹配，包括重叠的匹配
+    MATCH_KIND_LEFTMOST_FIRST,   // 不重叠，取起点最左的匹配，起点相同时取先插入的模式串
+    MATCH_KIND_LEFTMOST_LONGEST, // 不重叠，取起点最左的匹配，起点相同时取最长的模式串
+} MatchKind;
+
+/**
+ * @brief 匹配结果输出函数
+ * 
+ * @param items 匹配项集合
+ * @param size  匹配项数量
+ * @param ctx   用户上下文
+ * @return int  0:继续 非0:停止匹配
+ */
+typedef int (*match_sink_t)(const match_item_t *items, int size, void *ctx);
+
+/**
+ * @brief 逐个匹配回调函数
+ * 
+ * @param item 匹配项
+ * @param ctx  用户上下文
+ * @return int 0:继续 非0:停止匹配
+ */
+typedef int (*match_callback_t)(const match_item_t *item, void *ctx);
+
+/**
+ * @brief 批量匹配中的单个文档
+ */
+typedef struct {
+    const char *s; // 文档内容
+    int len;       // 文档长度
+} match_doc_t;
+
+/**
+ * @brief 批量匹配回调函数
+ * 
+ * @param doc  文档下标
+ * @param item 匹配项，位置为文档内偏移
+ * @param ctx  用户上下文
+ * @return int 0:继续 非0:停止匹配
+ */
+typedef int (*match_batch_callback_t)(int doc, const match_item_t *item, void *ctx);
+
 /**
  * @brief 多模式串匹配结果
  */
 typedef struct {
-    int size; // 数量
-    int cap;  // 容量
+    int size;  // 数量
+    int cap;   // 容量
+    int limit; // 不经match_result_reserve可直接添加到的数量，平时等于cap，输出函数要求停止后为0
     match_item_t* items; // 匹配集合
+    MatchResultMode mode; // 容量不足时的处理方式
+    int dropped;       // 固定容量模式下丢弃的匹配数
+    int stopped;       // 输出函数曾要求停止，之后的添加和输出都失败，直到match_result_reset
+    match_sink_t sink; // 输出函数
+    void *ctx;         // 输出函数上下文
 } match_result_t;
 
 /**
@@ -28,6 +101,14 @@ typedef struct {
  */
 match_result_t* match_result_create(int cap);
 
+/**
+ * @brief 创建匹配结果数据结构
+ * 
+ * @param cap  初始容量，输出模式下为每次交给输出函数的匹配数
+ * @param mode 容量不足时的处理方式
+ * @return match_result_t* 
+ */
+match_result_t* match_result_create_ex(int cap, MatchResultMode mode);
 
 /**
  * @brief 销毁匹配结果
@@ -45,15 +126,129 @@ void match_result_destroy(match_result_t *result);
  */
 void match_result_init(match_result_t *result, match_item_t* items, int cap);
 
+/**
+ * @brief 设置输出函数，匹配结果切换为输出模式
+ * 
+ * @param result 匹配结果指针
+ * @param sink   输出函数
+ * @param ctx    输出函数上下文
+ */
+void match_result_set_sink(match_result_t *result, match_sink_t sink, void *ctx);
+
+/**
+ * @brief 清空匹配结果，清除丢弃计数和输出函数的停止要求，容量和模式不变
+ * 
+ * @param result 匹配结果指针
+ */
+void match_result_reset(match_result_t *result);
+
+/**
+ * @brief 将缓存的匹配项全部交给输出函数，匹配结束后调用
+ * 输出函数要求停止后不再调用，直到match_result_reset
+ * 
+ * @param result 匹配结果指针
+ * @return int   0:成功 -1:输出函数要求停止
+ */
+int match_result_flush(match_result_t *result);
+
+/**
+ * @brief 容量已满时按模式腾出空间，输出函数要求停止后总是失败
+ * 
+ * @param result 匹配结果指针
+ * @return int   0:可以继续添加 -1:无法添加
+ */
+int match_result_reserve(match_result_t *result);
+
 /**
  * @brief 添加匹配项
  * 
  * @param result 匹配结果指针
- * @param p      模式串指针
  * @param plen   模式串长度
  * @param pos    最终匹配位置
+ * @param id     模式串id
  * @return int   0:成功 -1:失败
  */
-int match_result_append(match_result_t *result, int plen, int pos);
+static inline int match_result_append(match_result_t *result, int plen, int64_t pos, int id) {
+    // 停止要求已并入limit，每个匹配项只比较一次
+    if (result->size >= result->limit && match_result_reserve(result) != 0) {
+        return -1;
+    }
+    match_item_t* item = &result->items[result->size++];
+    item->len = plen;
+    item->pos = pos;
+    item->id = id;
+    return 0;
+}
+
+/**
+ * @brief 添加匹配项，返回值供扫描循环判断是否停止
+ * 固定容量模式下容量满后只计入dropped，扫描继续；输出函数要求停止或扩容失败时停止扫描
+ * 
+ * @param result 匹配结果指针
+ * @param plen   模式串长度
+ * @param pos    最终匹配位置
+ * @param id     模式串id
+ * @return int   0:继续 -1:停止匹配
+ */
+static inline int match_result_emit(match_result_t *result, int plen, int64_t pos, int id) {
+    if (match_result_append(result, plen, pos, id) != 0) {
+        return result->mode == MATCH_RESULT_FIXED ? 0 : -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 回调方式添加匹配项，ctx为匹配结果指针，返回值同match_result_emit
+ * 
+ * @param item 匹配项
+ * @param ctx  匹配结果指针
+ * @return int 0:继续 -1:停止匹配
+ */
+static inline int match_result_callback(const match_item_t *item, void *ctx) {
+    return match_result_emit((match_result_t *)ctx, item->len, item->pos, item->id);
+}
+
+/**
+ * @brief 回调方式统计匹配数，ctx为int64_t计数器指针
+ */
+static inline int match_count_callback(const match_item_t *item, void *ctx) {
+    (void)item;
+    ++*(int64_t *)ctx;
+    return 0;
+}
+
+/**
+ * @brief 回调方式判断是否存在匹配，遇到第一个匹配即停止
+ */
+static inline int match_stop_callback(const match_item_t *item, void *ctx) {
+    (void)item;
+    (void)ctx;
+    return 1;
+}
+
+/**
+ * @brief 构造匹配项并交给回调函数
+ * 
+ * @param cb   回调函数
+ * @param ctx  回调上下文
+ * @param len  匹配长度
+ * @param pos  匹配位置
+ * @param id   模式串id
+ * @return int 0:继续 非0:停止匹配
+ */
+SM_INLINE int match_emit(match_callback_t cb, void *ctx, int len, int64_t pos, int id) {
+    match_item_t item;
+    item.pos = pos;
+    item.len = len;
+    item.id = id;
+    return cb(&item, ctx);
+}
+
+/**
+ * @brief 输出匹配位置
+ * 
+ * @param result 匹配结果指针
+ */
+void match_result_print(const match_result_t *result);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,119 @@
+#ifndef _SMSCAN_H
+#define _SMSCAN_H
+
+#include "smio.h"
+#include "trie.h"
+#include "ac.h"
+#include "oracle.h"
+#include "shift.h"
+#include "horspool.h"
+#include "wum.h"
+#include "dat.h"
+
+// 内存中单次交给引擎的最大长度，引擎接口的长度为int类型
+#define SMSCAN_WINDOW_SIZE (1 << 30)
+// 管道等不可映射输入的单次读取长度
+#define SMSCAN_READ_SIZE (1 << 16)
+// 并行扫描时每个线程的最小数据长度
+#define SMSCAN_PARALLEL_MIN_SIZE (1 << 20)
+
+/**
+ * @brief 引擎匹配函数，与各引擎的*_search_cb一致
+ *
+ * @param engine 引擎指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+typedef int (*match_search_fn)(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 扫描器，把任意引擎包装为可分段扫描的统一接口
+ * 相邻分段重叠max_len-1字节，跨段的匹配不会丢失，也不会重复
+ */
+typedef struct {
+    match_search_fn search; // 引擎匹配函数
+    const void *engine;     // 引擎指针，扫描期间只读
+    int max_len;            // 最大模式串长度
+} match_scanner_t;
+
+/**
+ * @brief 初始化扫描器
+ *
+ * @param scanner 扫描器指针
+ * @param search  引擎匹配函数
+ * @param engine  引擎指针
+ * @param max_len 最大模式串长度
+ * @return int 0:成功 -1:失败（最大模式串长度超出分段大小）
+ */
+int match_scanner_init(match_scanner_t *scanner, match_search_fn search, const void *engine, int max_len);
+
+/**
+ * @brief 各引擎的扫描器初始化，引擎需已构建，最大模式串长度取自引擎
+ *
+ * @param scanner 扫描器指针
+ * @param engine  引擎指针
+ * @return int 0:成功 -1:失败
+ */
+int match_scanner_init_trie(match_scanner_t *scanner, const Trie *trie);
+int match_scanner_init_ac(match_scanner_t *scanner, const AC *ac);
+int match_scanner_init_oracle(match_scanner_t *scanner, const Oracle *orc);
+int match_scanner_init_shift_nfa(match_scanner_t *scanner, const ShiftNFA *snfa);
+int match_scanner_init_horspool(match_scanner_t *scanner, const Horspool *hsp);
+int match_scanner_init_wum(match_scanner_t *scanner, const Wum *wum);
+int match_scanner_init_dat(match_scanner_t *scanner, const DATrie *dat);
+
+/**
+ * @brief 扫描内存数据，长度可超过2GB，匹配位置为数据中的绝对偏移
+ *
+ * @param scanner 扫描器指针
+ * @param s       数据
+ * @param slen    数据长度
+ * @param cb      回调函数，返回非0时停止匹配
+ * @param ctx     回调上下文
+ * @return int    0:扫描完成 -1:被回调终止
+ */
+int match_scan_buffer(const match_scanner_t *scanner, const char *s, int64_t slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 多线程并行扫描内存数据
+ * 数据按线程数均分，每个线程负责结束位置落在本段内的匹配，向前扩展max_len-1字节扫描，
+ * 各线程共享只读的引擎，匹配先写入线程私有结果，结束后按位置顺序合并，接缝处不重复不遗漏
+ *
+ * @param scanner  扫描器指针
+ * @param s        数据
+ * @param slen     数据长度
+ * @param nthreads 线程数，不大于0时使用在线CPU数
+ * @param result   匹配结果，合并时按其容量模式追加
+ * @return int     0:成功 -1:失败（内存不足、线程创建失败或输出函数要求停止）
+ */
+int match_scan_parallel(const match_scanner_t *scanner, const char *s, int64_t slen, int nthreads,
+                        match_result_t *result);
+
+/**
+ * @brief 扫描文件描述符
+ * 普通文件通过mmap映射后直接扫描，不拷贝数据；
+ * 管道、字符设备等无法映射的输入分块读取，块之间保留max_len-1字节重叠
+ *
+ * @param scanner 扫描器指针
+ * @param fd      文件描述符
+ * @param cb      回调函数，返回非0时停止匹配
+ * @param ctx     回调上下文
+ * @return int    0:扫描完成 -1:被回调终止 -2:读取失败
+ */
+int match_scan_fd(const match_scanner_t *scanner, int fd, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 扫描文件，参数及返回值同match_scan_fd
+ *
+ * @param scanner 扫描器指针
+ * @param path    文件路径
+ * @param cb      回调函数，返回非0时停止匹配
+ * @param ctx     回调上下文
+ * @return int    0:扫描完成 -1:被回调终止 -2:打开或读取失败
+ */
+int match_scan_file(const match_scanner_t *scanner, const char *path, match_callback_t cb, void *ctx);
+
+#endif
@@ -1,20 +1,51 @@
 #ifndef _STTABLE_H
 #define _STTABLE_H
 
+#include <stdint.h>
+#include "smio.h"
+#include "smimage.h"
+
 #define DEFAULT_STATE_NUM 16
 #define STTABLE_DEFAULT_ARRAY_SIZE (CHARSET_SIZE * DEFAULT_STATE_NUM)
 #define STTABLE_HASHT_CAP_BASE 4 // base=4,cap=2^4=16
 #define STTABLE_HASHT_DEFAULT_THRD  (1 << STTABLE_HASHT_CAP_BASE) * 3 / 4 // (cap * load_factor)
 #define STTABLE_DBARR_DEFAULT_SIZE CHARSET_SIZE
+// 开放寻址散列表：每桶槽位数（一个缓存行）、最大探测桶数、初始桶数位数
+#define STTABLE_OHASH_SLOTS 8
+#define STTABLE_OHASH_MAX_PROBE 4
+#define STTABLE_OHASH_DEFAULT_BITS 2
+// 开放寻址散列表的空槽键，键为(fid << 8 | c)，因此fid须小于STTABLE_OHASH_MAX_STATE
+#define STTABLE_OHASH_EMPTY 0xFFFFFFFFu
+#define STTABLE_OHASH_MAX_STATE 0xFFFFFF
+// 双数组寻找基数时最多尝试的空闲单元数，超出后在已占用区域之后分配
+#define DBFREE_MAX_TRIAL 64
+// 位图稀疏表初始的目标状态数组大小
+#define STTABLE_BITMAP_DEFAULT_SIZE (DEFAULT_STATE_NUM * 2)
+// 混合表中深度小于该值或转移数达到该值的状态使用稠密行
+#define STTABLE_HYBRID_DENSE_DEPTH 2
+#define STTABLE_HYBRID_DENSE_FANOUT 16
+// 有序子节点数组初始的数组大小，以及转移字符数组末尾的填充字节数，向量比较可越过最后一段读取
+#define STTABLE_LIST_DEFAULT_SIZE (DEFAULT_STATE_NUM * 2)
+#define STTABLE_LIST_PAD 32
+// 有序子节点数组中转移数不超过SCAN_MAX的状态逐个比较，不超过SIMD_MAX的用向量比较，否则二分查找
+#define STTABLE_LIST_SCAN_MAX 4
+#define STTABLE_LIST_SIMD_MAX 32
+// 16位数组中表示转移不存在的值，状态数不超过该值时数组可收缩为16位状态ID
+#define STTABLE_ARRAY16_NONE 0xFFFF
 
 /**
  * @brief 状态转移表类型
  */
 typedef enum {
-    STTABLE_TYPE_LIST,  // 链表实现状态转移
+    STTABLE_TYPE_LIST,  // 有序子节点数组实现状态转移，内存最小
     STTABLE_TYPE_ARRAY, // 数组实现状态转移
     STTABLE_TYPE_HASHT, // 哈希表实现状态转移
     STTABLE_TYPE_DBARR, // 双数组实现状态转移
+    STTABLE_TYPE_OHASH, // 开放寻址散列表实现状态转移
+    STTABLE_TYPE_BITMAP, // 位图稀疏表实现状态转移
+    STTABLE_TYPE_HYBRID, // 稠密行与位图稀疏表混合实现状态转移
+    STTABLE_TYPE_ARRAY16, // 收缩为16位状态ID的数组，仅用于匹配主循环实例化，不能用于创建
+    STTABLE_TYPE_HYBRID_DIFF, // 补全为完全自动机的混合表，仅用于匹配主循环实例化，不能用于创建
 } STTableType;
 
 /**
@@ -47,40 +78,161 @@ struct _sttable_hasht_s {
     stlist_node_t *nodes; // 元素集合
 };
 
+/**
+ * @brief 状态转移数组，每个状态占cnum项，按字节等价类索引
+ * 构建阶段使用32位状态ID，收缩后改用16位状态ID，二者只有一个有效
+ */
 struct _sttable_array_s {
-    int size;
-    int *stt;
+    int size;        // 数组项数
+    int cnum;        // 每个状态的项数，即字节等价类数，未压缩时为CHARSET_SIZE
+    int *stt;        // 32位状态ID
+    uint16_t *stt16; // 16位状态ID，STTABLE_ARRAY16_NONE表示不存在
+    uint8_t cls[CHARSET_SIZE]; // 字节到等价类的映射，未压缩时为恒等映射
 };
 
-struct _trie_s;
+/**
+ * @brief 开放寻址散列表的桶，键和目标状态共占一个缓存行
+ * 槽位按插入顺序填充，最后一个槽位为空说明探测链到此结束
+ */
+typedef struct {
+    uint32_t keys[STTABLE_OHASH_SLOTS]; // 键(fid << 8 | c)，空槽为STTABLE_OHASH_EMPTY
+    int32_t tids[STTABLE_OHASH_SLOTS];  // 目标状态id
+} sttable_ohash_bucket_t;
+
+/**
+ * @brief 开放寻址状态转移散列表
+ * 键经乘法散列取高位定位桶，按桶线性探测，探测桶数不超过STTABLE_OHASH_MAX_PROBE，
+ * 超出时扩容重建，查询最多访问max_probe个缓存行
+ */
+struct _sttable_ohash_s {
+    int bits;      // 桶数位数，桶数 = 1 << bits
+    int size;      // 元素数量
+    int max_probe; // 已插入元素的最大探测桶数
+    void *mem;     // 分配的内存，按缓存行对齐后为buckets
+    sttable_ohash_bucket_t *buckets; // 桶数组
+};
+
+/**
+ * @brief 有序子节点数组的状态节点
+ */
+typedef struct {
+    int off; // 转移字符和目标状态的起始下标
+    int num; // 转移数
+} sttable_list_node_t;
+
+/**
+ * @brief 有序子节点数组状态转移表
+ * 每个状态的转移字符按无符号值升序连续存放，目标状态平行存放，查找时比较连续的字节，
+ * 不再沿trie树兄弟链逐个访存；段容量为不小于转移数的2的幂，满时移到数组末尾并扩容一倍
+ */
 struct _sttable_list_s {
-    struct _trie_s *trie;
+    int nsize; // 状态节点数组大小
+    int tsize; // 转移数组大小
+    int tused; // 转移数组已分配的项数
+    sttable_list_node_t *nodes; // 状态节点
+    uint8_t *chars; // 转移字符，末尾另有STTABLE_LIST_PAD字节填充
+    int *tids;      // 目标状态
 };
 
+struct _trie_s;
+
+/**
+ * @brief 双数组空闲单元循环双向链表
+ * 寻找基数时只遍历空闲单元，跳过已占用的密集区域；占用单元的next为-1
+ */
+typedef struct {
+    int cap;   // 单元数
+    int used;  // 曾被占用的最大单元下标+1，其后的单元全部空闲
+    int head;  // 链表头，-1表示没有空闲单元
+    int *next; // 后继空闲单元
+    int *prev; // 前驱空闲单元
+} dbfree_t;
+
+/**
+ * @brief 双数组转移单元，来源状态与目标状态相邻存放，一次访存即可校验并取得转移
+ */
+typedef struct {
+    int check; // 来源状态id，-1表示空闲
+    int tid;   // 目标状态id
+} sttable_dbarr_cell_t;
+
 /**
  * @brief 双数组状态转移表
- * 借鉴double array trie双数组原理
+ * 借鉴double array trie双数组原理，任一基数之后都保留CHARSET_SIZE个单元，查询无需判断越界
  */
 struct _sttable_dbarr_s {
     struct _trie_s *trie; // 树指针
     int bsize; // base数组大小
-    int tsize; // target数组大小
-    int *base;   // 状态基数
-    int *target; // 目标状态id
-    // tid = target[base[fid] + c]
-    // trie->states[tid].parent = fid
+    int tsize; // cells数组大小
+    int *base; // 状态基数，没有子节点的状态为0
+    sttable_dbarr_cell_t *cells; // 转移单元
+    dbfree_t free; // cells数组的空闲单元
+    // cell = cells[base[fid] + c]
+    // cell.check = fid, tid = cell.tid
+};
+
+/**
+ * @brief 位图稀疏表的状态节点，256位位图标记存在转移的字符
+ * 目标状态按字符顺序紧凑存放，字符c的下标 = off + rank[c >> 6] + c所在64位字中低于c的置位数
+ */
+typedef struct {
+    uint64_t bits[CHARSET_SIZE / 64]; // 转移字符位图
+    int off;         // 目标状态在tids中的起始下标
+    uint8_t rank[4]; // rank[i]为前i个64位字的置位数之和，最大为192
+} sttable_bitmap_node_t;
+
+/**
+ * @brief 位图稀疏状态转移表
+ * 每个状态的目标状态段容量为不小于转移数的2的幂，段满时移到数组末尾并扩容一倍，
+ * 查询访问状态节点和目标状态各一次，内存与转移数成正比
+ */
+struct _sttable_bitmap_s {
+    int nsize; // 状态节点数组大小
+    int tsize; // 目标状态数组大小
+    int tused; // 目标状态数组已分配的项数
+    sttable_bitmap_node_t *nodes; // 状态节点
+    int *tids; // 目标状态
+};
+
+/**
+ * @brief 稠密/稀疏混合状态转移表
+ * 浅层和转移多的状态是匹配热点，使用每行CHARSET_SIZE项的稠密行，一次访存取得转移；
+ * 深层的单链尾部状态使用位图稀疏表，不必为每个状态分配整行。
+ * 稠密状态的位图节点为空，off记为~(行号 * CHARSET_SIZE)，查询时先读节点即可区分两种状态。
+ * 补全为完全自动机时，稀疏状态只保存与失配链上最近的稠密状态不同的转移，其余转移取该稠密行
+ */
+struct _sttable_hybrid_s {
+    struct _trie_s *trie; // 树指针，用于取得状态深度
+    int rsize;  // 稠密行数组容量（行数）
+    int rnum;   // 已使用的稠密行数
+    int *dense; // 稠密行，-1表示转移不存在
+    int *dflt;  // 补全为完全自动机后稀疏状态的默认稠密行起点，未补全时为NULL，大小与sparse.nsize相同
+    struct _sttable_bitmap_s sparse; // 状态节点及稀疏状态的转移
 };
 
 typedef struct {
     STTableType type; // 状态转移表类型
+    int mapped;       // 数组位于映射的映像中，只读，销毁时不释放
     union {
         struct _sttable_list_s  lst; // 状态转移-链表
         struct _sttable_array_s ast; // 状态转移-数组
         struct _sttable_hasht_s hst; // 状态转移-散列表
         struct _sttable_dbarr_s dst; // 状态转移-双数组
+        struct _sttable_ohash_s ost; // 状态转移-开放寻址散列表
+        struct _sttable_bitmap_s bst; // 状态转移-位图稀疏表
+        struct _sttable_hybrid_s yst; // 状态转移-稠密/稀疏混合表
     };
 } sttable_t;
 
+/**
+ * @brief 状态转移表在映像中的记录
+ */
+typedef struct {
+    int32_t type;   // 状态转移表类型
+    int32_t num[5]; // 各实现的大小字段
+    int32_t sec[4]; // 各实现的数组所在的段，未使用时为-1
+} sttable_image_t;
+
 /**
  * @brief 创建状态转移表
  * 
@@ -128,4 +280,87 @@ int sttable_get(sttable_t *tbl, int id, char c);
  */
 void sttable_copy(sttable_t *tbl, int fid, int tid);
 
+/**
+ * @brief 将状态的全部转移指向初始状态，仅限状态转移数组实现
+ * 
+ * @param tbl 表指针
+ * @param id  状态
+ */
+void sttable_reset_row(sttable_t *tbl, int id);
+
+/**
+ * @brief 完全自动机构建，状态id继承失配状态fid的转移，须按广度优先顺序调用，fid须已继承
+ * 仅对混合表有效，其他实现返回-1；稠密状态补全整行，
+ * 稀疏状态只增加与默认稠密行不同的转移，默认稠密行为失配链上最近的稠密状态的行
+ * 
+ * @param tbl 表指针
+ * @param id  状态
+ * @param fid 失配状态，稠密状态的全部转移都已存在
+ * @return int 0:成功 -1:失败
+ */
+int sttable_inherit(sttable_t *tbl, int id, int fid);
+
+/**
+ * @brief 按字节等价类压缩状态转移数组，每个状态只保留cnum项
+ * 同一等价类的字节须有完全相同的转移；仅对数组实现有效，其他实现直接返回；
+ * 压缩后设置等价类为0且未出现过的字节的转移时，会自动恢复为CHARSET_SIZE项
+ * 
+ * @param tbl       表指针
+ * @param cls       字节到等价类的映射，等价类0为模式串中未出现的字节
+ * @param cnum      等价类数，不小于CHARSET_SIZE时不压缩
+ * @param state_num 状态数
+ * @return int 0:成功 -1:内存不足
+ */
+int sttable_compress(sttable_t *tbl, const uint8_t *cls, int cnum, int state_num);
+
+/**
+ * @brief 收缩状态转移数组，状态数小于STTABLE_ARRAY16_NONE时改用16位状态ID，内存减半
+ * 仅对数组实现有效，其他实现直接返回；收缩后再设置状态转移会自动恢复为32位
+ * 
+ * @param tbl       表指针
+ * @param state_num 状态数
+ * @return int 0:成功（含无需收缩）
+ */
+int sttable_narrow(sttable_t *tbl, int state_num);
+
+/**
+ * @brief 将收缩后的状态转移数组恢复为32位状态ID，未收缩时直接返回
+ * 
+ * @param tbl 表指针
+ * @return int 0:成功 -1:内存不足
+ */
+int sttable_widen(sttable_t *tbl);
+
+/**
+ * @brief 按map重新编号状态，状态i改为map[i]，全部转移（含构建完全自动机时补全的转移）随之改写
+ * 仅支持数组和混合表，其他实现返回-1；数组实现收缩为16位时先恢复为32位。
+ * 行和状态节点原地置换，只额外分配每个状态一个字节的标记
+ * 
+ * @param tbl       表指针
+ * @param map       新编号，须为0到state_num-1的置换
+ * @param state_num 状态数
+ * @return int 0:成功 -1:类型不支持或内存不足，表保持不变
+ */
+int sttable_renumber(sttable_t *tbl, const int *map, int state_num);
+
+/**
+ * @brief 将状态转移表的数组加入映像，只记录数组指针，写入文件前表不能修改
+ * 散列表的元素以指针链接，不支持
+ * 
+ * @param tbl  表指针
+ * @param w    映像写入器
+ * @param meta 写入状态转移表记录，写入文件前须保持有效
+ * @return int 0:成功 -1:类型不支持
+ */
+int sttable_image_put(const sttable_t *tbl, sm_image_writer_t *w, sttable_image_t *meta);
+
+/**
+ * @brief 从映像创建状态转移表，数组直接使用映射的内存，只能用于查询
+ * 
+ * @param img  映像指针
+ * @param meta 状态转移表记录
+ * @return sttable_t* NULL表示记录与段不符
+ */
+sttable_t* sttable_image_get(const sm_image_t *img, const sttable_image_t *meta);
+
 #endif
\ No newline at end of file
@@ -15,6 +15,7 @@ typedef struct _trie_state_s {
     // 左孩子-右兄弟表示法
     int first;     // 子节点id
     int next;      // 兄弟节点id
+    int pid;       // 模式串id，终止状态有效，重复插入时保留第一次的id
 } TrieState;
 
 /**
@@ -25,10 +26,24 @@ typedef struct _trie_s {
     int depth;         // 树深度
     int state_num;     // 状态数
     int fin_state_num; // 终止状态数（模式串数）
+    int id_num;        // 已分配的模式串id数，每次插入递增
     TrieState *states; // 状态表
     sttable_t *sttbl;  // 状态转移表
+    sm_image_t *image; // 加载的映像，非NULL时状态表和状态转移表位于映射中，只能用于匹配
 } Trie;
 
+/**
+ * @brief trie树在映像中的记录
+ */
+typedef struct {
+    int32_t depth;         // 树深度
+    int32_t state_num;     // 状态数
+    int32_t fin_state_num; // 终止状态数
+    int32_t id_num;        // 已分配的模式串id数
+    int32_t states;        // 状态表所在的段
+    sttable_image_t sttbl; // 状态转移表记录
+} trie_image_t;
+
 /**
  * @brief 创建trie树
  * 
@@ -57,7 +72,7 @@ void trie_destroy(Trie *trie);
  * @param trie 树指针
  * @param p    模式串
  * @param plen 模式串长度
- * @return int 终止状态id
+ * @return int 终止状态id，-1表示失败，无论成功与否都会分配一个模式串id
  */
 int trie_insert(Trie *trie, const char *p, int plen);
 
@@ -95,10 +110,80 @@ int trie_get_trans(const Trie *trie, int state_id, char c);
  * @brief trie树广度优先遍历
  * 
  * @param trie  树指针
- * @return int* 广度优先遍历状态数组
+ * @return int* 广度优先遍历状态数组，内存不足时返回NULL
  */
 int* trie_make_bfs(Trie *trie);
 
+/**
+ * @brief 按模式串中出现的字节计算等价类，压缩数组实现的状态转移表
+ * 未出现的字节归入等价类0，出现的字节各自成类，其他状态转移表实现直接返回
+ * 
+ * @param trie 树指针
+ * @return int 0:成功（含无需压缩） -1:内存不足
+ */
+int trie_compress(Trie *trie);
+
+/**
+ * @brief 按广度优先顺序重新编号状态，并按新编号重建状态转移表
+ * 浅层状态编号连续，匹配时频繁访问的状态集中在少数缓存行和内存页中；
+ * 只重建trie树自身的转移，数组实现保持原有的压缩，状态数较少时收缩为16位状态ID。
+ * 重建期间新旧状态转移表同时存在；重新编号后此前返回的状态id失效，可通过map换算
+ * 
+ * @param trie 树指针
+ * @param map  可为NULL，否则写入旧状态id对应的新状态id，大小不小于state_num
+ * @return int 0:成功 -1:内存不足，树保持不变
+ */
+int trie_relayout(Trie *trie, int *map);
+
+/**
+ * @brief 按map重新编号状态，状态表原地改写，状态转移表中的全部转移随之改写
+ * 与trie_relayout不同，不重建状态转移表，完全自动机补全的转移同样保留；仅支持数组和混合表
+ * 
+ * @param trie 树指针
+ * @param map  新编号，须为0到state_num-1的置换且map[0]为0
+ * @return int 0:成功 -1:类型不支持或内存不足，树保持不变
+ */
+int trie_renumber(Trie *trie, const int *map);
+
+/**
+ * @brief 将trie树加入映像，只记录数组指针，写入文件前树不能修改
+ * 
+ * @param trie 树指针
+ * @param w    映像写入器
+ * @param meta 写入trie树记录，写入文件前须保持有效
+ * @return int 0:成功 -1:状态转移表类型不支持
+ */
+int trie_image_put(const Trie *trie, sm_image_writer_t *w, trie_image_t *meta);
+
+/**
+ * @brief 从映像创建trie树，状态表和状态转移表直接使用映射的内存
+ * 树持有映像，销毁树时解除映射
+ * 
+ * @param img  映像指针
+ * @param meta trie树记录
+ * @return Trie* NULL表示记录与段不符，此时不持有映像
+ */
+Trie* trie_image_get(sm_image_t *img, const trie_image_t *meta);
+
+/**
+ * @brief 将trie树保存为映像文件，散列表实现的状态转移表不支持
+ * 
+ * @param trie 树指针
+ * @param path 文件路径
+ * @return int 0:成功 -1:失败
+ */
+int trie_save(const Trie *trie, const char *path);
+
+/**
+ * @brief 映射映像文件加载trie树，不解析也不拷贝数组，多个进程可共享映射的页面
+ * 加载的树只读，不能再插入模式串
+ * 
+ * @param path   文件路径
+ * @param verify 1:校验全部内容的校验和 0:只校验文件头和段表
+ * @return Trie* NULL表示文件无效
+ */
+Trie* trie_load(const char *path, int verify);
+
 /**
  * @brief trie树多模匹配
  * 
@@ -109,4 +194,16 @@ int* trie_make_bfs(Trie *trie);
  */
 void trie_search(const Trie *trie, const char *s, int slen, match_result_t* result);
 
+/**
+ * @brief trie树多模匹配，每个匹配项交给回调函数
+ * 
+ * @param trie 树指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param cb   回调函数，返回非0时停止匹配
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+int trie_search_cb(const Trie *trie, const char *s, int slen, match_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
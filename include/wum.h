@@ -2,6 +2,7 @@
 #define _WUM_H
 
 #include "smio.h"
+#include "smimage.h"
 
 #define WUM_DEFAULT_PATTERN_NUM 16
 
@@ -9,6 +10,7 @@
  * @brief 字符串节点
  */
 typedef struct _wum_slist_node_s {
+    int id;    // 模式串id
     int len;   // 字符串长度
     char *str; // 字符串
     struct _wum_slist_node_s *next; // 指向下个节点
@@ -45,13 +47,27 @@ typedef struct {
 typedef struct {
     int nsize;      // 模式串表大小
     int pnum;       // 模式串数量
+    int id_num;     // 已分配的模式串id数，每次插入递增
     int min_len;    // 最小模式串长度
+    int max_len;    // 最大模式串长度
     int block_size; // 字符块大小
     wum_shift_t  stbl; // 位移表
     wum_htable_t htbl; // 哈希表
     wum_slist_node_t *nodes; // 模式串表
+    sm_image_t *image; // 加载的映像，非NULL时位移表和模式串位于映射中，只能用于匹配
 } Wum;
 
+/**
+ * @brief WuManber流式匹配上下文
+ * 保存上一块末尾max_len-1字节，与下一块开头拼接后匹配跨块的模式串
+ */
+typedef struct {
+    const Wum *wum; // Wum对象
+    int tlen;       // 缓冲区中上一块末尾的字节数
+    int64_t offset; // 已扫描的字节数，即下一块首字符的绝对偏移
+    char *buf;      // 拼接缓冲区，大小为2*(max_len-1)
+} wum_stream_t;
+
 /**
  * @brief 创建
  * 
@@ -94,6 +110,25 @@ int wum_insert(Wum *wum, const char *p, int plen);
  */
 void wum_build(Wum *wum);
 
+/**
+ * @brief 将已构建的Wum对象保存为映像文件，字符串链表保存为节点下标
+ * 
+ * @param wum  Wum对象
+ * @param path 文件路径
+ * @return int 0:成功 -1:失败
+ */
+int wum_save(const Wum *wum, const char *path);
+
+/**
+ * @brief 映射映像文件加载Wum对象，位移表和模式串直接使用映射的内存，
+ * 只按节点下标重建哈希表链表；加载的对象只读，不能再插入模式串
+ * 
+ * @param path   文件路径
+ * @param verify 1:校验全部内容的校验和 0:只校验文件头和段表
+ * @return Wum* NULL表示文件无效
+ */
+Wum* wum_load(const char *path, int verify);
+
 /**
  * @brief wumaber匹配算法
  * 
@@ -104,4 +139,81 @@ void wum_build(Wum *wum);
  */
 void wum_search(const Wum *wum, const char *s, int slen, match_result_t *result);
 
+/**
+ * @brief wumaber匹配算法，每个匹配项交给回调函数
+ * 
+ * @param wum    Wum对象
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int wum_search_cb(const Wum *wum, const char *s, int slen, match_callback_t cb, void *ctx);
+
+/**
+ * @brief 统计匹配数，不生成匹配结果
+ * 
+ * @param wum    Wum对象
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @return int64_t 匹配数
+ */
+int64_t wum_count(const Wum *wum, const char *s, int slen);
+
+/**
+ * @brief 判断字符串中是否存在模式串，遇到第一个匹配即返回
+ * 
+ * @param wum    Wum对象
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @return int   1:存在 0:不存在
+ */
+int wum_contains(const Wum *wum, const char *s, int slen);
+
+/**
+ * @brief 创建流式匹配上下文，Wum对象需已构建，且生命周期长于上下文
+ * 
+ * @param wum Wum对象
+ * @return wum_stream_t* 
+ */
+wum_stream_t* wum_stream_create(const Wum *wum);
+
+/**
+ * @brief 销毁流式匹配上下文
+ * 
+ * @param stream 
+ */
+void wum_stream_destroy(wum_stream_t *stream);
+
+/**
+ * @brief 重置流式匹配上下文，从新的流开始匹配
+ * 
+ * @param stream 
+ */
+void wum_stream_reset(wum_stream_t *stream);
+
+/**
+ * @brief 流式匹配，依次传入流的各个分块，匹配位置为流中的绝对偏移
+ * 
+ * @param stream 流式匹配上下文
+ * @param s      当前分块
+ * @param slen   分块长度
+ * @param result 匹配结果
+ */
+void wum_stream_search(wum_stream_t *stream, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 流式匹配，每个匹配项交给回调函数
+ * 被回调终止时上下文不再推进，继续使用前需重置
+ * 
+ * @param stream 流式匹配上下文
+ * @param s      当前分块
+ * @param slen   分块长度
+ * @param cb     回调函数，返回非0时停止匹配
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+int wum_stream_search_cb(wum_stream_t *stream, const char *s, int slen, match_callback_t cb, void *ctx);
+
 #endif
\ No newline at end of file
@@ -123,4 +123,361 @@ void bom_search(const char *s, const char *p, int slen, int plen);
  */
 void kr_search(const char *s, const char *p, int slen, int plen);
 
+/**
+ * 预编译单模式串匹配
+ * 模式串预处理一次生成匹配对象，之后可对任意多个文本串重复匹配，
+ * 匹配结果写入match_result_t，不做任何输出
+ */
+
+struct _trie_s;
+
+/**
+ * @brief kmp预编译模式串
+ */
+typedef struct {
+    int plen;  // 模式串长度
+    char *p;   // 模式串
+    int *next; // 失配转移表
+} kmp_pattern_t;
+
+/**
+ * @brief 前向自动机预编译模式串
+ */
+typedef struct {
+    int plen;               // 模式串长度
+    struct _trie_s *trie;   // 前向自动机
+} fam_pattern_t;
+
+/**
+ * @brief shift and预编译模式串
+ */
+typedef struct {
+    int plen;                     // 模式串长度
+    uint64_t target;              // 终止状态位
+    uint64_t mask[CHARSET_SIZE];  // 字符掩码表
+} shift_and_pattern_t;
+
+/**
+ * @brief shift or预编译模式串
+ */
+typedef struct {
+    int plen;                     // 模式串长度
+    uint64_t target;              // 终止状态位
+    uint64_t mask[CHARSET_SIZE];  // 字符掩码表
+} shift_or_pattern_t;
+
+/**
+ * @brief bm预编译模式串
+ */
+typedef struct {
+    int plen;                 // 模式串长度
+    char *p;                  // 模式串
+    int *bmgs;                // 好后缀表
+    int bmbc[CHARSET_SIZE];   // 坏字符表
+} bm_pattern_t;
+
+/**
+ * @brief horspool预编译模式串
+ */
+typedef struct {
+    int plen;                 // 模式串长度
+    char *p;                  // 模式串
+    int shift[CHARSET_SIZE];  // 失配移动距离表
+} horspool_pattern_t;
+
+/**
+ * @brief sunday预编译模式串
+ */
+typedef struct {
+    int plen;                 // 模式串长度
+    char *p;                  // 模式串
+    int shift[CHARSET_SIZE];  // 失配移动距离表
+} sunday_pattern_t;
+
+/**
+ * @brief bndm预编译模式串
+ */
+typedef struct {
+    int plen;                     // 模式串长度
+    uint64_t mask[CHARSET_SIZE];  // 字符掩码表
+} bndm_pattern_t;
+
+/**
+ * @brief bom预编译模式串
+ */
+typedef struct {
+    int plen;               // 模式串长度
+    struct _trie_s *trie;   // 反转模式串的factor oracle
+} bom_pattern_t;
+
+/**
+ * @brief karp-rabin预编译模式串
+ */
+typedef struct {
+    int plen;              // 模式串长度
+    char *p;               // 模式串
+    uint64_t hash;         // 模式串哈希值
+    uint64_t minus_factor; // 滚动哈希移出因子
+} kr_pattern_t;
+
+/**
+ * @brief 预编译kmp模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return kmp_pattern_t* NULL表示失败
+ */
+kmp_pattern_t* kmp_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁kmp模式串
+ * 
+ * @param kmp 
+ */
+void kmp_pattern_destroy(kmp_pattern_t *kmp);
+
+/**
+ * @brief kmp匹配
+ * 
+ * @param kmp    预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void kmp_pattern_search(const kmp_pattern_t *kmp, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译前向自动机
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return fam_pattern_t* NULL表示失败
+ */
+fam_pattern_t* fam_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁前向自动机
+ * 
+ * @param fam 
+ */
+void fam_pattern_destroy(fam_pattern_t *fam);
+
+/**
+ * @brief 前向自动机匹配
+ * 
+ * @param fam    预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void fam_pattern_search(const fam_pattern_t *fam, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译shift and模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度，不超过64
+ * @return shift_and_pattern_t* NULL表示失败
+ */
+shift_and_pattern_t* shift_and_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁shift and模式串
+ * 
+ * @param sa 
+ */
+void shift_and_pattern_destroy(shift_and_pattern_t *sa);
+
+/**
+ * @brief shift and匹配
+ * 
+ * @param sa     预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void shift_and_pattern_search(const shift_and_pattern_t *sa, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译shift or模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度，不超过64
+ * @return shift_or_pattern_t* NULL表示失败
+ */
+shift_or_pattern_t* shift_or_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁shift or模式串
+ * 
+ * @param so 
+ */
+void shift_or_pattern_destroy(shift_or_pattern_t *so);
+
+/**
+ * @brief shift or匹配
+ * 
+ * @param so     预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void shift_or_pattern_search(const shift_or_pattern_t *so, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译bm模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return bm_pattern_t* NULL表示失败
+ */
+bm_pattern_t* bm_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁bm模式串
+ * 
+ * @param bm 
+ */
+void bm_pattern_destroy(bm_pattern_t *bm);
+
+/**
+ * @brief bm匹配
+ * 
+ * @param bm     预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void bm_pattern_search(const bm_pattern_t *bm, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译horspool模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return horspool_pattern_t* NULL表示失败
+ */
+horspool_pattern_t* horspool_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁horspool模式串
+ * 
+ * @param hp 
+ */
+void horspool_pattern_destroy(horspool_pattern_t *hp);
+
+/**
+ * @brief horspool匹配
+ * 
+ * @param hp     预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void horspool_pattern_search(const horspool_pattern_t *hp, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译sunday模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return sunday_pattern_t* NULL表示失败
+ */
+sunday_pattern_t* sunday_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁sunday模式串
+ * 
+ * @param sd 
+ */
+void sunday_pattern_destroy(sunday_pattern_t *sd);
+
+/**
+ * @brief sunday匹配
+ * 
+ * @param sd     预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void sunday_pattern_search(const sunday_pattern_t *sd, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译bndm模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度，不超过64
+ * @return bndm_pattern_t* NULL表示失败
+ */
+bndm_pattern_t* bndm_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁bndm模式串
+ * 
+ * @param bndm 
+ */
+void bndm_pattern_destroy(bndm_pattern_t *bndm);
+
+/**
+ * @brief bndm匹配
+ * 
+ * @param bndm   预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void bndm_pattern_search(const bndm_pattern_t *bndm, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译bom模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return bom_pattern_t* NULL表示失败
+ */
+bom_pattern_t* bom_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁bom模式串
+ * 
+ * @param bom 
+ */
+void bom_pattern_destroy(bom_pattern_t *bom);
+
+/**
+ * @brief bom匹配
+ * 
+ * @param bom    预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void bom_pattern_search(const bom_pattern_t *bom, const char *s, int slen, match_result_t *result);
+
+/**
+ * @brief 预编译karp-rabin模式串
+ * 
+ * @param p    模式串
+ * @param plen 模式串长度
+ * @return kr_pattern_t* NULL表示失败
+ */
+kr_pattern_t* kr_pattern_create(const char *p, int plen);
+
+/**
+ * @brief 销毁karp-rabin模式串
+ * 
+ * @param kr 
+ */
+void kr_pattern_destroy(kr_pattern_t *kr);
+
+/**
+ * @brief karp-rabin匹配
+ * 
+ * @param kr     预编译模式串
+ * @param s      文本串
+ * @param slen   文本串长度
+ * @param result 匹配结果
+ */
+void kr_pattern_search(const kr_pattern_t *kr, const char *s, int slen, match_result_t *result);
+
 #endif
\ No newline at end of file
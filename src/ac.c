@@ -1,43 +1,92 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ac.h"
+#include "internal/sttable_get.h"
+
+// 完全自动机状态数较少时转移表收缩为16位状态ID，主循环按两种宽度分别实例化
+#define AC_FULL_STTABLE_TYPE16 STTABLE_TYPE_ARRAY16
 
 AC* ac_create(ACLevel level) {
-    AC *ac = (AC *)malloc(sizeof(AC));
-    if (level == AC_LEVEL_FULL) {
-        ac->trie = trie_create(STTABLE_TYPE_ARRAY);
-    } else {
-        ac->trie = trie_create(STTABLE_TYPE_DBARR);
+    return ac_create_typed(level, level == AC_LEVEL_FULL ? AC_FULL_STTABLE_TYPE : AC_PART_STTABLE_TYPE);
+}
+
+AC* ac_create_typed(ACLevel level, STTableType sttype) {
+    // 完全自动机需要整行拷贝或按差异继承失配状态的转移，只能使用数组或混合表
+    if ((level == AC_LEVEL_FULL && sttype != AC_FULL_STTABLE_TYPE && sttype != STTABLE_TYPE_HYBRID)
+        || sttype == STTABLE_TYPE_ARRAY16 || sttype == STTABLE_TYPE_HYBRID_DIFF) {
+        return NULL;
     }
+    AC *ac = (AC *)calloc(1, sizeof(AC));
+    ac->trie = trie_create(sttype);
     ac->level = level;
     ac->suff = NULL;
     ac->next = NULL;
+    ac->outn = NULL;
     return ac;
 }
 
 AC* ac_create_ex(const char *patterns[], int pnum, ACLevel level) {
-    AC *ac = (AC *)malloc(sizeof(AC));
+    AC *ac = (AC *)calloc(1, sizeof(AC));
     if (level == AC_LEVEL_FULL) {
-        ac->trie = trie_create_ex(patterns, pnum, STTABLE_TYPE_ARRAY);
+        ac->trie = trie_create_ex(patterns, pnum, AC_FULL_STTABLE_TYPE);
     } else {
-        ac->trie = trie_create_ex(patterns, pnum, STTABLE_TYPE_DBARR);
+        ac->trie = trie_create_ex(patterns, pnum, AC_PART_STTABLE_TYPE);
     }
     ac->level = level;
     ac->suff = NULL;
     ac->next = NULL;
+    ac->outn = NULL;
     ac_build(ac);
     return ac;
 }
 
-void ac_destroy(AC *ac) {
-    trie_destroy(ac->trie);
+/**
+ * @brief 释放失配树
+ * 
+ * @param ac 自动机指针
+ */
+static void ac_fail_tree_free(AC *ac) {
+    free(ac->fkid);
+    free(ac->fnext);
+    free(ac->fprev);
+    ac->fkid = NULL;
+    ac->fnext = NULL;
+    ac->fprev = NULL;
+}
+
+/**
+ * @brief 释放构建生成的各表和失配树，自动机回到未构建状态
+ * 
+ * @param ac 自动机指针
+ */
+static void ac_build_free(AC *ac) {
     free(ac->suff);
     free(ac->next);
-    free(ac);
+    free(ac->outn);
+    free(ac->outl);
+    free(ac->outs);
+    ac->suff = NULL;
+    ac->next = NULL;
+    ac->outn = NULL;
+    ac->outl = NULL;
+    ac->outs = NULL;
+    ac->out_min = 0;
+    ac->size = 0;
+    ac_fail_tree_free(ac);
 }
 
-int ac_insert(AC *ac, const char *p, int plen) {
-    return trie_insert(ac->trie, p, plen);
+void ac_destroy(AC *ac) {
+    // 加载的自动机各表位于映像中，由trie树解除映射
+    if (ac->trie->image == NULL) {
+        free(ac->suff);
+        free(ac->next);
+        free(ac->outn);
+        free(ac->outl);
+        free(ac->outs);
+    }
+    ac_fail_tree_free(ac);
+    trie_destroy(ac->trie);
+    free(ac);
 }
 
 /**
@@ -61,11 +110,16 @@ static void ac_copy_stt(AC *ac, int from_id, int to_id) {
     }
 }
 
-static void ac_build_full(AC *ac) {
+static int ac_build_full(AC *ac) {
     Trie *trie = ac->trie;
     int *bfs_ids = trie_make_bfs(trie);
+    // 重复构建时先恢复为32位状态ID
+    if (bfs_ids == NULL || sttable_widen(trie->sttbl) != 0) {
+        free(bfs_ids);
+        return -1;
+    }
     // 初始状态满足AC条件
-    memset(trie->sttbl->ast.stt, 0, sizeof(int) * CHARSET_SIZE);
+    sttable_reset_row(trie->sttbl, 0);
     // 层次遍历使各状态依次满足AC条件
     // 每一层的状态都会暂时和下一层断开连接
     for (int i = 1; i < trie->state_num; i++) {
@@ -85,11 +139,60 @@ static void ac_build_full(AC *ac) {
         ac_copy_stt(ac, k, state_id);
     }
     free(bfs_ids);
+    return 0;
 }
 
-static void ac_build_part(AC *ac) {
+/**
+ * @brief 以混合表构建完全自动机
+ * 按广度优先顺序求出失配状态，每个状态只继承与失配链上最近的稠密行不同的转移，
+ * 匹配时每个字符仍只查一次表，内存与实际不同的转移数成正比
+ * 
+ * @param ac 自动机指针
+ * @return int 0:成功 -1:内存不足
+ */
+static int ac_build_full_diff(AC *ac) {
     Trie *trie = ac->trie;
     int *bfs_ids = trie_make_bfs(trie);
+    int *fail = (int *)calloc(trie->state_num, sizeof(int));
+    if (bfs_ids == NULL || fail == NULL) {
+        free(bfs_ids);
+        free(fail);
+        return -1;
+    }
+    int ret = 0;
+    // 初始状态没有的转移回到初始状态
+    for (int c = 0; c < CHARSET_SIZE; c++) {
+        if (trie_get_trans(trie, 0, (char)c) == -1) {
+            trie_set_trans(trie, 0, 0, (char)c);
+        }
+    }
+    for (int i = 1; i < trie->state_num; i++) {
+        int state_id = bfs_ids[i];
+        TrieState *state = &trie->states[state_id];
+        // 第一层状态的失配状态为初始状态，其余为父状态的失配状态经同一字符的转移
+        int k = state->parent == 0 ? 0 : trie_get_trans(trie, fail[state->parent], state->c);
+        fail[state_id] = k;
+        if (trie->states[k].is_fin) {
+            ac->suff[state_id] = k;
+        } else {
+            ac->suff[state_id] = ac->suff[k];
+        }
+        if (sttable_inherit(trie->sttbl, state_id, k) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+    free(fail);
+    free(bfs_ids);
+    return ret;
+}
+
+static int ac_build_part(AC *ac) {
+    Trie *trie = ac->trie;
+    int *bfs_ids = trie_make_bfs(trie);
+    if (bfs_ids == NULL) {
+        return -1;
+    }
     for (int i = 1; i < trie->state_num; i++) {
         int state_id = bfs_ids[i];
         TrieState *state = &trie->states[state_id];
@@ -111,61 +214,1078 @@ static void ac_build_part(AC *ac) {
         }
     }
     free(bfs_ids);
+    return 0;
 }
 
-void ac_build(AC *ac) {
+/**
+ * @brief 计算各状态的输出数
+ * 后缀状态深度更小，按广度优先顺序计算即可保证后缀状态已计算
+ * 
+ * @param ac 自动机指针
+ * @return int 0:成功 -1:内存不足
+ */
+static int ac_build_outn(AC *ac) {
+    Trie *trie = ac->trie;
+    int *bfs_ids = trie_make_bfs(trie);
+    ac->outn = (int *)calloc(trie->state_num, sizeof(int));
+    if (bfs_ids == NULL || ac->outn == NULL) {
+        free(bfs_ids);
+        return -1;
+    }
+    for (int i = 1; i < trie->state_num; i++) {
+        int state_id = bfs_ids[i];
+        int suff = ac->suff[state_id];
+        ac->outn[state_id] = trie->states[state_id].is_fin + (suff != -1 ? ac->outn[suff] : 0);
+    }
+    free(bfs_ids);
+    return 0;
+}
+
+/**
+ * @brief 完全自动机按有无输出重新编号，并展平各状态的输出列表
+ * 无输出的状态保持原有相对顺序排在前面，初始状态仍为0；有输出的状态排在out_min及之后。
+ * 终止状态的输出列表为自身的模式串加上后缀状态的列表，按广度优先顺序生成时后缀状态的列表已生成
+ * 
+ * @param ac  自动机指针
+ * @param map 可为NULL，否则map[i]改写为map[i]经本次重新编号后的id
+ * @return int 0:成功 -1:内存不足，自动机保持不变
+ */
+static int ac_build_outputs(AC *ac, int *map) {
+    Trie *trie = ac->trie;
+    int num = trie->state_num;
+    int *perm = (int *)malloc(sizeof(int) * num);
+    int *suff = (int *)malloc(sizeof(int) * num);
+    int *outn = (int *)malloc(sizeof(int) * num);
+    int *bfs_ids = trie_make_bfs(trie);
+    if (perm == NULL || suff == NULL || outn == NULL || bfs_ids == NULL) {
+        goto fail;
+    }
+    int out_min = 0;
+    for (int i = 0; i < num; i++) {
+        if (ac->outn[i] == 0) {
+            perm[i] = out_min++;
+        }
+    }
+    int total = 0;
+    for (int i = 0, k = out_min; i < num; i++) {
+        if (ac->outn[i] != 0) {
+            perm[i] = k++;
+            total += trie->states[i].is_fin ? ac->outn[i] : 0;
+        }
+    }
+    ac_outlist_t *outl = (ac_outlist_t *)malloc(sizeof(ac_outlist_t) * (num - out_min + 1));
+    ac_output_t *outs = (ac_output_t *)malloc(sizeof(ac_output_t) * (total + 1));
+    if (outl == NULL || outs == NULL || trie_renumber(trie, perm) != 0) {
+        free(outl);
+        free(outs);
+        goto fail;
+    }
+    for (int i = 0; i < num; i++) {
+        suff[perm[i]] = ac->suff[i] != -1 ? perm[ac->suff[i]] : -1;
+        outn[perm[i]] = ac->outn[i];
+        // 重新编号不改变兄弟顺序，广度优先顺序随之换成新编号
+        bfs_ids[i] = perm[bfs_ids[i]];
+    }
+    if (map != NULL) {
+        for (int i = 0; i < num; i++) {
+            map[i] = perm[map[i]];
+        }
+    }
+    free(perm);
+    free(ac->suff);
+    free(ac->outn);
+    ac->suff = suff;
+    ac->outn = outn;
+    for (int i = 1, pos = 0; i < num; i++) {
+        int state_id = bfs_ids[i];
+        if (state_id < out_min) {
+            continue;
+        }
+        const TrieState *state = &trie->states[state_id];
+        ac_outlist_t *list = &outl[state_id - out_min];
+        list->num = outn[state_id];
+        // 有输出的非终止状态，后缀状态一定是终止状态
+        if (!state->is_fin) {
+            list->off = outl[suff[state_id] - out_min].off;
+            continue;
+        }
+        list->off = pos;
+        outs[pos].len = state->depth;
+        outs[pos].pid = state->pid;
+        if (suff[state_id] != -1) {
+            const ac_outlist_t *slist = &outl[suff[state_id] - out_min];
+            memcpy(outs + pos + 1, outs + slist->off, sizeof(ac_output_t) * slist->num);
+        }
+        pos += list->num;
+    }
+    free(bfs_ids);
+    ac->out_min = out_min;
+    ac->outl = outl;
+    ac->outs = outs;
+    return 0;
+fail:
+    free(perm);
+    free(suff);
+    free(outn);
+    free(bfs_ids);
+    return -1;
+}
+
+/**
+ * @brief 构建AC自动机，参数同ac_build_ex
+ * 
+ * @param map 可为NULL，否则map[i]改写为完全自动机按有无输出重新编号后的id
+ * @return int 0:成功 -1:失败（映像加载的自动机或内存不足）
+ */
+static int ac_build_core(AC *ac, int compress, int *map) {
+    if (ac->trie->image != NULL) {
+        return -1;
+    }
+    // 重复构建时释放上次构建的各表
+    ac_build_free(ac);
     ac->suff = (int *)malloc(sizeof(int) * ac->trie->state_num);
+    if (ac->suff == NULL) {
+        return -1;
+    }
     memset(ac->suff, -1, sizeof(int) * ac->trie->state_num);
     if (ac->level == AC_LEVEL_FULL) {
-        ac_build_full(ac);
+        // 压缩失败时保持原表，不影响构建
+        if (compress) {
+            trie_compress(ac->trie);
+        }
+        int ret = ac->trie->sttbl->type == STTABLE_TYPE_HYBRID ? ac_build_full_diff(ac) : ac_build_full(ac);
+        if (ret != 0) {
+            goto fail;
+        }
     } else {
         ac->next = (int *)malloc(sizeof(int) * ac->trie->state_num);
+        if (ac->next == NULL) {
+            goto fail;
+        }
         memset(ac->next, 0, sizeof(int) * ac->trie->state_num);
         ac->next[0] = -1;
-        ac_build_part(ac);
+        if (ac_build_part(ac) != 0) {
+            goto fail;
+        }
     }
+    if (ac_build_outn(ac) != 0) {
+        goto fail;
+    }
+    if (ac->level == AC_LEVEL_FULL) {
+        // 输出列表未生成时out_min和outl无效，不能用于匹配
+        if (ac_build_outputs(ac, map) != 0) {
+            goto fail;
+        }
+        // 状态数较少时改用16位状态ID，转移表内存减半
+        sttable_narrow(ac->trie->sttbl, ac->trie->state_num);
+    }
+    ac->size = ac->trie->state_num;
+    return 0;
+fail:
+    ac_build_free(ac);
+    return -1;
 }
 
-static void ac_search_full(const AC *ac, const char *s, int slen, match_result_t *result) {
-    for (int i = 0, state_id = 0; i < slen; i++) {
-        state_id = trie_get_trans(ac->trie, state_id, s[i]);
-        TrieState *state = &ac->trie->states[state_id];
-        if (state->is_fin) {
-            match_result_append(result, state->depth, i - state->depth + 1);
+void ac_build(AC *ac) {
+    ac_build_ex(ac, 0);
+}
+
+int ac_build_ex(AC *ac, int compress) {
+    return ac_build_core(ac, compress, NULL);
+}
+
+int ac_relayout(AC *ac, int *map) {
+    if (trie_relayout(ac->trie, map) != 0) {
+        return -1;
+    }
+    // 数组实现的压缩已由trie_relayout保持
+    return ac_build_core(ac, 0, map);
+}
+
+/**
+ * @brief 将状态挂到失配树中失配状态fid之下，并记录为其失配状态
+ * 
+ * @param ac  自动机指针
+ * @param id  状态id
+ * @param fid 失配状态id
+ */
+static void ac_fail_link(AC *ac, int id, int fid) {
+    int head = ac->fkid[fid];
+    ac->fnext[id] = head;
+    ac->fprev[id] = -1;
+    if (head != -1) {
+        ac->fprev[head] = id;
+    }
+    ac->fkid[fid] = id;
+    ac->next[id] = fid;
+}
+
+/**
+ * @brief 将状态从失配树中摘下，失配状态不变
+ * 
+ * @param ac 自动机指针
+ * @param id 状态id
+ */
+static void ac_fail_unlink(AC *ac, int id) {
+    if (ac->fprev[id] != -1) {
+        ac->fnext[ac->fprev[id]] = ac->fnext[id];
+    } else {
+        ac->fkid[ac->next[id]] = ac->fnext[id];
+    }
+    if (ac->fnext[id] != -1) {
+        ac->fprev[ac->fnext[id]] = ac->fprev[id];
+    }
+}
+
+/**
+ * @brief 失配树中以root为根的子树的先序遍历，返回x之后的状态
+ * 沿失配状态回溯，不需要栈
+ * 
+ * @param ac      自动机指针
+ * @param root    子树根
+ * @param x       当前状态
+ * @param descend 是否进入x的子树
+ * @return int 下一个状态，-1表示遍历结束
+ */
+static int ac_fail_tree_step(const AC *ac, int root, int x, int descend) {
+    if (descend && ac->fkid[x] != -1) {
+        return ac->fkid[x];
+    }
+    while (x != root && ac->fnext[x] == -1) {
+        x = ac->next[x];
+    }
+    return x == root ? -1 : ac->fnext[x];
+}
+
+/**
+ * @brief 按失配表建立失配树
+ * 
+ * @param ac 自动机指针
+ */
+static void ac_fail_tree_init(AC *ac) {
+    memset(ac->fkid, -1, sizeof(int) * ac->size);
+    for (int id = ac->trie->state_num - 1; id > 0; id--) {
+        ac_fail_link(ac, id, ac->next[id]);
+    }
+}
+
+/**
+ * @brief 各数组扩展到不小于size，容量至少翻倍；失配树不存在时建立
+ * 
+ * @param ac   自动机指针
+ * @param size 需要的容量
+ * @return int 0:成功 -1:内存不足
+ */
+static int ac_reserve(AC *ac, int size) {
+    int built = ac->fkid != NULL;
+    if (built && size <= ac->size) {
+        return 0;
+    }
+    if (size <= ac->size) {
+        size = ac->size;
+    } else if (size < ac->size * 2) {
+        size = ac->size * 2;
+    }
+    int **arrays[] = {&ac->suff, &ac->next, &ac->outn, &ac->fkid, &ac->fnext, &ac->fprev};
+    for (int i = 0; i < 6; i++) {
+        int *array = (int *)realloc(*arrays[i], sizeof(int) * size);
+        if (array == NULL) {
+            if (!built) {
+                ac_fail_tree_free(ac);
+            }
+            return -1;
         }
-        for (int id = ac->suff[state_id]; id != -1; id = ac->suff[id]) {
-            state = &ac->trie->states[id];
-            match_result_append(result, state->depth, i - state->depth + 1);
+        *arrays[i] = array;
+    }
+    ac->size = size;
+    if (!built) {
+        ac_fail_tree_init(ac);
+    }
+    return 0;
+}
+
+/**
+ * @brief 状态fin成为终止状态或不再是终止状态时，更新失配树中以其为根的子树
+ * 子树中的状态都以fin为后缀，输出数增减1；后缀链上最近的终止状态在fin之上的改为fin或恢复
+ * 
+ * @param ac  自动机指针
+ * @param fin 状态id
+ * @param add 1:成为终止状态 0:不再是终止状态
+ */
+static void ac_update_outputs(AC *ac, int fin, int add) {
+    int above = ac->suff[fin];
+    ac->outn[fin] += add ? 1 : -1;
+    for (int x = ac->fkid[fin]; x != -1; x = ac_fail_tree_step(ac, fin, x, 1)) {
+        ac->outn[x] += add ? 1 : -1;
+        if (add && ac->suff[x] == above) {
+            ac->suff[x] = fin;
+        } else if (!add && ac->suff[x] == fin) {
+            ac->suff[x] = above;
         }
     }
 }
 
-static void ac_search_part(const AC *ac, const char *s, int slen, match_result_t *result) {
-    for (int i = 0, state_id = 0, target = 0; i < slen;) {
+/**
+ * @brief 新状态加入失配树，并把受影响的已有状态改为失配到新状态
+ * 以新状态v（父状态p加字符c）为后缀的状态u = q + c，q在p的失配子树中；
+ * u的失配状态比v浅时改为v，u已存在时q的子树中同样转移的目标以u为更长后缀，不必再访问
+ * 
+ * @param ac    自动机指针
+ * @param v     新状态id，小于v的状态都已有失配状态
+ * @param moved 待改为失配到v的状态缓冲区，容量不小于状态数
+ */
+static void ac_insert_state(AC *ac, int v, int *moved) {
+    Trie *trie = ac->trie;
+    int p = trie->states[v].parent;
+    char c = trie->states[v].c;
+    int depth = trie->states[v].depth;
+    int fid = 0;
+    for (int j = ac->next[p]; j != -1; j = ac->next[j]) {
+        int t = trie_get_trans(trie, j, c);
+        if (t != -1) {
+            fid = t;
+            break;
+        }
+    }
+    ac_fail_link(ac, v, fid);
+    ac->suff[v] = trie->states[fid].is_fin ? fid : ac->suff[fid];
+    // 终止状态的自身输出由ac_update_outputs计入
+    ac->outn[v] = ac->suff[v] != -1 ? ac->outn[ac->suff[v]] : 0;
+    // 先收集再移动，遍历期间失配树保持不变
+    int num = 0;
+    for (int q = ac->fkid[p], u = 0; q != -1; q = ac_fail_tree_step(ac, p, q, u == -1 || u > v)) {
+        u = trie_get_trans(trie, q, c);
+        if (u != -1 && u < v && trie->states[ac->next[u]].depth < depth) {
+            moved[num++] = u;
+        }
+    }
+    for (int i = 0; i < num; i++) {
+        ac_fail_unlink(ac, moved[i]);
+        ac_fail_link(ac, moved[i], v);
+    }
+}
+
+int ac_insert(AC *ac, const char *p, int plen) {
+    Trie *trie = ac->trie;
+    if (ac->suff == NULL) {
+        return trie_insert(trie, p, plen);
+    }
+    if (ac->level == AC_LEVEL_FULL || trie->image != NULL) {
+        return -1;
+    }
+    int state_num = trie->state_num;
+    int fin_num = trie->fin_state_num;
+    // 插入前按最多新增plen个状态分配，插入后的新状态一定能加入失配树
+    int size = state_num + (plen > 0 ? plen : 0);
+    int *moved = (int *)malloc(sizeof(int) * size);
+    if (moved == NULL || ac_reserve(ac, size) != 0) {
+        free(moved);
+        return -1;
+    }
+    int fin = trie_insert(trie, p, plen);
+    // 新状态按路径顺序编号，深度递增；插入中途失败时已建立的状态同样处理
+    for (int v = state_num; v < trie->state_num; v++) {
+        ac->fkid[v] = -1;
+        ac_insert_state(ac, v, moved);
+    }
+    free(moved);
+    if (fin != -1 && trie->fin_state_num > fin_num) {
+        ac_update_outputs(ac, fin, 1);
+    }
+    return fin;
+}
+
+int ac_remove(AC *ac, const char *p, int plen) {
+    Trie *trie = ac->trie;
+    if ((ac->suff != NULL && ac->level == AC_LEVEL_FULL) || trie->image != NULL || plen <= 0) {
+        return -1;
+    }
+    int fin = 0;
+    for (int i = 0; i < plen && fin != -1; i++) {
+        fin = trie_get_trans(trie, fin, p[i]);
+    }
+    if (fin == -1 || !trie->states[fin].is_fin) {
+        return -1;
+    }
+    if (ac->suff != NULL) {
+        if (ac_reserve(ac, trie->state_num) != 0) {
+            return -1;
+        }
+        ac_update_outputs(ac, fin, 0);
+    }
+    trie->states[fin].is_fin = 0;
+    --trie->fin_state_num;
+    return 0;
+}
+
+/**
+ * @brief AC自动机在映像中的记录
+ */
+typedef struct {
+    int32_t level; // 自动机等级
+    int32_t suff;  // 状态回溯表所在的段
+    int32_t next;  // 失配状态跳转表所在的段，完全自动机为-1
+    int32_t outn;  // 状态输出数表所在的段
+    int32_t out_min;  // 完全自动机首个有输出的状态id
+    int32_t out_num;  // 完全自动机输出项数
+    int32_t outl;     // 完全自动机输出列表所在的段，不完全自动机为-1
+    int32_t outs;     // 完全自动机输出项数组所在的段，不完全自动机为-1
+    trie_image_t trie; // trie树记录
+} ac_image_t;
+
+int ac_save(const AC *ac, const char *path) {
+    if (ac->suff == NULL) {
+        return -1;
+    }
+    sm_image_writer_t w;
+    ac_image_t meta;
+    int size = sizeof(int) * ac->trie->state_num;
+    sm_image_writer_init(&w, SM_IMAGE_AC);
+    sm_image_add(&w, &meta, sizeof(meta));
+    meta.level = ac->level;
+    meta.suff = sm_image_add(&w, ac->suff, size);
+    meta.next = ac->next != NULL ? sm_image_add(&w, ac->next, size) : -1;
+    meta.outn = sm_image_add(&w, ac->outn, size);
+    meta.out_min = ac->out_min;
+    meta.out_num = 0;
+    meta.outl = meta.outs = -1;
+    if (ac->level == AC_LEVEL_FULL) {
+        // 非终止状态共用后缀状态的列表，输出项数为终止状态的输出数之和
+        for (int i = ac->out_min; i < ac->trie->state_num; i++) {
+            meta.out_num += ac->trie->states[i].is_fin ? ac->outn[i] : 0;
+        }
+        meta.outl = sm_image_add(&w, ac->outl, sizeof(ac_outlist_t) * (ac->trie->state_num - ac->out_min));
+        meta.outs = sm_image_add(&w, ac->outs, sizeof(ac_output_t) * (uint64_t)meta.out_num);
+    }
+    if (trie_image_put(ac->trie, &w, &meta.trie) != 0) {
+        return -1;
+    }
+    return sm_image_write(&w, path);
+}
+
+AC* ac_load(const char *path, int verify) {
+    sm_image_t *img = sm_image_open(path, SM_IMAGE_AC, verify);
+    if (img == NULL) {
+        return NULL;
+    }
+    const ac_image_t *meta = (const ac_image_t *)sm_image_get(img, 0, sizeof(ac_image_t));
+    Trie *trie = meta != NULL ? trie_image_get(img, &meta->trie) : NULL;
+    AC *ac = trie != NULL ? (AC *)calloc(1, sizeof(AC)) : NULL;
+    if (ac == NULL) {
+        if (trie != NULL) {
+            trie_destroy(trie);
+        } else {
+            sm_image_close(img);
+        }
+        return NULL;
+    }
+    uint64_t size = sizeof(int) * (uint64_t)trie->state_num;
+    ac->trie = trie;
+    ac->level = meta->level == AC_LEVEL_FULL ? AC_LEVEL_FULL : AC_LEVEL_PART;
+    ac->suff = (int *)sm_image_get(img, meta->suff, size);
+    ac->next = ac->level == AC_LEVEL_PART ? (int *)sm_image_get(img, meta->next, size) : NULL;
+    ac->outn = (int *)sm_image_get(img, meta->outn, size);
+    ac->size = trie->state_num;
+    if (ac->level == AC_LEVEL_FULL && meta->out_min >= 0 && meta->out_min <= trie->state_num && meta->out_num >= 0) {
+        ac->out_min = meta->out_min;
+        ac->outl = (ac_outlist_t *)sm_image_get(img, meta->outl,
+                                                sizeof(ac_outlist_t) * (uint64_t)(trie->state_num - meta->out_min));
+        ac->outs = (ac_output_t *)sm_image_get(img, meta->outs, sizeof(ac_output_t) * (uint64_t)meta->out_num);
+    }
+    if (ac->suff == NULL || ac->outn == NULL || (ac->level == AC_LEVEL_PART && ac->next == NULL)
+        || (ac->level == AC_LEVEL_FULL && (ac->outl == NULL || ac->outs == NULL))) {
+        ac_destroy(ac);
+        return NULL;
+    }
+    return ac;
+}
+
+/**
+ * @brief 完全AC自动机扫描主循环
+ * 
+ * @param ac    自动机指针
+ * @param s     字符串
+ * @param slen  字符串长度
+ * @param state 起始状态，扫描完成后写回结束状态
+ * @param base  字符串首字符的绝对偏移
+ * @param type  状态转移表实例类型，以常量实例化
+ * @param cb    回调函数
+ * @param ctx   回调上下文
+ * @return int  0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int ac_search_full(const AC *ac, const char *s, int slen, int *state, int64_t base,
+                             STTableType type, match_callback_t cb, void *ctx) {
+    const sttable_t *tbl = ac->trie->sttbl;
+    const int out_min = ac->out_min;
+    int state_id = *state;
+    for (int i = 0; i < slen; i++) {
+        state_id = sttable_get_typed(tbl, type, state_id, s[i]);
+        // 无输出的状态id小于out_min，没有匹配时不再访存
+        if (state_id >= out_min) {
+            const ac_outlist_t *list = &ac->outl[state_id - out_min];
+            const ac_output_t *out = ac->outs + list->off;
+            for (int k = 0; k < list->num; k++) {
+                if (match_emit(cb, ctx, out[k].len, base + i - out[k].len + 1, out[k].pid) != 0) {
+                    return -1;
+                }
+            }
+        }
+    }
+    *state = state_id;
+    return 0;
+}
+
+/**
+ * @brief 按状态转移表实例类型选择完全AC自动机主循环实例，参数同ac_search_full
+ */
+SM_INLINE int ac_search_full_dispatch(const AC *ac, const char *s, int slen, int *state, int64_t base,
+                                      match_callback_t cb, void *ctx) {
+    switch (sttable_inst_type(ac->trie->sttbl)) {
+        case AC_FULL_STTABLE_TYPE16:
+            return ac_search_full(ac, s, slen, state, base, AC_FULL_STTABLE_TYPE16, cb, ctx);
+        case STTABLE_TYPE_HYBRID_DIFF:
+            return ac_search_full(ac, s, slen, state, base, STTABLE_TYPE_HYBRID_DIFF, cb, ctx);
+        default:
+            return ac_search_full(ac, s, slen, state, base, AC_FULL_STTABLE_TYPE, cb, ctx);
+    }
+}
+
+/**
+ * @brief 不完全AC自动机扫描主循环，参数同ac_search_full
+ */
+SM_INLINE int ac_search_part(const AC *ac, const char *s, int slen, int *state, int64_t base,
+                             STTableType type, match_callback_t cb, void *ctx) {
+    const sttable_t *tbl = ac->trie->sttbl;
+    int state_id = *state;
+    for (int i = 0, target = 0; i < slen;) {
         if (state_id == -1) {
             ++i;
             state_id = 0;
-        } else if ((target = trie_get_trans(ac->trie, state_id, s[i])) != -1) {
+        } else if ((target = sttable_get_typed(tbl, type, state_id, s[i])) != -1) {
             ++i;
             state_id = target;
-            TrieState *state = &ac->trie->states[target];
-            if (state->is_fin) {
-                match_result_append(result, state->depth, i - state->depth);
+            TrieState *st = &ac->trie->states[target];
+            if (st->is_fin) {
+                if (match_emit(cb, ctx, st->depth, base + i - st->depth, st->pid) != 0) {
+                    return -1;
+                }
             }
             for (int id = ac->suff[target]; id != -1; id = ac->suff[id]) {
-                state = &ac->trie->states[id];
-                match_result_append(result, state->depth, i - state->depth);
+                st = &ac->trie->states[id];
+                if (match_emit(cb, ctx, st->depth, base + i - st->depth, st->pid) != 0) {
+                    return -1;
+                }
             }
         } else {
             state_id = ac->next[state_id];
         }
     }
+    *state = state_id;
+    return 0;
+}
+
+/**
+ * @brief 按状态转移表类型选择不完全AC自动机主循环实例，参数同ac_search_part（不含type）
+ * ac_create_typed接受的每种类型都以常量实例化，主循环内不再按类型分支
+ */
+SM_INLINE int ac_search_part_dispatch(const AC *ac, const char *s, int slen, int *state, int64_t base,
+                                      match_callback_t cb, void *ctx) {
+    switch (sttable_inst_type(ac->trie->sttbl)) {
+        case STTABLE_TYPE_LIST:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_LIST, cb, ctx);
+        case STTABLE_TYPE_ARRAY:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_ARRAY, cb, ctx);
+        case STTABLE_TYPE_ARRAY16:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_ARRAY16, cb, ctx);
+        case STTABLE_TYPE_HASHT:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_HASHT, cb, ctx);
+        case STTABLE_TYPE_DBARR:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_DBARR, cb, ctx);
+        case STTABLE_TYPE_OHASH:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_OHASH, cb, ctx);
+        case STTABLE_TYPE_BITMAP:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_BITMAP, cb, ctx);
+        case STTABLE_TYPE_HYBRID:
+            return ac_search_part(ac, s, slen, state, base, STTABLE_TYPE_HYBRID, cb, ctx);
+        default:
+            return 0;
+    }
 }
 
 void ac_search(const AC *ac, const char *s, int slen, match_result_t *result) {
+    int state = 0;
+    if (ac->level == AC_LEVEL_FULL) {
+        ac_search_full_dispatch(ac, s, slen, &state, 0, match_result_callback, result);
+    } else {
+        ac_search_part_dispatch(ac, s, slen, &state, 0, match_result_callback, result);
+    }
+}
+
+int ac_search_cb(const AC *ac, const char *s, int slen, match_callback_t cb, void *ctx) {
+    int state = 0;
+    if (ac->level == AC_LEVEL_FULL) {
+        return ac_search_full_dispatch(ac, s, slen, &state, 0, cb, ctx);
+    } else {
+        return ac_search_part_dispatch(ac, s, slen, &state, 0, cb, ctx);
+    }
+}
+
+/**
+ * @brief 由状态经字符c转移，不完全自动机沿失配状态回退，回退到初始状态之外时回到初始状态
+ * 
+ * @param ac       自动机指针
+ * @param state_id 当前状态
+ * @param c        字符
+ * @param level    自动机等级，以常量实例化
+ * @param type     状态转移表实例类型，以常量实例化
+ * @return int 目标状态
+ */
+SM_INLINE int ac_step(const AC *ac, int state_id, char c, ACLevel level, STTableType type) {
+    const sttable_t *tbl = ac->trie->sttbl;
+    if (level == AC_LEVEL_FULL) {
+        return sttable_get_typed(tbl, type, state_id, c);
+    }
+    int target = 0;
+    while ((target = sttable_get_typed(tbl, type, state_id, c)) == -1) {
+        if ((state_id = ac->next[state_id]) == -1) {
+            return 0;
+        }
+    }
+    return target;
+}
+
+/**
+ * @brief 状态的最长输出，即以当前位置结尾、起点最左的匹配
+ * 
+ * @param ac       自动机指针
+ * @param state_id 状态
+ * @param level    自动机等级，以常量实例化
+ * @param len      写入模式串长度
+ * @param pid      写入模式串id
+ * @return int 1:有输出 0:没有输出
+ */
+SM_INLINE int ac_longest_output(const AC *ac, int state_id, ACLevel level, int *len, int *pid) {
+    if (level == AC_LEVEL_FULL) {
+        if (state_id < ac->out_min) {
+            return 0;
+        }
+        // 输出列表中自身的模式串在前，后缀链按长度递减
+        const ac_output_t *out = ac->outs + ac->outl[state_id - ac->out_min].off;
+        *len = out->len;
+        *pid = out->pid;
+        return 1;
+    }
+    int id = ac->trie->states[state_id].is_fin ? state_id : ac->suff[state_id];
+    if (id == -1) {
+        return 0;
+    }
+    *len = ac->trie->states[id].depth;
+    *pid = ac->trie->states[id].pid;
+    return 1;
+}
+
+/**
+ * @brief 不重叠匹配主循环
+ * 以位置i结尾的匹配中只有最长输出可能成为最左匹配。之后的匹配起点不早于i + 1 - 当前状态深度，
+ * 候选起点早于该位置或扫描到结尾时即为最终结果，输出后从候选结尾由初始状态重新扫描
+ * 
+ * @param ac    自动机指针
+ * @param s     字符串
+ * @param slen  字符串长度
+ * @param kind  报告方式，MATCH_KIND_LEFTMOST_FIRST或MATCH_KIND_LEFTMOST_LONGEST
+ * @param level 自动机等级，以常量实例化
+ * @param type  状态转移表实例类型，以常量实例化
+ * @param cb    回调函数
+ * @param ctx   回调上下文
+ * @return int  0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int ac_search_leftmost(const AC *ac, const char *s, int slen, MatchKind kind, ACLevel level,
+                                 STTableType type, match_callback_t cb, void *ctx) {
+    const TrieState *states = ac->trie->states;
+    int start = -1, clen = 0, cpid = 0; // 候选匹配，start为-1表示没有
+    for (int i = 0, state_id = 0, len = 0, pid = 0; i < slen || start != -1; i++) {
+        if (i < slen) {
+            state_id = ac_step(ac, state_id, s[i], level, type);
+        }
+        // 扫描到结尾，或之后的匹配起点都晚于候选起点时，候选即为最终结果
+        if (start != -1 && (i == slen || start < i + 1 - states[state_id].depth)) {
+            if (match_emit(cb, ctx, clen, start, cpid) != 0) {
+                return -1;
+            }
+            // 循环递增后从候选结尾继续
+            i = start + clen - 1;
+            state_id = 0;
+            start = -1;
+            continue;
+        }
+        if (ac_longest_output(ac, state_id, level, &len, &pid)) {
+            // 起点相同时后到的匹配更长，最长方式直接替换，优先方式比较模式串id
+            int pos = i - len + 1;
+            if (start == -1 || pos < start || (pos == start && (kind == MATCH_KIND_LEFTMOST_LONGEST || pid < cpid))) {
+                start = pos;
+                clen = len;
+                cpid = pid;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 按自动机等级和状态转移表实例类型选择不重叠匹配主循环实例，参数同ac_search_leftmost
+ */
+SM_INLINE int ac_search_leftmost_dispatch(const AC *ac, const char *s, int slen, MatchKind kind,
+                                          match_callback_t cb, void *ctx) {
+    STTableType type = sttable_inst_type(ac->trie->sttbl);
+    if (ac->level == AC_LEVEL_FULL) {
+        switch (type) {
+            case AC_FULL_STTABLE_TYPE16:
+                return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_FULL, AC_FULL_STTABLE_TYPE16, cb, ctx);
+            case STTABLE_TYPE_HYBRID_DIFF:
+                return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_FULL, STTABLE_TYPE_HYBRID_DIFF, cb, ctx);
+            default:
+                return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_FULL, AC_FULL_STTABLE_TYPE, cb, ctx);
+        }
+    }
+    switch (type) {
+        case STTABLE_TYPE_LIST:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_LIST, cb, ctx);
+        case STTABLE_TYPE_ARRAY:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_ARRAY, cb, ctx);
+        case STTABLE_TYPE_ARRAY16:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_ARRAY16, cb, ctx);
+        case STTABLE_TYPE_HASHT:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_HASHT, cb, ctx);
+        case STTABLE_TYPE_DBARR:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_DBARR, cb, ctx);
+        case STTABLE_TYPE_OHASH:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_OHASH, cb, ctx);
+        case STTABLE_TYPE_BITMAP:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_BITMAP, cb, ctx);
+        case STTABLE_TYPE_HYBRID:
+            return ac_search_leftmost(ac, s, slen, kind, AC_LEVEL_PART, STTABLE_TYPE_HYBRID, cb, ctx);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 按报告方式选择主循环，参数同ac_search_kind_cb
+ */
+SM_INLINE int ac_search_kind_core(const AC *ac, const char *s, int slen, MatchKind kind,
+                                  match_callback_t cb, void *ctx) {
+    int state = 0;
+    if (kind != MATCH_KIND_STANDARD) {
+        return ac_search_leftmost_dispatch(ac, s, slen, kind, cb, ctx);
+    }
+    if (ac->level == AC_LEVEL_FULL) {
+        return ac_search_full_dispatch(ac, s, slen, &state, 0, cb, ctx);
+    }
+    return ac_search_part_dispatch(ac, s, slen, &state, 0, cb, ctx);
+}
+
+void ac_search_kind(const AC *ac, const char *s, int slen, MatchKind kind, match_result_t *result) {
+    ac_search_kind_core(ac, s, slen, kind, match_result_callback, result);
+}
+
+int ac_search_kind_cb(const AC *ac, const char *s, int slen, MatchKind kind, match_callback_t cb, void *ctx) {
+    return ac_search_kind_core(ac, s, slen, kind, cb, ctx);
+}
+
+ac_stream_t* ac_stream_create(const AC *ac) {
+    ac_stream_t *stream = (ac_stream_t *)malloc(sizeof(ac_stream_t));
+    if (stream == NULL) {
+        return NULL;
+    }
+    stream->ac = ac;
+    ac_stream_reset(stream);
+    return stream;
+}
+
+void ac_stream_destroy(ac_stream_t *stream) {
+    free(stream);
+}
+
+void ac_stream_reset(ac_stream_t *stream) {
+    stream->state = 0;
+    stream->offset = 0;
+}
+
+int ac_stream_search_cb(ac_stream_t *stream, const char *s, int slen, match_callback_t cb, void *ctx) {
+    const AC *ac = stream->ac;
+    int ret = 0;
     if (ac->level == AC_LEVEL_FULL) {
-        ac_search_full(ac, s, slen, result);
+        ret = ac_search_full_dispatch(ac, s, slen, &stream->state, stream->offset, cb, ctx);
     } else {
-        ac_search_part(ac, s, slen, result);
+        ret = ac_search_part_dispatch(ac, s, slen, &stream->state, stream->offset, cb, ctx);
+    }
+    if (ret == 0) {
+        stream->offset += slen;
+    }
+    return ret;
+}
+
+void ac_stream_search(ac_stream_t *stream, const char *s, int slen, match_result_t *result) {
+    ac_stream_search_cb(stream, s, slen, match_result_callback, result);
+}
+
+/**
+ * @brief 批量匹配中正在扫描的文档
+ */
+typedef struct {
+    const char *s; // 文档内容
+    int len;       // 文档长度
+    int i;         // 下一个待扫描字符
+    int state;     // 当前自动机状态
+    int doc;       // 文档下标
+} ac_lane_t;
+
+/**
+ * @brief 为扫描通道装入下一个非空文档
+ * 
+ * @param lane  扫描通道
+ * @param docs  文档数组
+ * @param ndocs 文档数
+ * @param next  下一个待装入的文档下标
+ * @return int  1:装入成功 0:没有剩余文档
+ */
+static inline int ac_lane_fill(ac_lane_t *lane, const match_doc_t *docs, int ndocs, int *next) {
+    while (*next < ndocs && docs[*next].len <= 0) {
+        ++*next;
+    }
+    if (*next >= ndocs) {
+        return 0;
+    }
+    lane->doc = *next;
+    lane->s = docs[*next].s;
+    lane->len = docs[*next].len;
+    lane->i = 0;
+    lane->state = 0;
+    ++*next;
+    return 1;
+}
+
+/**
+ * @brief 输出完全自动机状态的输出列表
+ * 
+ * @param ac       自动机指针
+ * @param state_id 当前状态
+ * @param end      匹配结束位置（不含）
+ * @param doc      文档下标
+ * @param cb       回调函数
+ * @param ctx      回调上下文
+ * @return int     0:继续 -1:被回调终止
+ */
+SM_INLINE int ac_batch_emit(const AC *ac, int state_id, int end, int doc, match_batch_callback_t cb, void *ctx) {
+    if (state_id < ac->out_min) {
+        return 0;
+    }
+    match_item_t item;
+    const ac_outlist_t *list = &ac->outl[state_id - ac->out_min];
+    const ac_output_t *out = ac->outs + list->off;
+    for (int k = 0; k < list->num; k++) {
+        item.pos = end - out[k].len;
+        item.len = out[k].len;
+        item.id = out[k].pid;
+        if (cb(doc, &item, ctx) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 逐个文档扫描时的回调上下文
+ */
+typedef struct {
+    match_batch_callback_t cb; // 用户回调函数
+    void *ctx;                 // 用户回调上下文
+    int doc;                   // 当前文档下标
+} ac_batch_doc_t;
+
+static inline int ac_batch_doc_callback(const match_item_t *item, void *ctx) {
+    ac_batch_doc_t *wrap = (ac_batch_doc_t *)ctx;
+    return wrap->cb(wrap->doc, item, wrap->ctx);
+}
+
+/**
+ * @brief 完全自动机批量匹配，每轮让每个通道前进一个字符，文档扫描完成后通道立即装入下一个文档
+ * 
+ * @param ac    自动机指针
+ * @param docs  文档数组
+ * @param ndocs 文档数
+ * @param type  状态转移表实例类型，以常量实例化
+ * @param cb    回调函数
+ * @param ctx   回调上下文
+ * @return int  0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int ac_batch_full(const AC *ac, const match_doc_t *docs, int ndocs, STTableType type,
+                            match_batch_callback_t cb, void *ctx) {
+    ac_lane_t lanes[AC_BATCH_LANES];
+    int next = 0;
+    int active = 0;
+    while (active < AC_BATCH_LANES && ac_lane_fill(&lanes[active], docs, ndocs, &next)) {
+        ++active;
+    }
+    const sttable_t *tbl = ac->trie->sttbl;
+    while (active > 0) {
+        for (int l = 0; l < active;) {
+            ac_lane_t *lane = &lanes[l];
+            lane->state = sttable_get_typed(tbl, type, lane->state, lane->s[lane->i++]);
+            if (ac_batch_emit(ac, lane->state, lane->i, lane->doc, cb, ctx) != 0) {
+                return -1;
+            }
+            if (lane->i >= lane->len && !ac_lane_fill(lane, docs, ndocs, &next)) {
+                lanes[l] = lanes[--active];
+                continue;
+            }
+            ++l;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief 批量匹配主循环
+ * 完全自动机交错扫描多个文档，按状态转移表实例类型选择实例；
+ * 不完全自动机每个字符的失配跳转次数不定，交错扫描的分支开销大于访存收益，逐个文档扫描
+ */
+SM_INLINE int ac_batch_core(const AC *ac, const match_doc_t *docs, int ndocs, match_batch_callback_t cb, void *ctx) {
+    if (ac->level != AC_LEVEL_FULL) {
+        ac_batch_doc_t wrap = {cb, ctx, 0};
+        for (int i = 0; i < ndocs; i++) {
+            int state = 0;
+            wrap.doc = i;
+            if (ac_search_part_dispatch(ac, docs[i].s, docs[i].len, &state, 0, ac_batch_doc_callback, &wrap) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    switch (sttable_inst_type(ac->trie->sttbl)) {
+        case AC_FULL_STTABLE_TYPE16:
+            return ac_batch_full(ac, docs, ndocs, AC_FULL_STTABLE_TYPE16, cb, ctx);
+        case STTABLE_TYPE_HYBRID_DIFF:
+            return ac_batch_full(ac, docs, ndocs, STTABLE_TYPE_HYBRID_DIFF, cb, ctx);
+        default:
+            return ac_batch_full(ac, docs, ndocs, AC_FULL_STTABLE_TYPE, cb, ctx);
     }
 }
+
+/**
+ * @brief 批量匹配结果回调，按文档下标写入对应的匹配结果
+ * 与match_result_callback相同，固定容量的结果满后只计数，不影响其他文档
+ */
+static inline int ac_batch_result_callback(int doc, const match_item_t *item, void *ctx) {
+    match_result_t **results = (match_result_t **)ctx;
+    return match_result_callback(item, results[doc]);
+}
+
+void ac_search_batch(const AC *ac, const match_doc_t *docs, int ndocs, match_result_t *results[]) {
+    ac_batch_core(ac, docs, ndocs, ac_batch_result_callback, results);
+}
+
+int ac_search_batch_cb(const AC *ac, const match_doc_t *docs, int ndocs, match_batch_callback_t cb, void *ctx) {
+    return ac_batch_core(ac, docs, ndocs, cb, ctx);
+}
+
+/**
+ * @brief 完全自动机统计匹配数，参数同ac_count_core
+ * 
+ * @param type 状态转移表实例类型，以常量实例化
+ */
+SM_INLINE int64_t ac_count_full(const AC *ac, const char *s, int slen, int first, STTableType type) {
+    int64_t count = 0;
+    const int out_min = ac->out_min;
+    const sttable_t *tbl = ac->trie->sttbl;
+    for (int i = 0, state_id = 0; i < slen; i++) {
+        state_id = sttable_get_typed(tbl, type, state_id, s[i]);
+        if (state_id >= out_min) {
+            if (first) {
+                return 1;
+            }
+            count += ac->outl[state_id - out_min].num;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 不完全自动机统计匹配数，参数同ac_count_core
+ * 
+ * @param type 状态转移表实例类型
+ */
+SM_INLINE int64_t ac_count_part(const AC *ac, const char *s, int slen, int first, STTableType type) {
+    int64_t count = 0;
+    const int *outn = ac->outn;
+    const sttable_t *tbl = ac->trie->sttbl;
+    for (int i = 0, state_id = 0, target = 0; i < slen;) {
+        if (state_id == -1) {
+            ++i;
+            state_id = 0;
+        } else if ((target = sttable_get_typed(tbl, type, state_id, s[i])) != -1) {
+            ++i;
+            state_id = target;
+            count += outn[target];
+            if (first && count != 0) {
+                return count;
+            }
+        } else {
+            state_id = ac->next[state_id];
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 统计匹配数或判断是否存在匹配
+ * 只查询状态输出数，不遍历后缀链，也不生成匹配项
+ * 
+ * @param ac    自动机指针
+ * @param s     字符串
+ * @param slen  字符串长度
+ * @param first 1:遇到第一个匹配即返回
+ * @return int64_t 匹配数
+ */
+SM_INLINE int64_t ac_count_core(const AC *ac, const char *s, int slen, int first) {
+    STTableType type = sttable_inst_type(ac->trie->sttbl);
+    if (ac->level == AC_LEVEL_FULL) {
+        switch (type) {
+            case AC_FULL_STTABLE_TYPE16:
+                return ac_count_full(ac, s, slen, first, AC_FULL_STTABLE_TYPE16);
+            case STTABLE_TYPE_HYBRID_DIFF:
+                return ac_count_full(ac, s, slen, first, STTABLE_TYPE_HYBRID_DIFF);
+            default:
+                return ac_count_full(ac, s, slen, first, AC_FULL_STTABLE_TYPE);
+        }
+    }
+    switch (type) {
+        case STTABLE_TYPE_LIST:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_LIST);
+        case STTABLE_TYPE_ARRAY:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_ARRAY);
+        case STTABLE_TYPE_ARRAY16:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_ARRAY16);
+        case STTABLE_TYPE_HASHT:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_HASHT);
+        case STTABLE_TYPE_DBARR:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_DBARR);
+        case STTABLE_TYPE_OHASH:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_OHASH);
+        case STTABLE_TYPE_BITMAP:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_BITMAP);
+        case STTABLE_TYPE_HYBRID:
+            return ac_count_part(ac, s, slen, first, STTABLE_TYPE_HYBRID);
+        default:
+            return 0;
+    }
+}
+
+int64_t ac_count(const AC *ac, const char *s, int slen) {
+    return ac_count_core(ac, s, slen, 0);
+}
+
+int ac_contains(const AC *ac, const char *s, int slen) {
+    return ac_count_core(ac, s, slen, 1) != 0;
+}
@@ -1,9 +1,10 @@
+#include <stdlib.h>
 #include "xssm.h"
 
 static void pre_bmbc(int bmbc[], const char* p, int plen) {
 	memset(bmbc, -1, CHARSET_SIZE * 4);
 	for (int i = 0; i < plen - 1; i++) {
-		bmbc[p[i]] = i;
+		bmbc[(unsigned char)p[i]] = i;
 	}
 }
 
@@ -38,25 +39,61 @@ static void pre_bmgs(int bmgs[], const char* p, int plen) {
 	}
 }
 
-void bm_search(const char* s, const char* p, int slen, int plen) {
-	int bmbc[CHARSET_SIZE];
-	int bmgs[plen];
-	pre_bmbc(bmbc, p, plen);
-	pre_bmgs(bmgs, p, plen);
+bm_pattern_t* bm_pattern_create(const char *p, int plen) {
+	if (plen <= 0) {
+		return NULL;
+	}
+	bm_pattern_t *bm = (bm_pattern_t *)malloc(sizeof(bm_pattern_t));
+	bm->plen = plen;
+	bm->p = (char *)malloc(plen);
+	memcpy(bm->p, p, plen);
+	bm->bmgs = (int *)malloc(sizeof(int) * plen);
+	pre_bmbc(bm->bmbc, bm->p, plen);
+	pre_bmgs(bm->bmgs, bm->p, plen);
+	return bm;
+}
+
+void bm_pattern_destroy(bm_pattern_t *bm) {
+	if (bm != NULL) {
+		free(bm->p);
+		free(bm->bmgs);
+		free(bm);
+	}
+}
+
+void bm_pattern_search(const bm_pattern_t *bm, const char *s, int slen, match_result_t *result) {
+	const char *p = bm->p;
+	const int *bmbc = bm->bmbc;
+	const int *bmgs = bm->bmgs;
+	int plen = bm->plen;
 	int pos = 0; // 窗口位置
 	int i = 0;   // 窗口内字符位置
 	int shift;   // 窗口最大安全移动距离
 	while (pos <= slen - plen) {
 		for (i = plen - 1; i >= 0 && s[pos + i] == p[i]; i--);
 		if (i == -1) {
-			printf("%d ", pos);
+			if (match_result_emit(result, plen, pos, 0) != 0) {
+				return;
+			}
 			shift = bmgs[0];
 		} else {
-			shift = i - bmbc[s[pos + i]];
+			shift = i - bmbc[(unsigned char)s[pos + i]];
 			if (shift < bmgs[i]) {
 				shift = bmgs[i];
 			}
 		}
 		pos += shift;
 	}
+}
+
+void bm_search(const char* s, const char* p, int slen, int plen) {
+	bm_pattern_t *bm = bm_pattern_create(p, plen);
+	if (bm == NULL) {
+		return;
+	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	bm_pattern_search(bm, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	bm_pattern_destroy(bm);
 }
\ No newline at end of file
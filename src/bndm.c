@@ -29,9 +29,16 @@ void bndm_nfa_destroy(BndmNFA *nfa) {
 }
 
 int bndm_nfa_insert(BndmNFA *nfa, const char *p, int plen) {
+	int id = nfa->id_num++;
 	if (plen > BNDM_MAX_PATTERN_LEN || nfa->pnum >= BNDM_MAX_PATTERN_NUM) {
 		return -1;
 	}
+	// 重复的模式串只保留第一次插入的id
+	for (int i = 0; i < nfa->pnum; i++) {
+		if (nfa->patterns[i].len == plen && memcmp(nfa->patterns[i].str, p, plen) == 0) {
+			return 0;
+		}
+	}
 	int min_len = nfa->min_len;
 	if (min_len > plen) {
 		min_len = plen;
@@ -41,6 +48,7 @@ int bndm_nfa_insert(BndmNFA *nfa, const char *p, int plen) {
 	}
 	nfa->min_len = min_len;
 	nfa->patterns[nfa->pnum].len = plen;
+	nfa->patterns[nfa->pnum].id = id;
 	strncpy(nfa->patterns[nfa->pnum].str, p, BNDM_MAX_PATTERN_LEN);
 	++nfa->pnum;
 	return 0;
@@ -55,12 +63,12 @@ void bndm_nfa_build(BndmNFA *nfa) {
 		bit_array_set(&nfa->fin_mask, pos + nfa->min_len - 1);
 		for (int j = 0; j < nfa->min_len; j++) {
 			bit_array_set(&nfa->int_mask, pos + j);
-			bit_array_set(&nfa->mask[pattern->str[pattern->len - 1 - j]], pos + j);
+			bit_array_set(&nfa->mask[(unsigned char)pattern->str[pattern->len - 1 - j]], pos + j);
 		}
 	}
 }
 
-void bndm_nfa_search(const BndmNFA *nfa, const char *s, int slen, match_result_t *result) {
+SM_INLINE int bndm_nfa_search_core(const BndmNFA *nfa, const char *s, int slen, match_callback_t cb, void *ctx) {
 	bit_array_t status;
 	bit_array_t fin_status;
 	bit_array_reset(&status);
@@ -69,7 +77,7 @@ void bndm_nfa_search(const BndmNFA *nfa, const char *s, int slen, match_result_t
 		shift = nfa->min_len;
 		bit_array_copy(&status, &nfa->int_mask);
 		for (int j = nfa->min_len - 1; j >= 0; j--) {
-			bit_array_and(&status, &nfa->mask[s[i + j]]);
+			bit_array_and(&status, &nfa->mask[(unsigned char)s[i + j]]);
 			if (bit_array_empty(&status)) {
 				break;
 			}
@@ -84,7 +92,9 @@ void bndm_nfa_search(const BndmNFA *nfa, const char *s, int slen, match_result_t
 						const _bndm_pattern_t *pattern = &nfa->patterns[pos / nfa->min_len];
 						int start_pos = i + nfa->min_len - pattern->len;
 						if (start_pos >= 0 && (memcmp(pattern->str, s + start_pos, pattern->len - nfa->min_len) == 0)) {
-							match_result_append(result, pattern->len, start_pos);
+							if (match_emit(cb, ctx, pattern->len, start_pos, pattern->id) != 0) {
+								return -1;
+							}
 						}
 					}
 				}
@@ -92,43 +102,55 @@ void bndm_nfa_search(const BndmNFA *nfa, const char *s, int slen, match_result_t
 			bit_array_lshift(&status);
 		}
 	}
+	return 0;
+}
+
+void bndm_nfa_search(const BndmNFA *nfa, const char *s, int slen, match_result_t *result) {
+	bndm_nfa_search_core(nfa, s, slen, match_result_callback, result);
+}
+
+int bndm_nfa_search_cb(const BndmNFA *nfa, const char *s, int slen, match_callback_t cb, void *ctx) {
+	return bndm_nfa_search_core(nfa, s, slen, cb, ctx);
 }
 
-/**
- * @brief 生成NFA位运算掩码表
- * 
- * @param p    模式串
- * @param plen 模式串长度
- * @param mask 掩码表
- */
-static void build_mask(const char *p, int plen, int mask[]) {
-	int i,j;
-	memset(mask, 0, CHARSET_SIZE * sizeof(int));
-	for (i = plen - 1, j = 1; i >= 0; i--) {
-		mask[p[i]] |= j;
-		j = j << 1;
+bndm_pattern_t* bndm_pattern_create(const char *p, int plen) {
+	if (plen <= 0 || plen > 64) {
+		return NULL;
 	}
+	bndm_pattern_t *bndm = (bndm_pattern_t *)malloc(sizeof(bndm_pattern_t));
+	bndm->plen = plen;
+	memset(bndm->mask, 0, sizeof(bndm->mask));
+	for (int i = plen - 1, j = 0; i >= 0; i--, j++) {
+		bndm->mask[(unsigned char)p[i]] |= (uint64_t)1 << j;
+	}
+	return bndm;
 }
 
-void bndm_search(const char* s, const char* p, int slen, int plen) {
-	int mask[CHARSET_SIZE]; // 字符掩码
-	build_mask(p, plen, mask);
-	int pos = 0;    // 窗口位置
-	int target = 1 << (plen - 1);
+void bndm_pattern_destroy(bndm_pattern_t *bndm) {
+	free(bndm);
+}
+
+void bndm_pattern_search(const bndm_pattern_t *bndm, const char *s, int slen, match_result_t *result) {
+	int plen = bndm->plen;
+	int pos = 0; // 窗口位置
+	uint64_t target = (uint64_t)1 << (plen - 1);
+	uint64_t init = target | (target - 1);
 	while (pos <= slen - plen) {
 		int j = plen - 1; // 窗口内字符位置
 		int shift = plen;
-		int status = (1 << plen) - 1;
+		uint64_t status = init;
 		// 逆向扫描当前窗口
-		while (status != 0) {
+		while (status != 0 && j >= 0) {
 			// s[pos+j...pos+plen-1]在模式串中是否出现
-			status &= mask[s[pos + j]];
+			status &= bndm->mask[(unsigned char)s[pos + j]];
 			if (status & target) {
 				// 模式串前缀与已匹配串后缀一致
 				if (j > 0) {
 					shift = j;
 				} else {
-					printf("%d ", pos);
+					if (match_result_emit(result, plen, pos, 0) != 0) {
+						return;
+					}
 				}
 			}
 			status <<= 1;
@@ -137,3 +159,15 @@ void bndm_search(const char* s, const char* p, int slen, int plen) {
 		pos = pos + shift;
 	}
 }
+
+void bndm_search(const char* s, const char* p, int slen, int plen) {
+	bndm_pattern_t *bndm = bndm_pattern_create(p, plen);
+	if (bndm == NULL) {
+		return;
+	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	bndm_pattern_search(bndm, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	bndm_pattern_destroy(bndm);
+}
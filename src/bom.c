@@ -1,5 +1,10 @@
+#include <stdlib.h>
 #include "xssm.h"
 #include "trie.h"
+#include "internal/sttable_get.h"
+
+// oracle的状态转移稀疏，使用开放寻址散列表，匹配主循环以该类型实例化
+#define BOM_STTABLE_TYPE STTABLE_TYPE_OHASH
 
 static Trie* build_oracle(const char *p, int plen) {
     char reverse[plen + 1];
@@ -7,8 +12,8 @@ static Trie* build_oracle(const char *p, int plen) {
         reverse[i] = p[plen - 1 - i];
     }
     reverse[plen] = '\0';
-    const char* patterns[] = {reverse};
-    Trie* trie = trie_create_ex(patterns, 1, STTABLE_TYPE_HASHT);
+    Trie* trie = trie_create(BOM_STTABLE_TYPE);
+    trie_insert(trie, reverse, plen);
     int supply[plen + 1]; // 供给数组，对应状态数
     memset(supply, 0, sizeof(supply));
     supply[0] = -1;
@@ -28,19 +33,52 @@ static Trie* build_oracle(const char *p, int plen) {
     return trie;
 }
 
-void bom_search(const char *s, const char *p, int slen, int plen) {
-    Trie* trie = build_oracle(p, plen);
+bom_pattern_t* bom_pattern_create(const char *p, int plen) {
+    if (plen <= 0) {
+        return NULL;
+    }
+    bom_pattern_t *bom = (bom_pattern_t *)malloc(sizeof(bom_pattern_t));
+    bom->plen = plen;
+    bom->trie = build_oracle(p, plen);
+    return bom;
+}
+
+void bom_pattern_destroy(bom_pattern_t *bom) {
+    if (bom != NULL) {
+        trie_destroy(bom->trie);
+        free(bom);
+    }
+}
+
+void bom_pattern_search(const bom_pattern_t *bom, const char *s, int slen, match_result_t *result) {
+    const Trie *trie = bom->trie;
+    const sttable_t *tbl = trie->sttbl;
+    int plen = bom->plen;
     int i = 0; // 窗口位置
     while (i <= slen - plen) {
         int state_id = 0;
         int j = plen - 1;
-        while ((state_id = trie_get_trans(trie, state_id, s[i + j])) != -1) {
+        while ((state_id = sttable_get_typed(tbl, BOM_STTABLE_TYPE, state_id, s[i + j])) != -1) {
             if (j == 0) {
-                printf("%d ", i);
+                if (match_result_emit(result, plen, i, 0) != 0) {
+                    return;
+                }
                 break;
             }
             j--;
         }
         i = i + j + 1;
     }
+}
+
+void bom_search(const char *s, const char *p, int slen, int plen) {
+    bom_pattern_t *bom = bom_pattern_create(p, plen);
+    if (bom == NULL) {
+        return;
+    }
+    match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+    bom_pattern_search(bom, s, slen, result);
+    match_result_print(result);
+    match_result_destroy(result);
+    bom_pattern_destroy(bom);
 }
\ No newline at end of file
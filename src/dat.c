@@ -1,15 +1,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include "dat.h"
+#include "internal/dbfree.h"
 
 DATrie* dat_create() {
     DATrie *dat = (DATrie *)malloc(sizeof(DATrie));
     dat->cap = DAT_NODE_DEFAULT_NUM;
+    dat->id_num = 0;
+    dat->max_len = 0;
     dat->nodes = (dat_node_t *)calloc(dat->cap, sizeof(dat_node_t));
     memset(dat->nodes, 0, dat->cap * sizeof(dat_node_t));
     dat->tail.len = DAT_TAIL_DEFAULT_LEN;
     dat->tail.pos = 1;
     dat->tail.str = (char *)malloc(dat->tail.len);
+    dat->image = NULL;
+    // 0号单元不使用，1号单元为根节点
+    dbfree_init(&dat->free, dat->cap);
+    dbfree_remove(&dat->free, 0);
+    dbfree_remove(&dat->free, 1);
     return dat;
 }
 
@@ -23,54 +31,176 @@ DATrie* dat_create_ex(const char **patterns, int pnum) {
 
 void dat_destroy(DATrie *dat) {
     if (dat != NULL) {
-        free(dat->nodes);
-        free(dat->tail.str);
+        if (dat->image == NULL) {
+            free(dat->nodes);
+            free(dat->tail.str);
+        }
+        dbfree_destroy(&dat->free);
+        sm_image_close(dat->image);
+        free(dat);
     }
 }
 
+/**
+ * @brief 双数组trie树在映像中的记录
+ */
+typedef struct {
+    int32_t cap;     // 节点数
+    int32_t id_num;  // 已分配的模式串id数
+    int32_t max_len; // 最大模式串长度
+    int32_t pos;     // 后缀已使用的长度
+    int32_t nodes;   // 节点数组所在的段
+    int32_t tail;    // 后缀所在的段
+} dat_image_t;
+
+int dat_save(const DATrie *dat, const char *path) {
+    sm_image_writer_t w;
+    dat_image_t meta;
+    sm_image_writer_init(&w, SM_IMAGE_DAT);
+    sm_image_add(&w, &meta, sizeof(meta));
+    meta.cap = dat->cap;
+    meta.id_num = dat->id_num;
+    meta.max_len = dat->max_len;
+    meta.pos = dat->tail.pos;
+    meta.nodes = sm_image_add(&w, dat->nodes, sizeof(dat_node_t) * dat->cap);
+    meta.tail = sm_image_add(&w, dat->tail.str, dat->tail.pos);
+    return sm_image_write(&w, path);
+}
+
+DATrie* dat_load(const char *path, int verify) {
+    sm_image_t *img = sm_image_open(path, SM_IMAGE_DAT, verify);
+    if (img == NULL) {
+        return NULL;
+    }
+    const dat_image_t *meta = (const dat_image_t *)sm_image_get(img, 0, sizeof(dat_image_t));
+    const dat_node_t *nodes = NULL;
+    const char *str = NULL;
+    if (meta != NULL && meta->cap > 1 && meta->pos > 0) {
+        nodes = (const dat_node_t *)sm_image_get(img, meta->nodes, sizeof(dat_node_t) * (uint64_t)meta->cap);
+        str = (const char *)sm_image_get(img, meta->tail, meta->pos);
+    }
+    DATrie *dat = nodes != NULL && str != NULL ? (DATrie *)calloc(1, sizeof(DATrie)) : NULL;
+    if (dat == NULL) {
+        sm_image_close(img);
+        return NULL;
+    }
+    // 空闲单元链表只用于插入，加载的树不分配
+    dat->cap = meta->cap;
+    dat->id_num = meta->id_num;
+    dat->max_len = meta->max_len;
+    dat->nodes = (dat_node_t *)nodes;
+    dat->tail.len = meta->pos;
+    dat->tail.pos = meta->pos;
+    dat->tail.str = (char *)str;
+    dat->image = img;
+    return dat;
+}
+
 /**
  * @brief 插入分裂出来的字符串后缀
  * 
  * @param tail 后缀存储对象指针
  * @param s    字符串后缀
+ * @param id   模式串id
  * @return int 0:成功 -1:失败（内存不足）
  */
-static int dat_tail_insert(dat_tail_t *tail, const char *s) {
+static int dat_tail_insert(dat_tail_t *tail, const char *s, int id) {
     int len = strlen(s);
-    if (tail->pos + len > tail->len) {
-        char *str = (char *)realloc(tail->str, tail->len + DAT_TAIL_INCREMT_LEN);
+    int need = tail->pos + len + 1 + sizeof(int);
+    if (need > tail->len) {
+        int size = tail->len;
+        while (size < need) {
+            size += DAT_TAIL_INCREMT_LEN;
+        }
+        char *str = (char *)realloc(tail->str, size);
         if (str == NULL) {
             return -1;
         }
-        memset(str + tail->len, 0, DAT_TAIL_INCREMT_LEN);
-        tail->len += DAT_TAIL_INCREMT_LEN;
+        memset(str + tail->len, 0, size - tail->len);
+        tail->len = size;
         tail->str = str;
     }
     for (int i = 0; i < len; i++) {
         tail->str[tail->pos++] = s[i];
     }
     tail->str[tail->pos++] = '\0';
+    memcpy(tail->str + tail->pos, &id, sizeof(int));
+    tail->pos += sizeof(int);
     return 0;
 }
 
+/**
+ * @brief 读取后缀字符串对应的模式串id
+ * 
+ * @param tail 后缀存储对象指针
+ * @param pos  后缀字符串中的任一位置
+ * @return int 模式串id
+ */
+static int dat_tail_id(const dat_tail_t *tail, int pos) {
+    int id = 0;
+    while (tail->str[pos] != '\0') {
+        ++pos;
+    }
+    memcpy(&id, tail->str + pos + 1, sizeof(int));
+    return id;
+}
+
 /**
  * @brief 扩展节点数组
  * 
  * @param dat 双数组trie树指针
  * @return int 0:成功 -1:失败（内存不足）
  */
-static int dat_node_extend(DATrie *dat) {
-    int cap = dat->cap + DAT_NODE_INCREMT_NUM;
+static int dat_node_extend(DATrie *dat, int size) {
+    if (size <= dat->cap) {
+        return 0;
+    }
+    int cap = dat->cap * 2;
+    if (cap < dat->cap + DAT_NODE_INCREMT_NUM) {
+        cap = dat->cap + DAT_NODE_INCREMT_NUM;
+    }
+    while (cap < size) {
+        cap *= 2;
+    }
     dat_node_t *nodes = (dat_node_t *)realloc(dat->nodes, cap * sizeof(dat_node_t));
     if (nodes == NULL) {
         return -1;
     }
-    memset(nodes + dat->cap, 0, DAT_NODE_INCREMT_NUM * sizeof(dat_node_t));
-    dat->cap = cap;
+    memset(nodes + dat->cap, 0, (cap - dat->cap) * sizeof(dat_node_t));
     dat->nodes = nodes;
+    if (dbfree_extend(&dat->free, cap) != 0) {
+        return -1;
+    }
+    dat->cap = cap;
     return 0;
 }
 
+/**
+ * @brief 占用节点
+ * 
+ * @param dat   双数组trie树指针
+ * @param tid   节点
+ * @param base  基数，负数为后缀位置
+ * @param check 来源节点
+ */
+static inline void dat_node_set(DATrie *dat, int tid, int base, int check) {
+    dat->nodes[tid].base = base;
+    dat->nodes[tid].check = check;
+    dbfree_remove(&dat->free, tid);
+}
+
+/**
+ * @brief 释放节点
+ * 
+ * @param dat 双数组trie树指针
+ * @param tid 节点
+ */
+static inline void dat_node_clear(DATrie *dat, int tid) {
+    dat->nodes[tid].base = 0;
+    dat->nodes[tid].check = 0;
+    dbfree_add(&dat->free, tid);
+}
+
 /**
  * @brief 模式串尾部添加结束字符
  * 避免一个模式串是另一个模式串的子串
@@ -108,45 +238,18 @@ static int dat_strcmp(const char *s1, const char *s2) {
 }
 
 /**
- * @brief 找到合适的base值
- * 
- * @param dat  双数组trie树指针
- * @param base 初始base值
- * @param c    转移字符
- * @return int -1:失败（内存不足）0-n:base值
- */
-static int dat_find_base(DATrie *dat, int base, char c) {
-    int nid = base + c;
-    while (nid < dat->cap && dat->nodes[nid].check != 0) {
-        ++nid;
-    }
-    if (nid >= dat->cap) {
-        if (dat_node_extend(dat) != 0) {
-            return -1;
-        }
-    }
-    return nid - c;
-}
-
-/**
- * @brief 找到合适的base值
+ * @brief 找到使全部转移字符都落在空闲节点的base值，并保证节点数组容量
  * 
  * @param dat  双数组trie树指针
- * @param base 初始base值
  * @param str  字符数组
  * @param len  字符数
  * @return int -1:失败（内存不足）0-n:base值
  */
-static int dat_find_base_ex(DATrie *dat, int base, char *str, int len) {
-    int valid_base = -1;
-    while (base != valid_base) {
-        valid_base = base;
-        for (int i = 0; i < len; i++) {
-            base = dat_find_base(dat, base, str[i]);
-            if (base < 0) {
-                return -1;
-            }
-        }
+static int dat_find_base(DATrie *dat, const char *str, int len) {
+    int end = 0;
+    int base = dbfree_find_base(&dat->free, str, len, &end);
+    if (dat_node_extend(dat, end) != 0) {
+        return -1;
     }
     return base;
 }
@@ -158,9 +261,10 @@ static int dat_find_base_ex(DATrie *dat, int base, char *str, int len) {
  * @param dat 双数组trie树指针
  * @param fid 起始节点
  * @param p   待插入的模式串后缀
+ * @param id  模式串id
  * @return int 0:成功 -1:失败（内存不足）
  */
-static int dat_insert_joint(DATrie *dat, int fid, const char *p) {
+static int dat_insert_joint(DATrie *dat, int fid, const char *p, int id) {
     int offset = -dat->nodes[fid].base;
     int dpos = dat_strcmp(dat->tail.str + offset, p);
     if (dpos == 0) {
@@ -169,39 +273,38 @@ static int dat_insert_joint(DATrie *dat, int fid, const char *p) {
     --dpos;
     // 共同子串插入trie树
     for (int i = 0; i < dpos; i++) {
-        int base = dat_find_base(dat, 0, p[i]);
+        int base = dat_find_base(dat, p + i, 1);
         if (base < 0) {
             return -1;
         }
-        int tid = base + p[i];
+        int tid = base + (unsigned char)p[i];
         dat->nodes[fid].base = base;
-        dat->nodes[tid].check = fid;
+        dat_node_set(dat, tid, 0, fid);
         fid = tid;
     }
     // 找到两个分裂点的base值
     char temp[2];
     temp[0] = dat->tail.str[offset + dpos];
     temp[1] = p[dpos];
-    int base = dat_find_base_ex(dat, 0, temp, 2);
+    int base = dat_find_base(dat, temp, 2);
     if (base < 0) {
         return -1;
     }
     dat->nodes[fid].base = base;
     // 设置老模式串分裂点
-    int tid = base + temp[0];
-    dat->nodes[tid].check = fid;
-    dat->nodes[tid].base = -(offset + dpos + 1);
+    dat_node_set(dat, base + (unsigned char)temp[0], -(offset + dpos + 1), fid);
     // 设置新模式串分裂点
-    tid = base + temp[1];
-    dat->nodes[tid].check = fid;
-    dat->nodes[tid].base = -dat->tail.pos;
-    dat_tail_insert(&dat->tail, p + dpos + 1);
+    dat_node_set(dat, base + (unsigned char)temp[1], -dat->tail.pos, fid);
+    dat_tail_insert(&dat->tail, p + dpos + 1, id);
     return 0;
 }
 
 static int dat_find_nodes(DATrie *dat, char *list, int fid) {
     int num = 0;
     int base = dat->nodes[fid].base;
+    if (base < 0) {
+        return 0; // 叶子节点没有子节点
+    }
     int maxid = base + CHARSET_SIZE;
     if (maxid > dat->cap) {
         maxid = dat->cap;
@@ -226,13 +329,12 @@ static int dat_find_nodes(DATrie *dat, char *list, int fid) {
  */
 static void dat_change_base(DATrie *dat, int fid, int old_base, int new_base, char* list, int num) {
     for (int i = 0; i < num; i++) {
-        int old_tid = old_base + list[i];
-        int new_tid = new_base + list[i];
+        int old_tid = old_base + (unsigned char)list[i];
+        int new_tid = new_base + (unsigned char)list[i];
         dat_node_t *old_node = &dat->nodes[old_tid];
-        dat_node_t *new_node = &dat->nodes[new_tid];
-        new_node->base = old_node->base;
-        new_node->check = fid;
-        for (int c = 0; c < CHARSET_SIZE; c++) {
+        dat_node_set(dat, new_tid, old_node->base, fid);
+        // 叶子节点的base指向后缀，没有子节点
+        for (int c = 0; old_node->base >= 0 && c < CHARSET_SIZE; c++) {
             int ttid = old_node->base + c;
             if (ttid >= dat->cap) {
                 break;
@@ -241,8 +343,7 @@ static void dat_change_base(DATrie *dat, int fid, int old_base, int new_base, ch
                 dat->nodes[ttid].check = new_tid;
             }
         }
-        old_node->base = 0;
-        old_node->check = 0;
+        dat_node_clear(dat, old_tid);
     }
     dat->nodes[fid].base = new_base;
 }
@@ -252,38 +353,55 @@ static void dat_change_base(DATrie *dat, int fid, int old_base, int new_base, ch
  * 
  * @param dat 双数组trie树指针
  * @param fid 源节点
- * @param cid 冲突节点
+ * @param cid 冲突节点，0表示冲突单元是根节点
  * @param c   冲突字符
- * @param p 
+ * @param p   待插入的模式串后缀
+ * @param id  模式串id
  * @return int 0:成功 -1:失败
  */
-static int dat_insert_crash(DATrie *dat, int fid, int cid, int c, const char *p) {
+static int dat_insert_crash(DATrie *dat, int fid, int cid, int c, const char *p, int id) {
     // 找出源节点和冲突节点的子节点集合
     char flist[CHARSET_SIZE];
     char clist[CHARSET_SIZE];
     int fnum = dat_find_nodes(dat, flist, fid);
-    int cnum = dat_find_nodes(dat, clist, cid);
+    int cnum = cid > 0 ? dat_find_nodes(dat, clist, cid) : 0;
     flist[fnum++] = c;
-    if (fnum <= cnum) {
+    // 冲突节点是根节点（cid为0）时不能移动，只能移动源节点
+    if (cid == 0 || fnum <= cnum) {
         int old_base = dat->nodes[fid].base;
-        int new_base = dat_find_base_ex(dat, old_base, flist, fnum);
+        int new_base = dat_find_base(dat, flist, fnum);
+        if (new_base < 0) {
+            return -1;
+        }
         dat_change_base(dat, fid, old_base, new_base, flist, fnum - 1);
     } else {
         int old_base = dat->nodes[cid].base;
-        int new_base = dat_find_base_ex(dat, old_base, clist, cnum);
+        int new_base = dat_find_base(dat, clist, cnum);
+        if (new_base < 0) {
+            return -1;
+        }
         dat_change_base(dat, cid, old_base, new_base, clist, cnum);
+        // 源节点是冲突节点的子节点时随之移动
+        for (int i = 0; i < cnum; i++) {
+            if (fid == old_base + (unsigned char)clist[i]) {
+                fid = new_base + (unsigned char)clist[i];
+                break;
+            }
+        }
     }
-    int tid = dat->nodes[fid].base + c;
-    dat->nodes[tid].base = -dat->tail.pos;
-    dat->nodes[tid].check = fid;
-    dat_tail_insert(&dat->tail, p);
+    dat_node_set(dat, dat->nodes[fid].base + (unsigned char)c, -dat->tail.pos, fid);
+    dat_tail_insert(&dat->tail, p, id);
     return 0;
 }
 
 void dat_insert(DATrie *dat, const char *p, int plen) {
-    if (plen <= 0) {
+    int id = dat->id_num++;
+    if (plen <= 0 || dat->image != NULL) {
         return;
     }
+    if (dat->max_len < plen) {
+        dat->max_len = plen;
+    }
     // 模式串添加结尾字符，避免一个模式串是另一个模式串的前缀
     char pattern[plen + 2]; // '#' + '\0'
     p = dat_add_stop_char(pattern, p, ++plen);
@@ -291,42 +409,48 @@ void dat_insert(DATrie *dat, const char *p, int plen) {
     dat_tail_t *tail = &dat->tail;
     int check = 0;
     for (int i = 0, fid = 1, tid = 1; i < plen; i++, fid = tid) {
-        tid = nodes[fid].base + p[i];
+        tid = nodes[fid].base + (unsigned char)p[i];
         if (tid >= dat->cap) {
-            dat_node_extend(dat);
+            if (dat_node_extend(dat, tid + 1) != 0) {
+                return;
+            }
+            nodes = dat->nodes; // 扩展可能改变节点数组地址
         }
+        // 根节点的check为0，不能按check判断空闲
         check = nodes[tid].check;
-        if (check == 0) {
+        if (dbfree_is_free(&dat->free, tid)) {
             // 非冲突失配，插入当前转移并设置分裂点
-            nodes[tid].check = fid;
-            nodes[tid].base = -tail->pos;
-            dat_tail_insert(tail, p + i + 1);
+            dat_node_set(dat, tid, -tail->pos, fid);
+            dat_tail_insert(tail, p + i + 1, id);
             break;
         }
         if (check == fid) {
             if (nodes[tid].base < 0) {
                 // 匹配分裂点，先插入共同前缀，再重新设置各自的分裂点
-                dat_insert_joint(dat, tid, p + i + 1);
+                dat_insert_joint(dat, tid, p + i + 1, id);
                 break;
             }
         }
         if (check != fid) {
             // 冲突型失配，解决冲突后插入当前转移并设置分裂点
-            dat_insert_crash(dat, fid, check, p[i], p + i + 1);
+            dat_insert_crash(dat, fid, check, p[i], p + i + 1, id);
             break;
         }
     }
 }
 
 void dat_delete(DATrie *dat, const char *p, int plen) {
-    if (plen <= 0) {
+    if (plen <= 0 || dat->image != NULL) {
         return;
     }
+    if (dat->max_len < plen) {
+        dat->max_len = plen;
+    }
     // 模式串添加结尾字符，避免一个模式串是另一个模式串的前缀
     char pattern[plen + 2]; // '#' + '\0'
     p = dat_add_stop_char(pattern, p, ++plen);
     for (int i, fid = 1, tid = 1, check = 0, base = 0; i < plen; i++, fid = tid) {
-        tid = dat->nodes[fid].base + p[i];
+        tid = dat->nodes[fid].base + (unsigned char)p[i];
         check = tid < dat->cap ? dat->nodes[tid].check : 0;
         if (check != fid) {
             break;
@@ -335,33 +459,140 @@ void dat_delete(DATrie *dat, const char *p, int plen) {
         if (base < 0) {
             int pos = dat_strcmp(p + i + 1, &dat->tail.str[-base]);
             if (pos == 0) {
-                dat->nodes[tid].base = 0;
-                dat->nodes[tid].check = 0;
+                dat_node_clear(dat, tid);
             }
             break;
         }
     }
 }
 
-void dat_search(const DATrie *dat, const char *s, int slen, match_result_t *result) {
-    for (int i = 0; i < slen; i++) {
-        for (int j = i, fid = 1, tid = 1, check = 0, base = 0; j < slen; j++, fid = tid) {
-            tid = dat->nodes[fid].base + s[j];
-            check = tid < dat->cap ? dat->nodes[tid].check : 0;
-            if (check != fid) {
-                break;
-            }
-            base = dat->nodes[tid].base;
-            if (base < 0) {
-                int pos = dat_strcmp(s + j + 1, &dat->tail.str[-base]) - 1;
-                if (dat->tail.str[-base + pos] == DAT_STOP_CHAR) {
-                    match_result_append(result, j + pos - i + 1, i);
+/**
+ * @brief 匹配文本与后缀字符串，文本长度有限，不越界读取
+ * 
+ * @param s    文本
+ * @param slen 文本剩余长度
+ * @param tail 后缀字符串，以DAT_STOP_CHAR结尾
+ * @return int 后缀完全匹配时返回后缀长度（不含结尾字符），否则返回-1
+ */
+static inline int dat_tail_prefix(const char *s, int slen, const char *tail) {
+    int i = 0;
+    while (i < slen && tail[i] != DAT_STOP_CHAR && tail[i] == s[i]) {
+        ++i;
+    }
+    return tail[i] == DAT_STOP_CHAR ? i : -1;
+}
+
+/**
+ * @brief 报告从位置i开始的匹配，按长度递增
+ * 
+ * @param dat  树指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param i    匹配起点
+ * @param cb   回调函数
+ * @param ctx  回调上下文
+ * @return int 0:完成 -1:被回调终止
+ */
+SM_INLINE int dat_search_at(const DATrie *dat, const char *s, int slen, int i, match_callback_t cb, void *ctx) {
+    for (int j = i, fid = 1, tid = 1, check = 0, base = 0; j < slen; j++, fid = tid) {
+        tid = dat->nodes[fid].base + (unsigned char)s[j];
+        check = tid < dat->cap ? dat->nodes[tid].check : 0;
+        if (check != fid) {
+            break;
+        }
+        base = dat->nodes[tid].base;
+        if (base < 0) {
+            int pos = dat_tail_prefix(s + j + 1, slen - j - 1, &dat->tail.str[-base]);
+            if (pos >= 0) {
+                if (match_emit(cb, ctx, j + pos - i + 1, i, dat_tail_id(&dat->tail, -base + pos)) != 0) {
+                    return -1;
                 }
-                break;
             }
-            if (base + DAT_STOP_CHAR < dat->cap && dat->nodes[base + DAT_STOP_CHAR].check == tid) {
-                match_result_append(result, j - i + 1, i);
+            break;
+        }
+        if (base + DAT_STOP_CHAR < dat->cap && dat->nodes[base + DAT_STOP_CHAR].check == tid) {
+            int stop_base = dat->nodes[base + DAT_STOP_CHAR].base;
+            int id = stop_base < 0 ? dat_tail_id(&dat->tail, -stop_base) : -1;
+            if (match_emit(cb, ctx, j - i + 1, i, id) != 0) {
+                return -1;
             }
         }
     }
-}
\ No newline at end of file
+    return 0;
+}
+
+SM_INLINE int dat_search_core(const DATrie *dat, const char *s, int slen, match_callback_t cb, void *ctx) {
+    for (int i = 0; i < slen; i++) {
+        if (dat_search_at(dat, s, slen, i, cb, ctx) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 不重叠匹配时同一起点的候选匹配
+ */
+typedef struct {
+    MatchKind kind;    // 报告方式
+    match_item_t best; // 当前候选，len为0表示没有
+} dat_leftmost_t;
+
+static inline int dat_leftmost_callback(const match_item_t *item, void *ctx) {
+    dat_leftmost_t *lm = (dat_leftmost_t *)ctx;
+    // 同一起点的匹配按长度递增到达，最长方式取最后一个，优先方式取id最小的
+    if (lm->best.len == 0 || lm->kind == MATCH_KIND_LEFTMOST_LONGEST || item->id < lm->best.id) {
+        lm->best = *item;
+    }
+    return 0;
+}
+
+/**
+ * @brief 不重叠匹配主循环，参数同dat_search_kind_cb
+ */
+SM_INLINE int dat_search_leftmost(const DATrie *dat, const char *s, int slen, MatchKind kind,
+                                  match_callback_t cb, void *ctx) {
+    dat_leftmost_t lm;
+    memset(&lm, 0, sizeof(lm));
+    lm.kind = kind;
+    for (int i = 0; i < slen;) {
+        lm.best.len = 0;
+        dat_search_at(dat, s, slen, i, dat_leftmost_callback, &lm);
+        if (lm.best.len == 0) {
+            ++i;
+            continue;
+        }
+        if (cb(&lm.best, ctx) != 0) {
+            return -1;
+        }
+        i += lm.best.len;
+    }
+    return 0;
+}
+
+void dat_search(const DATrie *dat, const char *s, int slen, match_result_t *result) {
+    dat_search_core(dat, s, slen, match_result_callback, result);
+}
+
+int dat_search_cb(const DATrie *dat, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return dat_search_core(dat, s, slen, cb, ctx);
+}
+
+/**
+ * @brief 按报告方式选择主循环，参数同dat_search_kind_cb
+ */
+SM_INLINE int dat_search_kind_core(const DATrie *dat, const char *s, int slen, MatchKind kind,
+                                   match_callback_t cb, void *ctx) {
+    if (kind == MATCH_KIND_STANDARD) {
+        return dat_search_core(dat, s, slen, cb, ctx);
+    }
+    return dat_search_leftmost(dat, s, slen, kind, cb, ctx);
+}
+
+void dat_search_kind(const DATrie *dat, const char *s, int slen, MatchKind kind, match_result_t *result) {
+    dat_search_kind_core(dat, s, slen, kind, match_result_callback, result);
+}
+
+int dat_search_kind_cb(const DATrie *dat, const char *s, int slen, MatchKind kind, match_callback_t cb, void *ctx) {
+    return dat_search_kind_core(dat, s, slen, kind, cb, ctx);
+}
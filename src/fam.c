@@ -1,11 +1,14 @@
+#include <stdlib.h>
 #include "xssm.h"
 #include "trie.h"
 
 static Trie* create_fa(const char *p, int plen) {
-	const char *patterns[] = {p};
-	Trie* trie = trie_create_ex(patterns, 1, STTABLE_TYPE_ARRAY);
+	Trie* trie = trie_create(STTABLE_TYPE_ARRAY);
+	trie_insert(trie, p, plen);
+	// 单模式串使用的字节很少，按等价类压缩后每个状态只保存少量转移
+	trie_compress(trie);
 	// 初始状态要满足FA的要求
-	memset(trie->sttbl->ast.stt, 0, sizeof(int) * CHARSET_SIZE);
+	sttable_reset_row(trie->sttbl, 0);
 	for (int i = 0; i < plen; i++) {
 		int state_id = trie_get_trans(trie, i, p[i]);
 		trie_set_trans(trie, i, i + 1, p[i]);
@@ -14,13 +17,45 @@ static Trie* create_fa(const char *p, int plen) {
 	return trie;
 }
 
-void fam_search(const char *s, const char *p, int slen, int plen) {	
-	Trie* trie = create_fa(p, plen);
+fam_pattern_t* fam_pattern_create(const char *p, int plen) {
+	if (plen <= 0) {
+		return NULL;
+	}
+	fam_pattern_t *fam = (fam_pattern_t *)malloc(sizeof(fam_pattern_t));
+	fam->plen = plen;
+	fam->trie = create_fa(p, plen);
+	return fam;
+}
+
+void fam_pattern_destroy(fam_pattern_t *fam) {
+	if (fam != NULL) {
+		trie_destroy(fam->trie);
+		free(fam);
+	}
+}
+
+void fam_pattern_search(const fam_pattern_t *fam, const char *s, int slen, match_result_t *result) {
+	const Trie *trie = fam->trie;
+	int plen = fam->plen;
 	int state_id = 0;
 	for (int i = 0; i < slen; i++) {
 		state_id = trie_get_trans(trie, state_id, s[i]);
 		if (trie->states[state_id].is_fin) {
-			printf("%d ", i - plen + 1);
+			if (match_result_emit(result, plen, i - plen + 1, 0) != 0) {
+				return;
+			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+void fam_search(const char *s, const char *p, int slen, int plen) {	
+	fam_pattern_t *fam = fam_pattern_create(p, plen);
+	if (fam == NULL) {
+		return;
+	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	fam_pattern_search(fam, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	fam_pattern_destroy(fam);
+}
@@ -1,12 +1,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include "horspool.h"
+#include "internal/sttable_get.h"
 #include "xssm.h"
 
 Horspool* horspool_create(int block_size) {
 	Horspool *hsp = (Horspool *)malloc(sizeof(Horspool));
 	memset(hsp, 0, sizeof(Horspool));
-	hsp->trie = trie_create(STTABLE_TYPE_DBARR);
+	hsp->trie = trie_create(HSP_STTABLE_TYPE);
 	hsp->min_len = INT32_MAX;
 	hsp->block_size = block_size;
 	return hsp;
@@ -28,8 +29,8 @@ void horspool_destroy(Horspool *hsp) {
 }
 
 void horspool_insert(Horspool *hsp, const char *p, int plen) {
-	if (plen > 0) {
-		trie_insert_reverse(hsp->trie, p, plen);
+	// 空模式串同样占用一个模式串id
+	if (trie_insert_reverse(hsp->trie, p, plen) != -1) {
 		if (hsp->min_len > plen) {
 			hsp->min_len = plen;
 		}
@@ -95,7 +96,7 @@ void horspool_build(Horspool *hsp) {
 	while (state_id != 0) {
 		dfs[++top] = state_id;
 		state = &states[state_id];
-		pattern[hsp->trie->depth - top - 1] = state->c;
+		pattern[hsp->trie->depth - top] = state->c;
 		if (state->is_fin) {
 			horspool_build_shift(hsp, state, pattern + hsp->trie->depth - top);
 		}
@@ -114,22 +115,34 @@ void horspool_build(Horspool *hsp) {
 	}
 }
 
-void horspool_trie_search(const Horspool *hsp, const char *s, int slen, match_result_t *result) {
+SM_INLINE int horspool_trie_search_core(const Horspool *hsp, const char *s, int slen, match_callback_t cb, void *ctx) {
 	Trie *trie = hsp->trie;
+	const sttable_t *tbl = trie->sttbl;
 	for (int i = hsp->min_len - 1, shift = 0; i < slen; i += shift) {
 		for (int j = i, state_id = 0; j >= 0; j--) {
-			state_id = trie_get_trans(trie, state_id, s[j]);
+			state_id = sttable_get_typed(tbl, HSP_STTABLE_TYPE, state_id, s[j]);
 			if (state_id == -1) {
 				break;
 			}
 			TrieState *state = &trie->states[state_id];
 			if (state->is_fin) {
-				match_result_append(result, i - j + 1, j);
+				if (match_emit(cb, ctx, i - j + 1, j, state->pid) != 0) {
+					return -1;
+				}
 			}
 		}
 		int hash = horspool_hash(s + i - hsp->block_size + 1, hsp->block_size, hsp->base);
 		shift = hsp->shift[hash];
 	}
+	return 0;
+}
+
+void horspool_trie_search(const Horspool *hsp, const char *s, int slen, match_result_t *result) {
+	horspool_trie_search_core(hsp, s, slen, match_result_callback, result);
+}
+
+int horspool_trie_search_cb(const Horspool *hsp, const char *s, int slen, match_callback_t cb, void *ctx) {
+	return horspool_trie_search_core(hsp, s, slen, cb, ctx);
 }
 
 /**
@@ -143,20 +156,53 @@ static void build_shift(int shift[], const char *p, int plen) {
 	for (int i = 0; i < CHARSET_SIZE; i++)
 		shift[i] = plen;
 	for (int i = 0; i < plen - 1; i++) {
-		shift[p[i]] = plen - 1 - i;
+		shift[(unsigned char)p[i]] = plen - 1 - i;
 	}
 }
 
-void horspool_search(const char *s, const char *p, int slen, int plen) {
-	int shift[CHARSET_SIZE];
-	build_shift(shift, p, plen);
+horspool_pattern_t* horspool_pattern_create(const char *p, int plen) {
+	if (plen <= 0) {
+		return NULL;
+	}
+	horspool_pattern_t *hp = (horspool_pattern_t *)malloc(sizeof(horspool_pattern_t));
+	hp->plen = plen;
+	hp->p = (char *)malloc(plen);
+	memcpy(hp->p, p, plen);
+	build_shift(hp->shift, hp->p, plen);
+	return hp;
+}
+
+void horspool_pattern_destroy(horspool_pattern_t *hp) {
+	if (hp != NULL) {
+		free(hp->p);
+		free(hp);
+	}
+}
+
+void horspool_pattern_search(const horspool_pattern_t *hp, const char *s, int slen, match_result_t *result) {
+	const char *p = hp->p;
+	int plen = hp->plen;
 	int i = 0; // 窗口位置
 	int j = 0; // 窗口内字符位置
 	while (i <= slen - plen) {
 		for (j = plen - 1; j >= 0 && s[i + j] == p[j]; j--);
 		if (j == -1) {
-			printf("%d ", i);
+			if (match_result_emit(result, plen, i, 0) != 0) {
+				return;
+			}
 		}
-		i += shift[s[i + plen - 1]];
+		i += hp->shift[(unsigned char)s[i + plen - 1]];
+	}
+}
+
+void horspool_search(const char *s, const char *p, int slen, int plen) {
+	horspool_pattern_t *hp = horspool_pattern_create(p, plen);
+	if (hp == NULL) {
+		return;
 	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	horspool_pattern_search(hp, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	horspool_pattern_destroy(hp);
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "xssm.h"
 
 /* 模余运算性质
@@ -7,27 +8,66 @@
 
 #define MULTIPLY_FACTOR 31
 
-void kr_search(const char *s, const char *p, int slen, int plen) {
+kr_pattern_t* kr_pattern_create(const char *p, int plen) {
+    if (plen <= 0) {
+        return NULL;
+    }
+    kr_pattern_t *kr = (kr_pattern_t *)malloc(sizeof(kr_pattern_t));
+    kr->plen = plen;
+    kr->p = (char *)malloc(plen);
+    memcpy(kr->p, p, plen);
+    kr->hash = 0;
+    kr->minus_factor = 1;
+    for (int i = 0; i < plen; i++) {
+        kr->hash = kr->hash * MULTIPLY_FACTOR + p[i];
+    }
+    for (int i = 1; i < plen; i++) {
+        kr->minus_factor *= MULTIPLY_FACTOR;
+    }
+    return kr;
+}
+
+void kr_pattern_destroy(kr_pattern_t *kr) {
+    if (kr != NULL) {
+        free(kr->p);
+        free(kr);
+    }
+}
+
+void kr_pattern_search(const kr_pattern_t *kr, const char *s, int slen, match_result_t *result) {
+    const char *p = kr->p;
+    int plen = kr->plen;
     if (slen < plen) {
         return;
     }
-    uint64_t patt_hash = 0;
+    uint64_t patt_hash = kr->hash;
     uint64_t text_hash = 0;
-    uint64_t minus_factor = 1;
     for (int i = 0; i < plen; i++) {
-        patt_hash = patt_hash * MULTIPLY_FACTOR + p[i];
         text_hash = text_hash * MULTIPLY_FACTOR + s[i];
     }
     if (patt_hash == text_hash && memcmp(s, p, plen) == 0) {
-        printf("%d ", 0);
-    }
-    for (int i = 1; i < plen; i++) {
-        minus_factor *= MULTIPLY_FACTOR;
+        if (match_result_emit(result, plen, 0, 0) != 0) {
+            return;
+        }
     }
     for (int i = plen; i < slen; i++) {
-        text_hash = (text_hash - s[i - plen] * minus_factor) * MULTIPLY_FACTOR + s[i];
+        text_hash = (text_hash - s[i - plen] * kr->minus_factor) * MULTIPLY_FACTOR + s[i];
         if (patt_hash == text_hash && memcmp(s + i - plen + 1, p, plen) == 0) {
-            printf("%d ", i - plen + 1);
+            if (match_result_emit(result, plen, i - plen + 1, 0) != 0) {
+                return;
+            }
         }
     }
+}
+
+void kr_search(const char *s, const char *p, int slen, int plen) {
+    kr_pattern_t *kr = kr_pattern_create(p, plen);
+    if (kr == NULL) {
+        return;
+    }
+    match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+    kr_pattern_search(kr, s, slen, result);
+    match_result_print(result);
+    match_result_destroy(result);
+    kr_pattern_destroy(kr);
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "xssm.h"
 
 /**
@@ -18,12 +19,33 @@ static void build_next(const char *p, int next[], int plen);
  */
 static void build_next_adv(const char *p, int next[], int plen);
 
-void kmp_search(const char *s, const char *p, int slen, int plen) {
+kmp_pattern_t* kmp_pattern_create(const char *p, int plen) {
+	if (plen <= 0) {
+		return NULL;
+	}
+	kmp_pattern_t *kmp = (kmp_pattern_t *)malloc(sizeof(kmp_pattern_t));
+	kmp->plen = plen;
+	kmp->p = (char *)malloc(plen);
+	memcpy(kmp->p, p, plen);
+	kmp->next = (int *)calloc(plen + 1, sizeof(int));
+	build_next(kmp->p, kmp->next, plen);
+	return kmp;
+}
+
+void kmp_pattern_destroy(kmp_pattern_t *kmp) {
+	if (kmp != NULL) {
+		free(kmp->p);
+		free(kmp->next);
+		free(kmp);
+	}
+}
+
+void kmp_pattern_search(const kmp_pattern_t *kmp, const char *s, int slen, match_result_t *result) {
+	const char *p = kmp->p;
+	const int *next = kmp->next;
+	int plen = kmp->plen;
 	int i = 0; // 文本串索引
 	int j = 0; // 模式传索引
-	int next[plen + 1];
-	memset(next, 0, sizeof(next));
-	build_next(p, next, plen);
 	while (i < slen) {
 		while (i < slen && j < plen) {
 			if (j == -1 || s[i] == p[j]) {
@@ -34,12 +56,26 @@ void kmp_search(const char *s, const char *p, int slen, int plen) {
 			}
 		}
 		if (j == plen) {
-			printf("%d ", i - j);
+			if (match_result_emit(result, plen, i - j, 0) != 0) {
+				return;
+			}
 			j = next[j];
 		}
 	}
 }
 
+void kmp_search(const char *s, const char *p, int slen, int plen) {
+	kmp_pattern_t *kmp = kmp_pattern_create(p, plen);
+	if (kmp == NULL) {
+		return;
+	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	kmp_pattern_search(kmp, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	kmp_pattern_destroy(kmp);
+}
+
 static void build_next(const char *p, int next[], int plen) {
 	next[0] = -1;
 	int k = -1;
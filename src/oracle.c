@@ -1,10 +1,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include "oracle.h"
+#include "internal/sttable_get.h"
 
 Oracle* oracle_create() {
+    return oracle_create_typed(ORC_STTABLE_TYPE);
+}
+
+Oracle* oracle_create_typed(STTableType sttype) {
+    // 构建时会增加trie树之外的转移，双数组的转移依赖trie树子节点，无法保存
+    if (sttype == STTABLE_TYPE_DBARR || sttype == STTABLE_TYPE_ARRAY16 || sttype == STTABLE_TYPE_HYBRID_DIFF) {
+        return NULL;
+    }
     Oracle *orc = (Oracle *)malloc(sizeof(Oracle));
     memset(orc, 0, sizeof(Oracle));
+    orc->sttype = sttype;
     orc->min_len = INT32_MAX;
     orc->nsize = ORC_DEFAULT_NODE_NUM;
     orc->nodes = (orc_slist_node_t *)malloc(sizeof(orc_slist_node_t) * ORC_DEFAULT_NODE_NUM);
@@ -23,16 +33,25 @@ Oracle* oracle_create_ex(const char *patterns[], int pnum) {
 
 void oracle_destroy(Oracle *orc) {
     free(orc->lists);
-    for (int i = 0; i < orc->pnum; i++) {
-        free(orc->nodes[i].str);
+    // 加载的自动机模式串和终止状态ID数组位于映像中，由trie树解除映射
+    if (orc->trie == NULL || orc->trie->image == NULL) {
+        for (int i = 0; i < orc->pnum; i++) {
+            free(orc->nodes[i].str);
+        }
+        free(orc->fids);
     }
     free(orc->nodes);
-    free(orc->fids);
-    trie_destroy(orc->trie);
+    if (orc->trie != NULL) {
+        trie_destroy(orc->trie);
+    }
     free(orc);
 }
 
 int oracle_insert(Oracle *orc, const char *p, int plen) {
+    int id = orc->id_num++;
+    if (orc->trie != NULL && orc->trie->image != NULL) {
+        return -1;
+    }
     if (plen <= 0) {
         return 0;
     }
@@ -48,6 +67,7 @@ int oracle_insert(Oracle *orc, const char *p, int plen) {
         orc->nsize = nsize * 2;
     }
     orc_slist_node_t* node = &orc->nodes[pnum];
+    node->id = id;
     node->len = plen;
     node->str = (char *)malloc(plen + 1);
     strncpy(node->str, p, plen + 1);
@@ -55,12 +75,18 @@ int oracle_insert(Oracle *orc, const char *p, int plen) {
     if (orc->min_len > plen) {
         orc->min_len = plen;
     }
+    if (orc->max_len < plen) {
+        orc->max_len = plen;
+    }
     return 0;
 }
 
 static void oracle_build_trie(Oracle *orc);
 
 void oracle_build(Oracle *orc) {
+    if (orc->trie != NULL && orc->trie->image != NULL) {
+        return;
+    }
     oracle_build_trie(orc);
     int state_num = orc->trie->state_num;
     int *supply = (int *) malloc(sizeof(int) * state_num);
@@ -85,18 +111,35 @@ void oracle_build(Oracle *orc) {
     free(supply);
 }
 
-void oracle_search(const Oracle *orc, const char *s, int slen, match_result_t *result) {
+/**
+ * @brief 匹配主循环
+ * 
+ * @param orc  自动机指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param type 状态转移表实例类型
+ * @param cb   回调函数
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int oracle_search_typed(const Oracle *orc, const char *s, int slen, STTableType type,
+                                  match_callback_t cb, void *ctx) {
     // i表示窗口位置，j表示窗口内字符位置
+    const sttable_t *tbl = orc->trie->sttbl;
     int min_len = orc->min_len;
     for (int i = 0, j = min_len - 1; i <= slen - min_len; i = i + j + 1, j = min_len - 1) {
         int state_id = 0;
-        while ((state_id = trie_get_trans(orc->trie, state_id, s[i + j])) != -1) {
+        while ((state_id = sttable_get_typed(tbl, type, state_id, s[i + j])) != -1) {
             if (j == 0) {
-                orc_slist_node_t *node = orc->lists[orc->fids[state_id]].first;
+                // oracle识别的串多于模式串后缀，非终止状态没有候选模式串
+                int fid = orc->fids[state_id];
+                orc_slist_node_t *node = fid != -1 ? orc->lists[fid].first : NULL;
                 while (node != NULL) {
                     int pos = i + min_len - node->len;
-                    if (pos >= 0 && memcmp(s + pos, node->str, node->len - min_len) == 0) {
-                        match_result_append(result, node->len, pos);
+                    if (pos >= 0 && memcmp(s + pos, node->str, node->len) == 0) {
+                        if (match_emit(cb, ctx, node->len, pos, node->id) != 0) {
+                            return -1;
+                        }
                     }
                     node = node->next;
                 }
@@ -105,14 +148,194 @@ void oracle_search(const Oracle *orc, const char *s, int slen, match_result_t *r
             j--;
         }
     }
+    return 0;
+}
+
+/**
+ * @brief 按状态转移表类型选择主循环实例，oracle_create_typed接受的每种类型都以常量实例化
+ */
+SM_INLINE int oracle_search_core(const Oracle *orc, const char *s, int slen, match_callback_t cb, void *ctx) {
+    switch (sttable_inst_type(orc->trie->sttbl)) {
+        case STTABLE_TYPE_LIST:
+            return oracle_search_typed(orc, s, slen, STTABLE_TYPE_LIST, cb, ctx);
+        case STTABLE_TYPE_ARRAY:
+            return oracle_search_typed(orc, s, slen, STTABLE_TYPE_ARRAY, cb, ctx);
+        case STTABLE_TYPE_HASHT:
+            return oracle_search_typed(orc, s, slen, STTABLE_TYPE_HASHT, cb, ctx);
+        case STTABLE_TYPE_OHASH:
+            return oracle_search_typed(orc, s, slen, STTABLE_TYPE_OHASH, cb, ctx);
+        case STTABLE_TYPE_BITMAP:
+            return oracle_search_typed(orc, s, slen, STTABLE_TYPE_BITMAP, cb, ctx);
+        case STTABLE_TYPE_HYBRID:
+            return oracle_search_typed(orc, s, slen, STTABLE_TYPE_HYBRID, cb, ctx);
+        default:
+            return 0;
+    }
+}
+
+void oracle_search(const Oracle *orc, const char *s, int slen, match_result_t *result) {
+    oracle_search_core(orc, s, slen, match_result_callback, result);
+}
+
+int oracle_search_cb(const Oracle *orc, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return oracle_search_core(orc, s, slen, cb, ctx);
+}
+
+int64_t oracle_count(const Oracle *orc, const char *s, int slen) {
+    int64_t count = 0;
+    oracle_search_core(orc, s, slen, match_count_callback, &count);
+    return count;
+}
+
+int oracle_contains(const Oracle *orc, const char *s, int slen) {
+    return oracle_search_core(orc, s, slen, match_stop_callback, NULL) != 0;
+}
+
+/**
+ * @brief oracle自动机在映像中的记录
+ */
+typedef struct {
+    int32_t min_len; // 最小模式串长度
+    int32_t max_len; // 最大模式串长度
+    int32_t pnum;    // 模式串数量
+    int32_t id_num;  // 已分配的模式串id数
+    int32_t fids;    // 终止状态ID数组所在的段
+    int32_t lists;   // 字符串链表首节点下标所在的段
+    int32_t nodes;   // 字符串节点记录所在的段
+    int32_t strs;    // 字符串所在的段
+    trie_image_t trie; // trie树记录
+} oracle_image_t;
+
+int oracle_save(const Oracle *orc, const char *path) {
+    if (orc->trie == NULL) {
+        return -1;
+    }
+    int pnum = orc->pnum;
+    int fnum = orc->trie->fin_state_num;
+    int64_t slen = 0;
+    for (int i = 0; i < pnum; i++) {
+        slen += orc->nodes[i].len + 1;
+    }
+    sm_image_strnode_t *recs = (sm_image_strnode_t *)malloc(sizeof(sm_image_strnode_t) * (pnum > 0 ? pnum : 1));
+    int32_t *firsts = (int32_t *)malloc(sizeof(int32_t) * (fnum > 0 ? fnum : 1));
+    char *strs = (char *)malloc(slen > 0 ? slen : 1);
+    int ret = -1;
+    if (recs != NULL && firsts != NULL && strs != NULL) {
+        for (int i = 0, off = 0; i < pnum; i++) {
+            const orc_slist_node_t *node = &orc->nodes[i];
+            recs[i].id = node->id;
+            recs[i].len = node->len;
+            recs[i].off = off;
+            recs[i].next = node->next != NULL ? (int32_t)(node->next - orc->nodes) : -1;
+            memcpy(strs + off, node->str, node->len + 1);
+            off += node->len + 1;
+        }
+        for (int i = 0; i < fnum; i++) {
+            firsts[i] = orc->lists[i].first != NULL ? (int32_t)(orc->lists[i].first - orc->nodes) : -1;
+        }
+        sm_image_writer_t w;
+        oracle_image_t meta;
+        sm_image_writer_init(&w, SM_IMAGE_ORACLE);
+        sm_image_add(&w, &meta, sizeof(meta));
+        meta.min_len = orc->min_len;
+        meta.max_len = orc->max_len;
+        meta.pnum = pnum;
+        meta.id_num = orc->id_num;
+        // 搜索只访问已有状态的终止状态ID
+        meta.fids = sm_image_add(&w, orc->fids, sizeof(int) * orc->trie->state_num);
+        meta.lists = sm_image_add(&w, firsts, sizeof(int32_t) * fnum);
+        meta.nodes = sm_image_add(&w, recs, sizeof(sm_image_strnode_t) * pnum);
+        meta.strs = sm_image_add(&w, strs, slen);
+        if (trie_image_put(orc->trie, &w, &meta.trie) == 0) {
+            ret = sm_image_write(&w, path);
+        }
+    }
+    free(recs);
+    free(firsts);
+    free(strs);
+    return ret;
+}
+
+/**
+ * @brief 按节点记录重建字符串链表，字符串指向映像中的字符串段
+ * 
+ * @param orc  自动机指针，trie树已加载
+ * @param meta 自动机记录
+ * @return int 0:成功 -1:记录与段不符或内存不足
+ */
+static int oracle_image_link(Oracle *orc, const oracle_image_t *meta) {
+    const sm_image_t *img = orc->trie->image;
+    int pnum = meta->pnum;
+    int fnum = orc->trie->fin_state_num;
+    uint64_t slen = 0;
+    const char *strs = (const char *)sm_image_section(img, meta->strs, &slen);
+    const sm_image_strnode_t *recs = (const sm_image_strnode_t *)sm_image_get(img, meta->nodes,
+                                                                              sizeof(sm_image_strnode_t) * (uint64_t)pnum);
+    const int32_t *firsts = (const int32_t *)sm_image_get(img, meta->lists, sizeof(int32_t) * (uint64_t)fnum);
+    orc->fids = (int *)sm_image_get(img, meta->fids, sizeof(int) * (uint64_t)orc->trie->state_num);
+    orc->nodes = (orc_slist_node_t *)calloc(pnum > 0 ? pnum : 1, sizeof(orc_slist_node_t));
+    orc->lists = (orc_slist_t *)calloc(fnum > 0 ? fnum : 1, sizeof(orc_slist_t));
+    if (strs == NULL || recs == NULL || firsts == NULL || orc->fids == NULL || orc->nodes == NULL || orc->lists == NULL) {
+        return -1;
+    }
+    orc->nsize = pnum > 0 ? pnum : 1;
+    orc->pnum = pnum;
+    for (int i = 0; i < pnum; i++) {
+        const sm_image_strnode_t *rec = &recs[i];
+        if (rec->len <= 0 || rec->off < 0 || (uint64_t)rec->off + rec->len >= slen || strs[rec->off + rec->len] != '\0'
+            || rec->next < -1 || rec->next >= pnum) {
+            return -1;
+        }
+        orc->nodes[i].id = rec->id;
+        orc->nodes[i].len = rec->len;
+        orc->nodes[i].str = (char *)strs + rec->off;
+        orc->nodes[i].next = rec->next != -1 ? &orc->nodes[rec->next] : NULL;
+    }
+    for (int i = 0; i < fnum; i++) {
+        if (firsts[i] < -1 || firsts[i] >= pnum) {
+            return -1;
+        }
+        orc->lists[i].first = firsts[i] != -1 ? &orc->nodes[firsts[i]] : NULL;
+    }
+    return 0;
+}
+
+Oracle* oracle_load(const char *path, int verify) {
+    sm_image_t *img = sm_image_open(path, SM_IMAGE_ORACLE, verify);
+    if (img == NULL) {
+        return NULL;
+    }
+    const oracle_image_t *meta = (const oracle_image_t *)sm_image_get(img, 0, sizeof(oracle_image_t));
+    Trie *trie = meta != NULL && meta->pnum >= 0 ? trie_image_get(img, &meta->trie) : NULL;
+    Oracle *orc = trie != NULL ? (Oracle *)calloc(1, sizeof(Oracle)) : NULL;
+    if (orc == NULL) {
+        if (trie != NULL) {
+            trie_destroy(trie);
+        } else {
+            sm_image_close(img);
+        }
+        return NULL;
+    }
+    orc->trie = trie;
+    orc->sttype = trie->sttbl->type;
+    orc->min_len = meta->min_len;
+    orc->max_len = meta->max_len;
+    orc->id_num = meta->id_num;
+    if (oracle_image_link(orc, meta) != 0) {
+        oracle_destroy(orc);
+        return NULL;
+    }
+    return orc;
 }
 
 static void oracle_build_trie(Oracle *orc) {
     int nfids[orc->pnum];
     char reverse[orc->min_len];
-    orc->trie = trie_create(STTABLE_TYPE_HASHT);
-    orc->fids = (int*)malloc(sizeof(int) * orc->min_len * orc->pnum);
-    memset(orc->fids, -1, sizeof(int) * orc->min_len * orc->pnum);
+    orc->trie = trie_create(orc->sttype);
+    // 状态数最多为min_len * pnum + 1（含初始状态）
+    int fsize = orc->min_len * orc->pnum + 1;
+    orc->fids = (int*)malloc(sizeof(int) * fsize);
+    memset(orc->fids, -1, sizeof(int) * fsize);
     for (int i = 0; i < orc->pnum; i++) {
         orc_slist_node_t *node = &orc->nodes[i];
         // 字符串后缀反转
@@ -125,12 +348,18 @@ static void oracle_build_trie(Oracle *orc) {
         }
         nfids[i] = orc->fids[state_id];
     }
-    // 构造每个终止状态对应的字符串链表
+    // 构造每个终止状态对应的字符串链表，重复的模式串只保留第一次插入的
     orc->lists = (orc_slist_t*)calloc(orc->trie->fin_state_num, sizeof(orc_slist_t));
     for (int i = 0; i < orc->pnum; i++) {
         orc_slist_node_t *node = &orc->nodes[i];
         orc_slist_t *list = &orc->lists[nfids[i]];
-        node->next = list->first;
-        list->first = node;
+        orc_slist_node_t *same = list->first;
+        while (same != NULL && (same->len != node->len || memcmp(same->str, node->str, node->len) != 0)) {
+            same = same->next;
+        }
+        if (same == NULL) {
+            node->next = list->first;
+            list->first = node;
+        }
     }
 }
\ No newline at end of file
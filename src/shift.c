@@ -28,9 +28,16 @@ void shift_nfa_destroy(ShiftNFA *snfa) {
 }
 
 int shift_nfa_insert(ShiftNFA *snfa, const char *p, int plen) {
+	int id = snfa->id_num++;
 	if (plen > SHIFT_MAX_PATTERN_LEN || snfa->pnum >= SHIFT_MAX_PATTERN_NUM) {
 		return -1;
 	}
+	// 重复的模式串只保留第一次插入的id
+	for (int i = 0; i < snfa->pnum; i++) {
+		if (snfa->patterns[i].len == plen && memcmp(snfa->patterns[i].str, p, plen) == 0) {
+			return 0;
+		}
+	}
 	int max_len = snfa->max_len;
 	if (max_len < plen) {
 		max_len = plen;
@@ -40,6 +47,7 @@ int shift_nfa_insert(ShiftNFA *snfa, const char *p, int plen) {
 	}
 	snfa->max_len = max_len;
 	snfa->patterns[snfa->pnum].len = plen;
+	snfa->patterns[snfa->pnum].id = id;
 	strncpy(snfa->patterns[snfa->pnum].str, p, SHIFT_MAX_PATTERN_LEN);
 	++snfa->pnum;
 	return 0;
@@ -54,65 +62,176 @@ void shift_nfa_build(ShiftNFA *snfa) {
 		bit_array_set(&snfa->int_mask, pos);
 		bit_array_set(&snfa->fin_mask, pos + pattern->len - 1);
 		for (int j = 0; j < pattern->len; j++) {
-			bit_array_set(&snfa->mask[pattern->str[j]], pos + j);
+			bit_array_set(&snfa->mask[(unsigned char)pattern->str[j]], pos + j);
 		}
 	}
 }
 
-void shift_nfa_search(const ShiftNFA *snfa, const char *s, int slen, match_result_t* result) {
-	bit_array_t status;
+/**
+ * @brief 扫描主循环
+ * 
+ * @param snfa   ShiftNFA指针
+ * @param s      字符串
+ * @param slen   字符串长度
+ * @param status 起始状态位数组，扫描完成后写回结束状态
+ * @param base   字符串首字符的绝对偏移
+ * @param cb     回调函数
+ * @param ctx    回调上下文
+ * @return int   0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int shift_nfa_search_core(const ShiftNFA *snfa, const char *s, int slen, bit_array_t *status, int64_t base, match_callback_t cb, void *ctx) {
+	bit_array_t cur;
 	bit_array_t fin_status;
-	bit_array_reset(&status);
+	bit_array_copy(&cur, status);
 	bit_array_reset(&fin_status);
 	int pos = 0;
 	for (int i = 0; i < slen; i++) {
-		bit_array_lshift(&status);
-		bit_array_or(&status, &snfa->int_mask);
-		bit_array_and(&status, &snfa->mask[s[i]]);
-		bit_array_copy(&fin_status, &status);
+		bit_array_lshift(&cur);
+		bit_array_or(&cur, &snfa->int_mask);
+		bit_array_and(&cur, &snfa->mask[(unsigned char)s[i]]);
+		bit_array_copy(&fin_status, &cur);
 		bit_array_and(&fin_status, &snfa->fin_mask);
 		while ((pos = bit_array_pop(&fin_status)) != -1) {
 			const _snfa_pattern_t *pattern = &snfa->patterns[pos / snfa->max_len];
-			match_result_append(result, pattern->len, i - pattern->len + 1);
+			if (match_emit(cb, ctx, pattern->len, base + i - pattern->len + 1, pattern->id) != 0) {
+				return -1;
+			}
 		}
 	}
+	bit_array_copy(status, &cur);
+	return 0;
 }
 
-void shift_and_search(const char* s, const char* p, int slen, int plen) {
+void shift_nfa_search(const ShiftNFA *snfa, const char *s, int slen, match_result_t* result) {
+	bit_array_t status;
+	bit_array_reset(&status);
+	shift_nfa_search_core(snfa, s, slen, &status, 0, match_result_callback, result);
+}
+
+int shift_nfa_search_cb(const ShiftNFA *snfa, const char *s, int slen, match_callback_t cb, void *ctx) {
+	bit_array_t status;
+	bit_array_reset(&status);
+	return shift_nfa_search_core(snfa, s, slen, &status, 0, cb, ctx);
+}
+
+shift_nfa_stream_t* shift_nfa_stream_create(const ShiftNFA *snfa) {
+	shift_nfa_stream_t *stream = (shift_nfa_stream_t *)malloc(sizeof(shift_nfa_stream_t));
+	if (stream == NULL) {
+		return NULL;
+	}
+	stream->snfa = snfa;
+	shift_nfa_stream_reset(stream);
+	return stream;
+}
+
+void shift_nfa_stream_destroy(shift_nfa_stream_t *stream) {
+	free(stream);
+}
+
+void shift_nfa_stream_reset(shift_nfa_stream_t *stream) {
+	bit_array_reset(&stream->status);
+	stream->offset = 0;
+}
+
+int shift_nfa_stream_search_cb(shift_nfa_stream_t *stream, const char *s, int slen, match_callback_t cb, void *ctx) {
+	if (shift_nfa_search_core(stream->snfa, s, slen, &stream->status, stream->offset, cb, ctx) != 0) {
+		return -1;
+	}
+	stream->offset += slen;
+	return 0;
+}
+
+void shift_nfa_stream_search(shift_nfa_stream_t *stream, const char *s, int slen, match_result_t *result) {
+	shift_nfa_stream_search_cb(stream, s, slen, match_result_callback, result);
+}
+
+shift_and_pattern_t* shift_and_pattern_create(const char *p, int plen) {
+	if (plen <= 0 || plen > 64) {
+		return NULL;
+	}
+	shift_and_pattern_t *sa = (shift_and_pattern_t *)malloc(sizeof(shift_and_pattern_t));
 	//构建字符掩码表
 	//字符掩码表示字符在模式串中每个位置是否出现，0-未出现，1-出现
-	uint64_t mask[CHARSET_SIZE];
-	for (int i = 0; i < CHARSET_SIZE; i++) {
-		mask[i] = 0;
-	}
+	memset(sa->mask, 0, sizeof(sa->mask));
 	for (int i = 0; i < plen; i++) {
-		mask[p[i]] |= 1 << i;
+		sa->mask[(unsigned char)p[i]] |= (uint64_t)1 << i;
 	}
+	sa->plen = plen;
+	sa->target = (uint64_t)1 << (plen - 1);
+	return sa;
+}
+
+void shift_and_pattern_destroy(shift_and_pattern_t *sa) {
+	free(sa);
+}
+
+void shift_and_pattern_search(const shift_and_pattern_t *sa, const char *s, int slen, match_result_t *result) {
 	//当前状态，每个二进制位用于表示前缀p[0-i]是否匹配
 	uint64_t status = 0;
-	uint64_t target = 1 << (plen - 1);
+	uint64_t target = sa->target;
+	int plen = sa->plen;
 	for (int i = 0; i < slen; i++) {
-		status = (status << 1 | 1) & mask[s[i]];
-		if ((status & target) == target) {
-			printf("%d ", i - plen + 1);
+		status = (status << 1 | 1) & sa->mask[(unsigned char)s[i]];
+		if (status & target) {
+			if (match_result_emit(result, plen, i - plen + 1, 0) != 0) {
+				return;
+			}
 		}
 	}
 }
 
-void shift_or_search(const char* s, const char* p, int slen, int plen) {
-	uint64_t mask[CHARSET_SIZE];
-	for (int i = 0; i < CHARSET_SIZE; i++) {
-		mask[i] = ~0;
+void shift_and_search(const char* s, const char* p, int slen, int plen) {
+	shift_and_pattern_t *sa = shift_and_pattern_create(p, plen);
+	if (sa == NULL) {
+		return;
 	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	shift_and_pattern_search(sa, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	shift_and_pattern_destroy(sa);
+}
+
+shift_or_pattern_t* shift_or_pattern_create(const char *p, int plen) {
+	if (plen <= 0 || plen > 64) {
+		return NULL;
+	}
+	shift_or_pattern_t *so = (shift_or_pattern_t *)malloc(sizeof(shift_or_pattern_t));
+	memset(so->mask, 0xff, sizeof(so->mask));
 	for (int i = 0; i < plen; i++) {
-		mask[p[i]] &= ~(1 << i);
+		so->mask[(unsigned char)p[i]] &= ~((uint64_t)1 << i);
 	}
-	uint64_t target = ~(1 << (plen - 1));
-	uint64_t status = ~0;
+	so->plen = plen;
+	so->target = (uint64_t)1 << (plen - 1);
+	return so;
+}
+
+void shift_or_pattern_destroy(shift_or_pattern_t *so) {
+	free(so);
+}
+
+void shift_or_pattern_search(const shift_or_pattern_t *so, const char *s, int slen, match_result_t *result) {
+	uint64_t status = ~(uint64_t)0;
+	uint64_t target = so->target;
+	int plen = so->plen;
 	for (int i = 0; i < slen; i++) {
-		status = (status << 1) | mask[s[i]];
-		if ((status | target) == target) {
-			printf("%d ", i - plen + 1);
+		status = (status << 1) | so->mask[(unsigned char)s[i]];
+		if ((status & target) == 0) {
+			if (match_result_emit(result, plen, i - plen + 1, 0) != 0) {
+				return;
+			}
 		}
 	}
+}
+
+void shift_or_search(const char* s, const char* p, int slen, int plen) {
+	shift_or_pattern_t *so = shift_or_pattern_create(p, plen);
+	if (so == NULL) {
+		return;
+	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	shift_or_pattern_search(so, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	shift_or_pattern_destroy(so);
 }
\ No newline at end of file
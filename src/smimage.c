@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "smimage.h"
+
+/**
+ * @brief 段偏移按SM_IMAGE_ALIGN向上对齐
+ */
+static inline uint64_t sm_image_align(uint64_t off) {
+    return (off + SM_IMAGE_ALIGN - 1) & ~(uint64_t)(SM_IMAGE_ALIGN - 1);
+}
+
+/**
+ * @brief 累加校验和，四路交错处理32字节的块，乘法链互不依赖，加载时校验接近内存带宽
+ *
+ * @param h    当前校验和
+ * @param data 数据
+ * @param len  数据长度
+ * @return uint64_t 新校验和
+ */
+static uint64_t sm_image_hash(uint64_t h, const void *data, uint64_t len) {
+    const uint64_t prime = 0x100000001B3ull;
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t lane[4] = {h ^ len, h + prime, h ^ (len << 32), h - prime};
+    for (; len >= 32; p += 32, len -= 32) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t w;
+            memcpy(&w, p + i * 8, sizeof(w));
+            lane[i] = (lane[i] ^ w) * prime;
+            lane[i] ^= lane[i] >> 29;
+        }
+    }
+    h = ((lane[0] * prime ^ lane[1]) * prime ^ lane[2]) * prime ^ lane[3];
+    for (; len > 0; p++, len--) {
+        h = (h ^ *p) * prime;
+    }
+    return h;
+}
+
+void sm_image_writer_init(sm_image_writer_t *w, SMImageKind kind) {
+    memset(w, 0, sizeof(sm_image_writer_t));
+    memcpy(w->hdr.magic, SM_IMAGE_MAGIC, sizeof(SM_IMAGE_MAGIC));
+    w->hdr.version = SM_IMAGE_VERSION;
+    w->hdr.endian = SM_IMAGE_ENDIAN;
+    w->hdr.kind = kind;
+}
+
+int sm_image_add(sm_image_writer_t *w, const void *data, uint64_t len) {
+    if (w->hdr.nsec >= SM_IMAGE_MAX_SECTIONS) {
+        w->overflow = 1;
+        return -1;
+    }
+    int idx = w->hdr.nsec++;
+    w->hdr.secs[idx].len = len;
+    w->data[idx] = data;
+    return idx;
+}
+
+int sm_image_write(sm_image_writer_t *w, const char *path) {
+    if (w->overflow) {
+        return -1;
+    }
+    sm_image_header_t *hdr = &w->hdr;
+    uint64_t off = sm_image_align(sizeof(sm_image_header_t));
+    uint64_t checksum = 0xCBF29CE484222325ull;
+    for (uint32_t i = 0; i < hdr->nsec; i++) {
+        hdr->secs[i].off = off;
+        off = sm_image_align(off + hdr->secs[i].len);
+        checksum = sm_image_hash(checksum, w->data[i], hdr->secs[i].len);
+    }
+    hdr->size = off;
+    hdr->checksum = checksum;
+    // 先写入同一目录下的临时文件，再改名替换目标文件；
+    // 已映射旧映像的进程继续使用旧inode，不会因文件被截断而访问越界
+    size_t plen = strlen(path);
+    char *tmp = (char *)malloc(plen + sizeof(".XXXXXX"));
+    if (tmp == NULL) {
+        return -1;
+    }
+    memcpy(tmp, path, plen);
+    memcpy(tmp + plen, ".XXXXXX", sizeof(".XXXXXX"));
+    int fd = mkstemp(tmp);
+    if (fd < 0) {
+        free(tmp);
+        return -1;
+    }
+    FILE *fp = fchmod(fd, 0644) == 0 ? fdopen(fd, "wb") : NULL;
+    if (fp == NULL) {
+        close(fd);
+        unlink(tmp);
+        free(tmp);
+        return -1;
+    }
+    static const char zeros[SM_IMAGE_ALIGN] = {0};
+    int ret = fwrite(hdr, sizeof(sm_image_header_t), 1, fp) == 1 ? 0 : -1;
+    uint64_t pos = sizeof(sm_image_header_t);
+    for (uint32_t i = 0; i < hdr->nsec && ret == 0; i++) {
+        uint64_t pad = hdr->secs[i].off - pos;
+        uint64_t len = hdr->secs[i].len;
+        if ((pad > 0 && fwrite(zeros, 1, pad, fp) != pad) || (len > 0 && fwrite(w->data[i], 1, len, fp) != len)) {
+            ret = -1;
+        }
+        pos = hdr->secs[i].off + len;
+    }
+    // 文件末尾补齐，文件大小与hdr->size一致
+    if (ret == 0 && hdr->size > pos && fwrite(zeros, 1, hdr->size - pos, fp) != hdr->size - pos) {
+        ret = -1;
+    }
+    if (ret == 0 && (fflush(fp) != 0 || fsync(fileno(fp)) != 0)) {
+        ret = -1;
+    }
+    if (fclose(fp) != 0) {
+        ret = -1;
+    }
+    if (ret == 0 && rename(tmp, path) != 0) {
+        ret = -1;
+    }
+    if (ret != 0) {
+        unlink(tmp);
+    }
+    free(tmp);
+    return ret;
+}
+
+/**
+ * @brief 校验映像文件头和段表
+ *
+ * @param hdr    文件头
+ * @param size   文件大小
+ * @param kind   期望的对象类型
+ * @param verify 非0时校验全部段内容的校验和
+ * @return int 0:通过 -1:不通过
+ */
+static int sm_image_check(const sm_image_header_t *hdr, uint64_t size, SMImageKind kind, int verify) {
+    if (memcmp(hdr->magic, SM_IMAGE_MAGIC, sizeof(SM_IMAGE_MAGIC)) != 0 || hdr->version != SM_IMAGE_VERSION
+        || hdr->endian != SM_IMAGE_ENDIAN || hdr->kind != (uint32_t)kind || hdr->size != size
+        || hdr->nsec > SM_IMAGE_MAX_SECTIONS) {
+        return -1;
+    }
+    uint64_t checksum = 0xCBF29CE484222325ull;
+    for (uint32_t i = 0; i < hdr->nsec; i++) {
+        const sm_image_section_t *sec = &hdr->secs[i];
+        if (sec->off % SM_IMAGE_ALIGN != 0 || sec->off < sizeof(sm_image_header_t)
+            || sec->off > size || sec->len > size - sec->off) {
+            return -1;
+        }
+        checksum = verify ? sm_image_hash(checksum, (const char *)hdr + sec->off, sec->len) : checksum;
+    }
+    return !verify || checksum == hdr->checksum ? 0 : -1;
+}
+
+sm_image_t* sm_image_open(const char *path, SMImageKind kind, int verify) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(sm_image_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    // 校验和需要读取全部页面，此时预先建立映射，避免逐页缺页；不校验时页面在匹配时按需读入
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED | (verify ? MAP_POPULATE : 0), fd, 0);
+    // 映射建立后即可关闭文件描述符
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    sm_image_t *img = (sm_image_t *)malloc(sizeof(sm_image_t));
+    if (img == NULL || sm_image_check((const sm_image_header_t *)base, size, kind, verify) != 0) {
+        free(img);
+        munmap(base, size);
+        return NULL;
+    }
+    img->base = base;
+    img->size = size;
+    img->hdr = (const sm_image_header_t *)base;
+    return img;
+}
+
+const void* sm_image_section(const sm_image_t *img, int idx, uint64_t *len) {
+    if (idx < 0 || (uint32_t)idx >= img->hdr->nsec) {
+        return NULL;
+    }
+    if (len != NULL) {
+        *len = img->hdr->secs[idx].len;
+    }
+    return (const char *)img->base + img->hdr->secs[idx].off;
+}
+
+const void* sm_image_get(const sm_image_t *img, int idx, uint64_t len) {
+    uint64_t slen = 0;
+    const void *data = sm_image_section(img, idx, &slen);
+    return data != NULL && slen == len ? data : NULL;
+}
+
+void sm_image_close(sm_image_t *img) {
+    if (img != NULL) {
+        munmap(img->base, img->size);
+        free(img);
+    }
+}
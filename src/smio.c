@@ -1,11 +1,20 @@
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "smio.h"
 
 match_result_t* match_result_create(int cap) {
+    return match_result_create_ex(cap, MATCH_RESULT_FIXED);
+}
+
+match_result_t* match_result_create_ex(int cap, MatchResultMode mode) {
+    if (cap <= 0) {
+        cap = 1;
+    }
     match_result_t *result = (match_result_t *)malloc(sizeof(match_result_t));
     match_item_t *items = (match_item_t *)calloc(cap, sizeof(match_item_t));
     match_result_init(result, items, cap);
+    result->mode = mode;
     return result;
 }
 
@@ -17,16 +26,77 @@ void match_result_destroy(match_result_t *result) {
 void match_result_init(match_result_t *result, match_item_t* items, int cap) {
     result->size = 0;
     result->cap = cap;
+    result->limit = cap;
     result->items = items;
+    result->mode = MATCH_RESULT_FIXED;
+    result->dropped = 0;
+    result->stopped = 0;
+    result->sink = NULL;
+    result->ctx = NULL;
     memset(items, 0, sizeof(match_item_t) * cap);
 }
 
-int match_result_append(match_result_t *result, int plen, int pos) {
-    if (result->size >= result->cap) {
+void match_result_set_sink(match_result_t *result, match_sink_t sink, void *ctx) {
+    result->mode = MATCH_RESULT_SINK;
+    result->stopped = 0;
+    result->limit = result->cap;
+    result->sink = sink;
+    result->ctx = ctx;
+}
+
+void match_result_reset(match_result_t *result) {
+    result->size = 0;
+    result->dropped = 0;
+    result->stopped = 0;
+    result->limit = result->cap;
+}
+
+int match_result_flush(match_result_t *result) {
+    if (result->stopped) {
+        return -1;
+    }
+    if (result->mode != MATCH_RESULT_SINK || result->size == 0) {
+        return 0;
+    }
+    int size = result->size;
+    result->size = 0;
+    if (result->sink(result->items, size, result->ctx) != 0) {
+        // 停止要求保持到重置，之后的添加不再交给输出函数
+        result->stopped = 1;
+        result->limit = 0;
         return -1;
     }
-    match_item_t* item = &result->items[result->size++];
-    item->len = plen;
-    item->pos = pos;
     return 0;
-}
\ No newline at end of file
+}
+
+int match_result_reserve(match_result_t *result) {
+    if (result->stopped) {
+        return -1;
+    }
+    if (result->size < result->cap) {
+        return 0;
+    }
+    if (result->mode == MATCH_RESULT_GROW) {
+        int cap = result->cap * 2;
+        match_item_t *items = (match_item_t *)realloc(result->items, sizeof(match_item_t) * cap);
+        if (items == NULL) {
+            ++result->dropped;
+            return -1;
+        }
+        result->items = items;
+        result->cap = cap;
+        result->limit = cap;
+        return 0;
+    }
+    if (result->mode == MATCH_RESULT_SINK) {
+        return match_result_flush(result);
+    }
+    ++result->dropped;
+    return -1;
+}
+
+void match_result_print(const match_result_t *result) {
+    for (int i = 0; i < result->size; i++) {
+        printf("%lld ", (long long)result->items[i].pos);
+    }
+}
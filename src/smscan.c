@@ -0,0 +1,361 @@
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "smscan.h"
+
+int match_scanner_init(match_scanner_t *scanner, match_search_fn search, const void *engine, int max_len) {
+    if (max_len < 0 || max_len > SMSCAN_READ_SIZE) {
+        return -1;
+    }
+    scanner->search = search;
+    scanner->engine = engine;
+    scanner->max_len = max_len;
+    return 0;
+}
+
+static int smscan_trie(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return trie_search_cb((const Trie *)engine, s, slen, cb, ctx);
+}
+
+static int smscan_ac(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return ac_search_cb((const AC *)engine, s, slen, cb, ctx);
+}
+
+static int smscan_oracle(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return oracle_search_cb((const Oracle *)engine, s, slen, cb, ctx);
+}
+
+static int smscan_shift_nfa(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return shift_nfa_search_cb((const ShiftNFA *)engine, s, slen, cb, ctx);
+}
+
+static int smscan_horspool(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return horspool_trie_search_cb((const Horspool *)engine, s, slen, cb, ctx);
+}
+
+static int smscan_wum(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return wum_search_cb((const Wum *)engine, s, slen, cb, ctx);
+}
+
+static int smscan_dat(const void *engine, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return dat_search_cb((const DATrie *)engine, s, slen, cb, ctx);
+}
+
+int match_scanner_init_trie(match_scanner_t *scanner, const Trie *trie) {
+    return match_scanner_init(scanner, smscan_trie, trie, trie->depth);
+}
+
+int match_scanner_init_ac(match_scanner_t *scanner, const AC *ac) {
+    return match_scanner_init(scanner, smscan_ac, ac, ac->trie->depth);
+}
+
+int match_scanner_init_oracle(match_scanner_t *scanner, const Oracle *orc) {
+    return match_scanner_init(scanner, smscan_oracle, orc, orc->max_len);
+}
+
+int match_scanner_init_shift_nfa(match_scanner_t *scanner, const ShiftNFA *snfa) {
+    return match_scanner_init(scanner, smscan_shift_nfa, snfa, snfa->max_len);
+}
+
+int match_scanner_init_horspool(match_scanner_t *scanner, const Horspool *hsp) {
+    return match_scanner_init(scanner, smscan_horspool, hsp, hsp->trie->depth);
+}
+
+int match_scanner_init_wum(match_scanner_t *scanner, const Wum *wum) {
+    return match_scanner_init(scanner, smscan_wum, wum, wum->max_len);
+}
+
+int match_scanner_init_dat(match_scanner_t *scanner, const DATrie *dat) {
+    return match_scanner_init(scanner, smscan_dat, dat, dat->max_len);
+}
+
+/**
+ * @brief 分段匹配上下文
+ */
+typedef struct {
+    match_callback_t cb; // 用户回调函数
+    void *ctx;           // 用户回调上下文
+    int64_t base;        // 分段首字符的绝对偏移
+    int64_t bound;       // 结束位置不超过该偏移的匹配已由上一分段报告
+} smscan_filter_t;
+
+/**
+ * @brief 转换为绝对偏移，并过滤重叠区内已报告的匹配
+ */
+static int smscan_filter(const match_item_t *item, void *ctx) {
+    smscan_filter_t *filter = (smscan_filter_t *)ctx;
+    match_item_t abs_item = *item;
+    abs_item.pos += filter->base;
+    if (abs_item.pos + abs_item.len <= filter->bound) {
+        return 0;
+    }
+    return filter->cb(&abs_item, filter->ctx);
+}
+
+/**
+ * @brief 扫描一个分段
+ *
+ * @param scanner 扫描器指针
+ * @param s       分段数据
+ * @param slen    分段长度
+ * @param base    分段首字符的绝对偏移
+ * @param bound   已扫描数据的结束偏移
+ * @param cb      回调函数
+ * @param ctx     回调上下文
+ * @return int    0:扫描完成 -1:被回调终止
+ */
+static int smscan_window(const match_scanner_t *scanner, const char *s, int slen, int64_t base, int64_t bound,
+                         match_callback_t cb, void *ctx) {
+    smscan_filter_t filter = {cb, ctx, base, bound};
+    return scanner->search(scanner->engine, s, slen, smscan_filter, &filter) != 0 ? -1 : 0;
+}
+
+/**
+ * @brief 扫描数据区间，只报告结束位置在(lo, hi]内的匹配
+ * 区间起点向前扩展max_len-1字节，超过分段大小时再切分为相互重叠的分段
+ *
+ * @param scanner 扫描器指针
+ * @param s       完整数据
+ * @param lo      区间起始偏移
+ * @param hi      区间结束偏移
+ * @param cb      回调函数
+ * @param ctx     回调上下文
+ * @return int    0:扫描完成 -1:被回调终止
+ */
+static int smscan_range(const match_scanner_t *scanner, const char *s, int64_t lo, int64_t hi,
+                        match_callback_t cb, void *ctx) {
+    int overlap = scanner->max_len > 0 ? scanner->max_len - 1 : 0;
+    int64_t start = lo > overlap ? lo - overlap : 0;
+    int64_t done = lo;
+    while (done < hi) {
+        int64_t len = hi - start;
+        if (len > SMSCAN_WINDOW_SIZE) {
+            len = SMSCAN_WINDOW_SIZE;
+        }
+        if (smscan_window(scanner, s + start, (int)len, start, done, cb, ctx) != 0) {
+            return -1;
+        }
+        done = start + len;
+        start = done - overlap;
+    }
+    return 0;
+}
+
+int match_scan_buffer(const match_scanner_t *scanner, const char *s, int64_t slen, match_callback_t cb, void *ctx) {
+    return smscan_range(scanner, s, 0, slen, cb, ctx);
+}
+
+/**
+ * @brief 并行扫描任务
+ */
+typedef struct {
+    const match_scanner_t *scanner;
+    const char *s;
+    int64_t lo;             // 负责的匹配结束位置区间(lo, hi]
+    int64_t hi;
+    match_result_t *result; // 线程私有匹配结果
+    int ret;                // 扫描返回值
+} smscan_task_t;
+
+/**
+ * @brief 按匹配位置、长度、模式串id排序
+ */
+static int smscan_item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a;
+    const match_item_t *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    if (x->len != y->len) {
+        return x->len - y->len;
+    }
+    return x->id - y->id;
+}
+
+static void* smscan_worker(void *arg) {
+    smscan_task_t *task = (smscan_task_t *)arg;
+    task->ret = smscan_range(task->scanner, task->s, task->lo, task->hi, match_result_callback, task->result);
+    qsort(task->result->items, task->result->size, sizeof(match_item_t), smscan_item_cmp);
+    return NULL;
+}
+
+/**
+ * @brief 合并各线程的有序结果
+ * 线程分块远大于max_len，位置交错的匹配只出现在相邻两块的接缝处，逐个接缝做二路归并即可
+ *
+ * @param tasks    任务数组
+ * @param nthreads 线程数
+ * @param result   匹配结果
+ * @return int 0:完成 -1:输出函数要求停止
+ */
+static int smscan_merge(const smscan_task_t *tasks, int nthreads, match_result_t *result) {
+    const match_result_t *prev = tasks[0].result;
+    int ip = 0;
+    for (int i = 1; i < nthreads; i++) {
+        const match_result_t *cur = tasks[i].result;
+        int ic = 0;
+        while (ip < prev->size) {
+            const match_item_t *item = &prev->items[ip];
+            if (ic < cur->size && smscan_item_cmp(&cur->items[ic], item) < 0) {
+                item = &cur->items[ic++];
+            } else {
+                ++ip;
+            }
+            if (match_result_emit(result, item->len, item->pos, item->id) != 0) {
+                return -1;
+            }
+        }
+        prev = cur;
+        ip = ic;
+    }
+    for (; ip < prev->size; ip++) {
+        const match_item_t *item = &prev->items[ip];
+        if (match_result_emit(result, item->len, item->pos, item->id) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int match_scan_parallel(const match_scanner_t *scanner, const char *s, int64_t slen, int nthreads,
+                        match_result_t *result) {
+    if (nthreads <= 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = ncpu > 0 ? (int)ncpu : 1;
+    }
+    // 分块过小时线程开销大于收益
+    if (slen / nthreads < SMSCAN_PARALLEL_MIN_SIZE) {
+        nthreads = (int)(slen / SMSCAN_PARALLEL_MIN_SIZE);
+        if (nthreads < 1) {
+            nthreads = 1;
+        }
+    }
+    smscan_task_t *tasks = (smscan_task_t *)calloc(nthreads, sizeof(smscan_task_t));
+    pthread_t *threads = (pthread_t *)calloc(nthreads, sizeof(pthread_t));
+    if (tasks == NULL || threads == NULL) {
+        free(tasks);
+        free(threads);
+        return -1;
+    }
+    int ret = 0;
+    int started = 0;
+    int64_t chunk = (slen + nthreads - 1) / nthreads;
+    for (int i = 0; i < nthreads; i++) {
+        smscan_task_t *task = &tasks[i];
+        task->scanner = scanner;
+        task->s = s;
+        task->lo = chunk * i < slen ? chunk * i : slen;
+        task->hi = task->lo + chunk < slen ? task->lo + chunk : slen;
+        task->result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+        if (task->result == NULL) {
+            ret = -1;
+            break;
+        }
+    }
+    if (ret == 0 && nthreads == 1) {
+        smscan_worker(&tasks[0]);
+    } else if (ret == 0) {
+        for (int i = 0; ret == 0 && i < nthreads; i++) {
+            if (pthread_create(&threads[i], NULL, smscan_worker, &tasks[i]) != 0) {
+                ret = -1;
+            } else {
+                ++started;
+            }
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; ret == 0 && i < nthreads; i++) {
+        if (tasks[i].ret != 0) {
+            ret = -1;
+        }
+    }
+    if (ret == 0) {
+        ret = smscan_merge(tasks, nthreads, result);
+    }
+    for (int i = 0; i < nthreads; i++) {
+        if (tasks[i].result != NULL) {
+            match_result_destroy(tasks[i].result);
+        }
+    }
+    free(tasks);
+    free(threads);
+    return ret;
+}
+
+/**
+ * @brief 分块读取扫描，用于无法映射的输入
+ * 每块前保留上一块末尾max_len-1字节，只拷贝这部分重叠数据
+ */
+static int smscan_read(const match_scanner_t *scanner, int fd, match_callback_t cb, void *ctx) {
+    int overlap = scanner->max_len > 0 ? scanner->max_len - 1 : 0;
+    char *buf = (char *)malloc(overlap + SMSCAN_READ_SIZE);
+    if (buf == NULL) {
+        return -2;
+    }
+    int ret = 0;
+    int keep = 0;      // 缓冲区头部保留的上一块字节数
+    int64_t base = 0;  // 缓冲区首字符的绝对偏移
+    while (1) {
+        ssize_t n = read(fd, buf + keep, SMSCAN_READ_SIZE);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ret = -2;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        int len = keep + (int)n;
+        if (smscan_window(scanner, buf, len, base, base + keep, cb, ctx) != 0) {
+            ret = -1;
+            break;
+        }
+        int tlen = len < overlap ? len : overlap;
+        memmove(buf, buf + len - tlen, tlen);
+        base += len - tlen;
+        keep = tlen;
+    }
+    free(buf);
+    return ret;
+}
+
+int match_scan_fd(const match_scanner_t *scanner, int fd, match_callback_t cb, void *ctx) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return -2;
+    }
+    // 管道、空文件及超出地址空间的文件分块读取
+    if (!S_ISREG(st.st_mode) || st.st_size == 0 || (uint64_t)st.st_size > SIZE_MAX) {
+        return smscan_read(scanner, fd, cb, ctx);
+    }
+    size_t size = (size_t)st.st_size;
+    void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        return smscan_read(scanner, fd, cb, ctx);
+    }
+    posix_madvise(addr, size, POSIX_MADV_SEQUENTIAL);
+    int ret = match_scan_buffer(scanner, (const char *)addr, (int64_t)size, cb, ctx);
+    munmap(addr, size);
+    return ret;
+}
+
+int match_scan_file(const match_scanner_t *scanner, const char *path, match_callback_t cb, void *ctx) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -2;
+    }
+    int ret = match_scan_fd(scanner, fd, cb, ctx);
+    close(fd);
+    return ret;
+}
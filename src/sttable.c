@@ -2,17 +2,31 @@
 #include <stdlib.h>
 #include "sttable.h"
 #include "trie.h"
+#include "internal/sttable_get.h"
 #include "internal/sttable_list.h"
 #include "internal/sttable_array.h"
 #include "internal/sttable_hasht.h"
 #include "internal/sttable_dbarr.h"
+#include "internal/sttable_ohash.h"
+#include "internal/sttable_bitmap.h"
+#include "internal/sttable_hybrid.h"
 
 sttable_t* sttable_create(STTableType type) {
     sttable_t *tbl = (sttable_t *)malloc(sizeof(sttable_t));
     memset(tbl, 0, sizeof(sttable_t));
     tbl->type = type;
-    if (type == STTABLE_TYPE_ARRAY) {
+    if (type == STTABLE_TYPE_LIST) {
+        tbl->lst.nsize = DEFAULT_STATE_NUM;
+        tbl->lst.nodes = (sttable_list_node_t *)calloc(DEFAULT_STATE_NUM, sizeof(sttable_list_node_t));
+        tbl->lst.tsize = STTABLE_LIST_DEFAULT_SIZE;
+        tbl->lst.chars = (uint8_t *)calloc(STTABLE_LIST_DEFAULT_SIZE + STTABLE_LIST_PAD, 1);
+        tbl->lst.tids = (int *)malloc(sizeof(int) * STTABLE_LIST_DEFAULT_SIZE);
+    } else if (type == STTABLE_TYPE_ARRAY) {
         tbl->ast.size = STTABLE_DEFAULT_ARRAY_SIZE;
+        tbl->ast.cnum = CHARSET_SIZE;
+        for (int c = 0; c < CHARSET_SIZE; c++) {
+            tbl->ast.cls[c] = (uint8_t)c;
+        }
         tbl->ast.stt = (int *)calloc(STTABLE_DEFAULT_ARRAY_SIZE, sizeof(int));
         memset(tbl->ast.stt, -1, STTABLE_DEFAULT_ARRAY_SIZE * sizeof(int));
     } else if (type == STTABLE_TYPE_HASHT) {
@@ -29,57 +43,411 @@ sttable_t* sttable_create(STTableType type) {
         tbl->dst.base = (int *)malloc(sizeof(int) * DEFAULT_STATE_NUM);
         memset(tbl->dst.base, 0, sizeof(int) * DEFAULT_STATE_NUM);
         tbl->dst.tsize = STTABLE_DBARR_DEFAULT_SIZE;
-        tbl->dst.target = (int *)malloc(sizeof(int) * STTABLE_DBARR_DEFAULT_SIZE);
-        memset(tbl->dst.target, 0, sizeof(int) * STTABLE_DBARR_DEFAULT_SIZE);
+        tbl->dst.cells = (sttable_dbarr_cell_t *)malloc(sizeof(sttable_dbarr_cell_t) * STTABLE_DBARR_DEFAULT_SIZE);
+        memset(tbl->dst.cells, -1, sizeof(sttable_dbarr_cell_t) * STTABLE_DBARR_DEFAULT_SIZE);
+        dbfree_init(&tbl->dst.free, STTABLE_DBARR_DEFAULT_SIZE);
+    } else if (type == STTABLE_TYPE_OHASH) {
+        if (sttable_ohash_alloc(&tbl->ost, STTABLE_OHASH_DEFAULT_BITS) != 0) {
+            free(tbl);
+            return NULL;
+        }
+    } else if (type == STTABLE_TYPE_BITMAP) {
+        sttable_bitmap_init(&tbl->bst);
+    } else if (type == STTABLE_TYPE_HYBRID) {
+        sttable_bitmap_init(&tbl->yst.sparse);
     } else {}
     return tbl;
 }
 
 void sttable_destroy(sttable_t *tbl) {
     if (tbl != NULL) {
-        if (tbl->type == STTABLE_TYPE_ARRAY) {
+        if (tbl->mapped) {
+            // 数组由映像的所有者解除映射
+        } else if (tbl->type == STTABLE_TYPE_LIST) {
+            free(tbl->lst.nodes);
+            free(tbl->lst.chars);
+            free(tbl->lst.tids);
+        } else if (tbl->type == STTABLE_TYPE_ARRAY) {
             free(tbl->ast.stt);
+            free(tbl->ast.stt16);
         } else if (tbl->type == STTABLE_TYPE_HASHT) {
             free(tbl->hst.lists);
             free(tbl->hst.nodes);
         } else if (tbl->type == STTABLE_TYPE_DBARR) {
             free(tbl->dst.base);
-            free(tbl->dst.target);
+            free(tbl->dst.cells);
+            dbfree_destroy(&tbl->dst.free);
+        } else if (tbl->type == STTABLE_TYPE_OHASH) {
+            free(tbl->ost.mem);
+        } else if (tbl->type == STTABLE_TYPE_BITMAP) {
+            free(tbl->bst.nodes);
+            free(tbl->bst.tids);
+        } else if (tbl->type == STTABLE_TYPE_HYBRID) {
+            free(tbl->yst.sparse.nodes);
+            free(tbl->yst.sparse.tids);
+            free(tbl->yst.dense);
+            free(tbl->yst.dflt);
         } else {}
         free(tbl);
     }
 }
 
 int sttable_set(sttable_t *tbl, int fid, char c, int tid) {
+    if (tbl->mapped) {
+        return -1;
+    }
     switch (tbl->type) {
         case STTABLE_TYPE_ARRAY:
+            if (sttable_widen(tbl) != 0) {
+                return -1;
+            }
+            // 等价类0的字节共用一项，单独设置其中一个字节时需先展开
+            if (tbl->ast.cls[(unsigned char)c] == 0 && tbl->ast.cnum < CHARSET_SIZE
+                && sttable_array_expand(&tbl->ast) != 0) {
+                return -1;
+            }
             return sttable_array_set(&tbl->ast, fid, c, tid);
         case STTABLE_TYPE_HASHT:
             return sttable_hasht_set(&tbl->hst, fid, c, tid);
         case STTABLE_TYPE_LIST:
-            return 0;
+            return sttable_list_set(&tbl->lst, fid, c, tid);
         case STTABLE_TYPE_DBARR:
             return sttable_dbarr_set(&tbl->dst, fid, c, tid);
+        case STTABLE_TYPE_OHASH:
+            return sttable_ohash_set(&tbl->ost, fid, c, tid);
+        case STTABLE_TYPE_BITMAP:
+            return sttable_bitmap_set(&tbl->bst, fid, c, tid);
+        case STTABLE_TYPE_HYBRID:
+            return sttable_hybrid_set(&tbl->yst, fid, c, tid);
         default:
             return -1;
     }
 }
 
 int sttable_get(sttable_t *tbl, int id, char c) {
+    return sttable_get_typed(tbl, sttable_inst_type(tbl), id, c);
+}
+
+void sttable_copy(sttable_t *tbl, int fid, int tid) {
+    int cnum = tbl->ast.cnum;
+    memcpy(&tbl->ast.stt[tid * cnum], &tbl->ast.stt[fid * cnum], sizeof(int) * cnum);
+}
+
+void sttable_reset_row(sttable_t *tbl, int id) {
+    memset(&tbl->ast.stt[id * tbl->ast.cnum], 0, sizeof(int) * tbl->ast.cnum);
+}
+
+int sttable_inherit(sttable_t *tbl, int id, int fid) {
+    if (tbl->type != STTABLE_TYPE_HYBRID) {
+        return -1;
+    }
+    return sttable_hybrid_inherit(&tbl->yst, id, fid);
+}
+
+int sttable_compress(sttable_t *tbl, const uint8_t *cls, int cnum, int state_num) {
+    if (tbl->type != STTABLE_TYPE_ARRAY || cnum >= CHARSET_SIZE) {
+        return 0;
+    }
+    if (tbl->mapped) {
+        return -1;
+    }
+    if (sttable_widen(tbl) != 0 || sttable_array_expand(&tbl->ast) != 0) {
+        return -1;
+    }
+    // 每个等价类取第一个字节作为代表
+    int rep[CHARSET_SIZE];
+    for (int c = CHARSET_SIZE - 1; c >= 0; c--) {
+        rep[cls[c]] = c;
+    }
+    // 从前向后原地压缩，每行先读入缓冲区，写入位置不超过当前行的起点之后
+    int *stt = tbl->ast.stt;
+    int row[CHARSET_SIZE];
+    for (int i = 0; i < state_num; i++) {
+        for (int k = 0; k < cnum; k++) {
+            row[k] = stt[i * CHARSET_SIZE + rep[k]];
+        }
+        memcpy(stt + i * cnum, row, sizeof(int) * cnum);
+    }
+    int size = state_num * cnum;
+    int *shrunk = (int *)realloc(stt, sizeof(int) * size);
+    tbl->ast.stt = shrunk != NULL ? shrunk : stt;
+    tbl->ast.size = size;
+    tbl->ast.cnum = cnum;
+    memcpy(tbl->ast.cls, cls, CHARSET_SIZE);
+    return 0;
+}
+
+int sttable_narrow(sttable_t *tbl, int state_num) {
+    if (tbl->type != STTABLE_TYPE_ARRAY || tbl->mapped || tbl->ast.stt16 != NULL || state_num >= STTABLE_ARRAY16_NONE) {
+        return 0;
+    }
+    // 原地转换，第i项的16位写入位置不超过32位第i项的读取位置，构建期峰值内存不增加
+    int size = state_num * tbl->ast.cnum;
+    int *stt = tbl->ast.stt;
+    for (int i = 0; i < size; i++) {
+        uint16_t tid = stt[i] == -1 ? STTABLE_ARRAY16_NONE : (uint16_t)stt[i];
+        memcpy((char *)stt + i * sizeof(uint16_t), &tid, sizeof(uint16_t));
+    }
+    // 只保留已有状态的转移，收缩失败时原内存仍然有效
+    uint16_t *stt16 = (uint16_t *)realloc(stt, sizeof(uint16_t) * size);
+    tbl->ast.stt16 = stt16 != NULL ? stt16 : (uint16_t *)stt;
+    tbl->ast.stt = NULL;
+    tbl->ast.size = size;
+    return 0;
+}
+
+int sttable_widen(sttable_t *tbl) {
+    if (tbl->type != STTABLE_TYPE_ARRAY || tbl->ast.stt16 == NULL) {
+        return 0;
+    }
+    if (tbl->mapped) {
+        return -1;
+    }
+    // 恢复时至少保留默认状态数的容量，避免随后的插入立即扩容
+    int size = tbl->ast.size;
+    if (size < tbl->ast.cnum * DEFAULT_STATE_NUM) {
+        size = tbl->ast.cnum * DEFAULT_STATE_NUM;
+    }
+    int *stt = (int *)realloc(tbl->ast.stt16, sizeof(int) * size);
+    if (stt == NULL) {
+        return -1;
+    }
+    // 从后向前原地转换，避免覆盖尚未读取的16位项
+    for (int i = size - 1; i >= 0; i--) {
+        uint16_t tid = STTABLE_ARRAY16_NONE;
+        if (i < tbl->ast.size) {
+            memcpy(&tid, (char *)stt + i * sizeof(uint16_t), sizeof(uint16_t));
+        }
+        stt[i] = tid == STTABLE_ARRAY16_NONE ? -1 : tid;
+    }
+    tbl->ast.stt16 = NULL;
+    tbl->ast.stt = stt;
+    tbl->ast.size = size;
+    return 0;
+}
+
+/**
+ * @brief 按map原地置换数组元素，第i个元素移到第map[i]个位置
+ * 
+ * @param base  数组
+ * @param esize 元素大小，不超过CHARSET_SIZE个int
+ * @param n     元素数
+ * @param map   置换
+ * @param done  n个字节的标记，须全为0，返回时被改写
+ */
+static void sttable_permute(void *base, size_t esize, int n, const int *map, uint8_t *done) {
+    char bufs[2][CHARSET_SIZE * sizeof(int)];
+    char *elems = (char *)base;
+    for (int i = 0; i < n; i++) {
+        if (done[i] || map[i] == i) {
+            continue;
+        }
+        // 沿置换环依次放置，cur保存待放置的元素
+        char *cur = bufs[0], *tmp = bufs[1];
+        memcpy(cur, elems + esize * i, esize);
+        int j = i;
+        do {
+            int t = map[j];
+            memcpy(tmp, elems + esize * t, esize);
+            memcpy(elems + esize * t, cur, esize);
+            char *swap = cur;
+            cur = tmp;
+            tmp = swap;
+            done[t] = 1;
+            j = t;
+        } while (j != i);
+    }
+}
+
+int sttable_renumber(sttable_t *tbl, const int *map, int state_num) {
+    if ((tbl->type != STTABLE_TYPE_ARRAY && tbl->type != STTABLE_TYPE_HYBRID) || tbl->mapped) {
+        return -1;
+    }
+    uint8_t *done = (uint8_t *)calloc(state_num > 0 ? state_num : 1, 1);
+    if (done == NULL || sttable_widen(tbl) != 0) {
+        free(done);
+        return -1;
+    }
+    if (tbl->type == STTABLE_TYPE_ARRAY) {
+        int cnum = tbl->ast.cnum;
+        int *stt = tbl->ast.stt;
+        for (int i = 0; i < state_num * cnum; i++) {
+            stt[i] = stt[i] != -1 ? map[stt[i]] : -1;
+        }
+        sttable_permute(stt, sizeof(int) * cnum, state_num, map, done);
+    } else {
+        struct _sttable_hybrid_s *yst = &tbl->yst;
+        // 目标状态段中只有前num项有效，段内其余项和废弃段可能是任意值
+        for (int id = 0; id < state_num; id++) {
+            const sttable_bitmap_node_t *node = &yst->sparse.nodes[id];
+            if (node->off >= 0) {
+                int *tids = yst->sparse.tids + node->off;
+                for (int k = sttable_bitmap_num(node) - 1; k >= 0; k--) {
+                    tids[k] = map[tids[k]];
+                }
+            }
+        }
+        for (int i = 0; i < yst->rnum * CHARSET_SIZE; i++) {
+            yst->dense[i] = yst->dense[i] != -1 ? map[yst->dense[i]] : -1;
+        }
+        sttable_permute(yst->sparse.nodes, sizeof(sttable_bitmap_node_t), state_num, map, done);
+        if (yst->dflt != NULL) {
+            memset(done, 0, state_num);
+            sttable_permute(yst->dflt, sizeof(int), state_num, map, done);
+        }
+    }
+    free(done);
+    return 0;
+}
+
+int sttable_image_put(const sttable_t *tbl, sm_image_writer_t *w, sttable_image_t *meta) {
+    memset(meta, 0, sizeof(sttable_image_t));
+    memset(meta->sec, -1, sizeof(meta->sec));
+    meta->type = tbl->type;
     switch (tbl->type) {
-        case STTABLE_TYPE_ARRAY: 
-            return sttable_array_get(&tbl->ast, id, c);
-        case STTABLE_TYPE_HASHT:
-            return sttable_hasht_get(&tbl->hst, id, c);
-        case STTABLE_TYPE_LIST:
-            return sttable_list_get(&tbl->lst, id, c);
-        case STTABLE_TYPE_DBARR:
-            return sttable_dbarr_get(&tbl->dst, id, c);
+        case STTABLE_TYPE_LIST: {
+            // 只保存已分配的转移，字符数组保留末尾填充
+            const struct _sttable_list_s *lst = &tbl->lst;
+            meta->num[0] = lst->nsize;
+            meta->num[1] = lst->tused;
+            meta->sec[0] = sm_image_add(w, lst->nodes, sizeof(sttable_list_node_t) * lst->nsize);
+            meta->sec[1] = sm_image_add(w, lst->chars, lst->tused + STTABLE_LIST_PAD);
+            meta->sec[2] = sm_image_add(w, lst->tids, sizeof(int) * lst->tused);
+            break;
+        }
+        case STTABLE_TYPE_ARRAY: {
+            const struct _sttable_array_s *ast = &tbl->ast;
+            meta->num[0] = ast->size;
+            meta->num[1] = ast->cnum;
+            meta->num[2] = ast->stt16 != NULL;
+            if (ast->stt16 != NULL) {
+                meta->sec[0] = sm_image_add(w, ast->stt16, sizeof(uint16_t) * ast->size);
+            } else {
+                meta->sec[0] = sm_image_add(w, ast->stt, sizeof(int) * ast->size);
+            }
+            meta->sec[1] = sm_image_add(w, ast->cls, CHARSET_SIZE);
+            break;
+        }
+        case STTABLE_TYPE_DBARR: {
+            const struct _sttable_dbarr_s *dst = &tbl->dst;
+            meta->num[0] = dst->bsize;
+            meta->num[1] = dst->tsize;
+            meta->sec[0] = sm_image_add(w, dst->base, sizeof(int) * dst->bsize);
+            meta->sec[1] = sm_image_add(w, dst->cells, sizeof(sttable_dbarr_cell_t) * dst->tsize);
+            break;
+        }
+        case STTABLE_TYPE_OHASH: {
+            const struct _sttable_ohash_s *ost = &tbl->ost;
+            meta->num[0] = ost->bits;
+            meta->num[1] = ost->size;
+            meta->num[2] = ost->max_probe;
+            meta->sec[0] = sm_image_add(w, ost->buckets, sizeof(sttable_ohash_bucket_t) << ost->bits);
+            break;
+        }
+        case STTABLE_TYPE_BITMAP: {
+            const struct _sttable_bitmap_s *bst = &tbl->bst;
+            meta->num[0] = bst->nsize;
+            meta->num[1] = bst->tused;
+            meta->sec[0] = sm_image_add(w, bst->nodes, sizeof(sttable_bitmap_node_t) * bst->nsize);
+            meta->sec[1] = sm_image_add(w, bst->tids, sizeof(int) * bst->tused);
+            break;
+        }
+        case STTABLE_TYPE_HYBRID: {
+            const struct _sttable_hybrid_s *yst = &tbl->yst;
+            meta->num[0] = yst->sparse.nsize;
+            meta->num[1] = yst->sparse.tused;
+            meta->num[2] = yst->rnum;
+            meta->num[3] = yst->dflt != NULL;
+            meta->sec[0] = sm_image_add(w, yst->sparse.nodes, sizeof(sttable_bitmap_node_t) * yst->sparse.nsize);
+            meta->sec[1] = sm_image_add(w, yst->sparse.tids, sizeof(int) * yst->sparse.tused);
+            meta->sec[2] = sm_image_add(w, yst->dense, sizeof(int) * CHARSET_SIZE * yst->rnum);
+            if (yst->dflt != NULL) {
+                meta->sec[3] = sm_image_add(w, yst->dflt, sizeof(int) * yst->sparse.nsize);
+            }
+            break;
+        }
         default:
             return -1;
     }
+    return 0;
 }
 
-void sttable_copy(sttable_t *tbl, int fid, int tid) {
-    memcpy(&tbl->ast.stt[tid * CHARSET_SIZE], &tbl->ast.stt[fid * CHARSET_SIZE], sizeof(int) * CHARSET_SIZE);
-}
\ No newline at end of file
+sttable_t* sttable_image_get(const sm_image_t *img, const sttable_image_t *meta) {
+    sttable_t *tbl = (sttable_t *)calloc(1, sizeof(sttable_t));
+    if (tbl == NULL) {
+        return NULL;
+    }
+    tbl->type = (STTableType)meta->type;
+    tbl->mapped = 1;
+    const int32_t *num = meta->num;
+    const int32_t *sec = meta->sec;
+    // 映像只读，数组指针去掉const后仍不能写入
+    int ok = 0;
+    if (num[0] < 0 || num[1] < 0 || num[2] < 0) {
+        ok = 0;
+    } else if (tbl->type == STTABLE_TYPE_LIST) {
+        struct _sttable_list_s *lst = &tbl->lst;
+        lst->nsize = num[0];
+        lst->tsize = lst->tused = num[1];
+        lst->nodes = (sttable_list_node_t *)sm_image_get(img, sec[0], sizeof(sttable_list_node_t) * (uint64_t)num[0]);
+        lst->chars = (uint8_t *)sm_image_get(img, sec[1], (uint64_t)num[1] + STTABLE_LIST_PAD);
+        lst->tids = (int *)sm_image_get(img, sec[2], sizeof(int) * (uint64_t)num[1]);
+        ok = lst->nodes != NULL && lst->chars != NULL && lst->tids != NULL;
+    } else if (tbl->type == STTABLE_TYPE_ARRAY) {
+        struct _sttable_array_s *ast = &tbl->ast;
+        ast->size = num[0];
+        ast->cnum = num[1];
+        const uint8_t *cls = (const uint8_t *)sm_image_get(img, sec[1], CHARSET_SIZE);
+        if (num[2]) {
+            ast->stt16 = (uint16_t *)sm_image_get(img, sec[0], sizeof(uint16_t) * (uint64_t)num[0]);
+        } else {
+            ast->stt = (int *)sm_image_get(img, sec[0], sizeof(int) * (uint64_t)num[0]);
+        }
+        if (cls != NULL) {
+            memcpy(ast->cls, cls, CHARSET_SIZE);
+        }
+        ok = cls != NULL && (ast->stt != NULL || ast->stt16 != NULL) && ast->cnum > 0 && ast->cnum <= CHARSET_SIZE;
+    } else if (tbl->type == STTABLE_TYPE_DBARR) {
+        struct _sttable_dbarr_s *dst = &tbl->dst;
+        dst->bsize = num[0];
+        dst->tsize = num[1];
+        dst->base = (int *)sm_image_get(img, sec[0], sizeof(int) * (uint64_t)num[0]);
+        dst->cells = (sttable_dbarr_cell_t *)sm_image_get(img, sec[1], sizeof(sttable_dbarr_cell_t) * (uint64_t)num[1]);
+        ok = dst->base != NULL && dst->cells != NULL;
+    } else if (tbl->type == STTABLE_TYPE_OHASH) {
+        struct _sttable_ohash_s *ost = &tbl->ost;
+        ost->bits = num[0];
+        ost->size = num[1];
+        ost->max_probe = num[2];
+        if (num[0] < 31) {
+            ost->buckets = (sttable_ohash_bucket_t *)sm_image_get(img, sec[0], sizeof(sttable_ohash_bucket_t) << num[0]);
+        }
+        ok = ost->buckets != NULL;
+    } else if (tbl->type == STTABLE_TYPE_BITMAP) {
+        struct _sttable_bitmap_s *bst = &tbl->bst;
+        bst->nsize = num[0];
+        bst->tsize = bst->tused = num[1];
+        bst->nodes = (sttable_bitmap_node_t *)sm_image_get(img, sec[0], sizeof(sttable_bitmap_node_t) * (uint64_t)num[0]);
+        bst->tids = (int *)sm_image_get(img, sec[1], sizeof(int) * (uint64_t)num[1]);
+        ok = bst->nodes != NULL && bst->tids != NULL;
+    } else if (tbl->type == STTABLE_TYPE_HYBRID) {
+        struct _sttable_hybrid_s *yst = &tbl->yst;
+        yst->sparse.nsize = num[0];
+        yst->sparse.tsize = yst->sparse.tused = num[1];
+        yst->rsize = yst->rnum = num[2];
+        yst->sparse.nodes = (sttable_bitmap_node_t *)sm_image_get(img, sec[0],
+                                                                  sizeof(sttable_bitmap_node_t) * (uint64_t)num[0]);
+        yst->sparse.tids = (int *)sm_image_get(img, sec[1], sizeof(int) * (uint64_t)num[1]);
+        yst->dense = (int *)sm_image_get(img, sec[2], sizeof(int) * CHARSET_SIZE * (uint64_t)num[2]);
+        if (num[3]) {
+            yst->dflt = (int *)sm_image_get(img, sec[3], sizeof(int) * (uint64_t)num[0]);
+        }
+        ok = yst->sparse.nodes != NULL && yst->sparse.tids != NULL && yst->dense != NULL
+             && (!num[3] || yst->dflt != NULL);
+    }
+    if (!ok) {
+        free(tbl);
+        return NULL;
+    }
+    return tbl;
+}
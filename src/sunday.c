@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include "xssm.h"
 
 /**
@@ -11,21 +12,56 @@ static void build_shift(int shift[], const char *p, int plen) {
 	for (int i = 0; i < CHARSET_SIZE; i++)
 		shift[i] = plen + 1;
 	for (int i = 0; i < plen; i++) {
-		shift[p[i]] = plen - i;
+		shift[(unsigned char)p[i]] = plen - i;
 	}
 }
 
-void sunday_search(const char *s, const char *p, int slen, int plen) {
-	int shift[CHARSET_SIZE];
-	build_shift(shift, p, plen);
+sunday_pattern_t* sunday_pattern_create(const char *p, int plen) {
+	if (plen <= 0) {
+		return NULL;
+	}
+	sunday_pattern_t *sd = (sunday_pattern_t *)malloc(sizeof(sunday_pattern_t));
+	sd->plen = plen;
+	sd->p = (char *)malloc(plen);
+	memcpy(sd->p, p, plen);
+	build_shift(sd->shift, sd->p, plen);
+	return sd;
+}
+
+void sunday_pattern_destroy(sunday_pattern_t *sd) {
+	if (sd != NULL) {
+		free(sd->p);
+		free(sd);
+	}
+}
+
+void sunday_pattern_search(const sunday_pattern_t *sd, const char *s, int slen, match_result_t *result) {
+	const char *p = sd->p;
+	int plen = sd->plen;
 	int i = 0; //窗口位置
 	int j = 0; //窗口内字符位置
 	while(i <= slen - plen) {
 		for(j = 0; j < plen && s[i + j] == p[j]; j++);
 		if(j == plen) {
-			printf("%d ", i);
+			if (match_result_emit(result, plen, i, 0) != 0) {
+				return;
+			}
+		}
+		if (i + plen >= slen) {
+			break;
 		}
-		//可能会越界访问s[slen]，不过并不会影响结果
-		i += shift[s[i + plen]];
+		i += sd->shift[(unsigned char)s[i + plen]];
+	}
+}
+
+void sunday_search(const char *s, const char *p, int slen, int plen) {
+	sunday_pattern_t *sd = sunday_pattern_create(p, plen);
+	if (sd == NULL) {
+		return;
 	}
+	match_result_t *result = match_result_create_ex(MATCH_RESULT_DEFAULT_CAP, MATCH_RESULT_GROW);
+	sunday_pattern_search(sd, s, slen, result);
+	match_result_print(result);
+	match_result_destroy(result);
+	sunday_pattern_destroy(sd);
 }
\ No newline at end of file
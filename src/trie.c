@@ -1,6 +1,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include "trie.h"
+#include "internal/sttable_get.h"
+
+/**
+ * @brief 需要访问trie树的状态转移表记录树指针
+ * 
+ * @param trie 树指针
+ */
+static void trie_bind_sttable(Trie *trie) {
+    if (trie->sttbl->type == STTABLE_TYPE_DBARR) {
+        trie->sttbl->dst.trie = trie;
+    }
+    if (trie->sttbl->type == STTABLE_TYPE_HYBRID) {
+        trie->sttbl->yst.trie = trie;
+    }
+}
 
 Trie* trie_create(STTableType sttype) {
     Trie* trie = (Trie*)malloc(sizeof(Trie));
@@ -11,12 +26,7 @@ Trie* trie_create(STTableType sttype) {
     trie->sttbl = sttable_create(sttype);
     trie->states = (TrieState*)calloc(DEFAULT_STATE_NUM, sizeof(TrieState));
     memset(trie->states, 0, sizeof(TrieState) * DEFAULT_STATE_NUM);
-    if (sttype == STTABLE_TYPE_LIST) {
-        trie->sttbl->lst.trie = trie;
-    }
-    if (sttype == STTABLE_TYPE_DBARR) {
-        trie->sttbl->dst.trie = trie;
-    }
+    trie_bind_sttable(trie);
     return trie;
 }
 
@@ -25,12 +35,17 @@ Trie* trie_create_ex(const char **patterns, int pnum, STTableType sttype) {
     for (int i = 0; i < pnum; i++) {
         trie_insert(trie, patterns[i], strlen(patterns[i]));
     }
+    // 模式串已全部插入，数组实现可收缩为16位状态ID
+    sttable_narrow(trie->sttbl, trie->state_num);
     return trie;
 }
 
 void trie_destroy(Trie *trie) {
-    free(trie->states);
+    if (trie->image == NULL) {
+        free(trie->states);
+    }
     sttable_destroy(trie->sttbl);
+    sm_image_close(trie->image);
     free(trie);
 }
 
@@ -62,6 +77,9 @@ int* trie_make_bfs(Trie* trie) {
     int top = 0;
     int next = 1;
     int *bfs = (int *)malloc(sizeof(int) * trie->state_num);
+    if (bfs == NULL) {
+        return NULL;
+    }
     memset(bfs, 0, sizeof(int) * trie->state_num);
     while (next < trie->state_num) {
         int id = trie->states[bfs[top]].first;
@@ -74,21 +92,226 @@ int* trie_make_bfs(Trie* trie) {
     return bfs;
 }
 
-void trie_search(const Trie *trie, const char *s, int slen, match_result_t* result) {
+int trie_compress(Trie *trie) {
+    if (trie->sttbl->type != STTABLE_TYPE_ARRAY) {
+        return 0;
+    }
+    uint8_t used[CHARSET_SIZE] = {0};
+    for (int i = 1; i < trie->state_num; i++) {
+        used[(unsigned char)trie->states[i].c] = 1;
+    }
+    // 等价类0留给未出现的字节，其余按字节值依次编号，全部字节都出现时cnum超过CHARSET_SIZE，不压缩
+    uint8_t cls[CHARSET_SIZE];
+    int cnum = 1;
+    for (int c = 0; c < CHARSET_SIZE; c++) {
+        cls[c] = used[c] ? (uint8_t)cnum++ : 0;
+    }
+    return sttable_compress(trie->sttbl, cls, cnum, trie->state_num);
+}
+
+int trie_relayout(Trie *trie, int *map) {
+    if (trie->image != NULL) {
+        return -1;
+    }
+    int num = trie->state_num;
+    int *bfs_ids = trie_make_bfs(trie);
+    int *ids = map != NULL ? map : (int *)malloc(sizeof(int) * num);
+    TrieState *states = (TrieState *)calloc(trie->size, sizeof(TrieState));
+    sttable_t *sttbl = sttable_create(trie->sttbl->type);
+    if (bfs_ids == NULL || ids == NULL || states == NULL || sttbl == NULL) {
+        free(bfs_ids);
+        if (ids != map) {
+            free(ids);
+        }
+        free(states);
+        sttable_destroy(sttbl);
+        return -1;
+    }
+    for (int i = 0; i < num; i++) {
+        ids[bfs_ids[i]] = i;
+    }
+    int compressed = trie->sttbl->type == STTABLE_TYPE_ARRAY && trie->sttbl->ast.cnum < CHARSET_SIZE;
+    Trie old = *trie;
+    trie->states = states;
+    trie->sttbl = sttbl;
+    trie_bind_sttable(trie);
+    for (int i = 0; i < num; i++) {
+        states[i].is_fin = old.states[bfs_ids[i]].is_fin;
+        states[i].pid = old.states[bfs_ids[i]].pid;
+    }
+    // 同一父节点的子节点编号连续，按组倒序插入到子节点链表头部，保持原有的兄弟顺序；
+    // 每插入一个状态即设置其转移，与插入模式串时状态转移表看到的树结构一致
+    int ret = 0;
+    for (int i = 1, j = 1; i < num && ret == 0; i = j) {
+        int parent = old.states[bfs_ids[i]].parent;
+        while (j < num && old.states[bfs_ids[j]].parent == parent) {
+            j++;
+        }
+        for (int k = j - 1; k >= i && ret == 0; k--) {
+            char c = old.states[bfs_ids[k]].c;
+            trie_insert_new_state(trie, ids[parent], k, c);
+            ret = sttable_set(sttbl, ids[parent], c, k);
+        }
+    }
+    if (ret == 0 && compressed) {
+        ret = trie_compress(trie);
+    }
+    free(bfs_ids);
+    if (ids != map) {
+        free(ids);
+    }
+    if (ret != 0) {
+        sttable_destroy(sttbl);
+        free(states);
+        *trie = old;
+        return -1;
+    }
+    sttable_destroy(old.sttbl);
+    free(old.states);
+    sttable_narrow(trie->sttbl, num);
+    return 0;
+}
+
+int trie_renumber(Trie *trie, const int *map) {
+    int num = trie->state_num;
+    TrieState *states = (TrieState *)malloc(sizeof(TrieState) * trie->size);
+    if (states == NULL || trie->image != NULL || sttable_renumber(trie->sttbl, map, num) != 0) {
+        free(states);
+        return -1;
+    }
+    // 子节点和兄弟节点以0表示不存在，初始状态编号不变
+    for (int i = 0; i < num; i++) {
+        TrieState state = trie->states[i];
+        state.parent = map[state.parent];
+        state.first = map[state.first];
+        state.next = map[state.next];
+        states[map[i]] = state;
+    }
+    free(trie->states);
+    trie->states = states;
+    return 0;
+}
+
+int trie_image_put(const Trie *trie, sm_image_writer_t *w, trie_image_t *meta) {
+    meta->depth = trie->depth;
+    meta->state_num = trie->state_num;
+    meta->fin_state_num = trie->fin_state_num;
+    meta->id_num = trie->id_num;
+    meta->states = sm_image_add(w, trie->states, sizeof(TrieState) * trie->state_num);
+    return sttable_image_put(trie->sttbl, w, &meta->sttbl);
+}
+
+Trie* trie_image_get(sm_image_t *img, const trie_image_t *meta) {
+    const TrieState *states = NULL;
+    if (meta->state_num > 0) {
+        states = (const TrieState *)sm_image_get(img, meta->states, sizeof(TrieState) * (uint64_t)meta->state_num);
+    }
+    sttable_t *sttbl = states != NULL ? sttable_image_get(img, &meta->sttbl) : NULL;
+    Trie *trie = sttbl != NULL ? (Trie *)calloc(1, sizeof(Trie)) : NULL;
+    if (trie == NULL) {
+        sttable_destroy(sttbl);
+        return NULL;
+    }
+    trie->size = meta->state_num;
+    trie->depth = meta->depth;
+    trie->state_num = meta->state_num;
+    trie->fin_state_num = meta->fin_state_num;
+    trie->id_num = meta->id_num;
+    trie->states = (TrieState *)states;
+    trie->sttbl = sttbl;
+    trie->image = img;
+    trie_bind_sttable(trie);
+    return trie;
+}
+
+int trie_save(const Trie *trie, const char *path) {
+    sm_image_writer_t w;
+    trie_image_t meta;
+    sm_image_writer_init(&w, SM_IMAGE_TRIE);
+    // 记录放在段0，写入文件时才读取，因此可以在加入各数组之后填写
+    sm_image_add(&w, &meta, sizeof(meta));
+    if (trie_image_put(trie, &w, &meta) != 0) {
+        return -1;
+    }
+    return sm_image_write(&w, path);
+}
+
+Trie* trie_load(const char *path, int verify) {
+    sm_image_t *img = sm_image_open(path, SM_IMAGE_TRIE, verify);
+    if (img == NULL) {
+        return NULL;
+    }
+    const trie_image_t *meta = (const trie_image_t *)sm_image_get(img, 0, sizeof(trie_image_t));
+    Trie *trie = meta != NULL ? trie_image_get(img, meta) : NULL;
+    if (trie == NULL) {
+        sm_image_close(img);
+    }
+    return trie;
+}
+
+/**
+ * @brief trie树多模匹配主循环
+ * 
+ * @param trie 树指针
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param type 状态转移表类型，以常量实例化
+ * @param cb   回调函数
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int trie_search_core(const Trie *trie, const char *s, int slen, STTableType type,
+                               match_callback_t cb, void *ctx) {
+    const sttable_t *tbl = trie->sttbl;
     const TrieState* state = NULL;
     for (int i = 0; i < slen; i++) {
         int state_id = 0;
         int j = i;
-        while (j < slen && (state_id = trie_get_trans(trie, state_id, s[j])) != -1) {
+        while (j < slen && (state_id = sttable_get_typed(tbl, type, state_id, s[j])) != -1) {
             state = &trie->states[state_id];
             if (state->is_fin) {
-                if (match_result_append(result, state->depth, i) != 0) {
-                    return;
+                if (match_emit(cb, ctx, state->depth, i, state->pid) != 0) {
+                    return -1;
                 }
             }
             j++;
         }
     }
+    return 0;
+}
+
+/**
+ * @brief 按状态转移表类型选择主循环实例
+ */
+SM_INLINE int trie_search_dispatch(const Trie *trie, const char *s, int slen, match_callback_t cb, void *ctx) {
+    switch (sttable_inst_type(trie->sttbl)) {
+        case STTABLE_TYPE_ARRAY:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_ARRAY, cb, ctx);
+        case STTABLE_TYPE_ARRAY16:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_ARRAY16, cb, ctx);
+        case STTABLE_TYPE_HASHT:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_HASHT, cb, ctx);
+        case STTABLE_TYPE_LIST:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_LIST, cb, ctx);
+        case STTABLE_TYPE_DBARR:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_DBARR, cb, ctx);
+        case STTABLE_TYPE_OHASH:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_OHASH, cb, ctx);
+        case STTABLE_TYPE_BITMAP:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_BITMAP, cb, ctx);
+        case STTABLE_TYPE_HYBRID:
+            return trie_search_core(trie, s, slen, STTABLE_TYPE_HYBRID, cb, ctx);
+        default:
+            return 0;
+    }
+}
+
+void trie_search(const Trie *trie, const char *s, int slen, match_result_t* result) {
+    trie_search_dispatch(trie, s, slen, match_result_callback, result);
+}
+
+int trie_search_cb(const Trie *trie, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return trie_search_dispatch(trie, s, slen, cb, ctx);
 }
 
 /**
@@ -145,7 +368,8 @@ static int trie_insert_new_state(Trie *trie, int act_state_id, int new_state_id,
  * @return int 状态id
  */
 static int _trie_insert(Trie *trie, const char *p, int plen, int start, int stop, int step) {
-    if (plen <= 0) {
+    int pid = trie->id_num++;
+    if (plen <= 0 || trie->image != NULL) {
         return -1;
     }
     int act_state_id = 0;
@@ -168,6 +392,7 @@ static int _trie_insert(Trie *trie, const char *p, int plen, int start, int stop
     TrieState *state = &trie->states[act_state_id];
     if (!state->is_fin) {
         state->is_fin = 1;
+        state->pid = pid;
         ++trie->fin_state_num;
     }
     return act_state_id;
@@ -2,7 +2,7 @@
 #include <stdlib.h>
 #include "wum.h"
 
-Wum* wum_create(block_size) {
+Wum* wum_create(int block_size) {
     Wum *wum = (Wum *)malloc(sizeof(Wum));
     memset(wum, 0, sizeof(Wum));
     wum->min_len = INT32_MAX;
@@ -24,14 +24,22 @@ Wum* wum_create_ex(const char **patterns, int pnum, int block_size) {
 
 void wum_destroy(Wum *wum) {
     free(wum->htbl.lists);
-    free(wum->stbl.shift);
-    for (int i = 0; i < wum->pnum; i++) {
-        free(wum->nodes[i].str);
+    if (wum->image == NULL) {
+        free(wum->stbl.shift);
+        for (int i = 0; i < wum->pnum; i++) {
+            free(wum->nodes[i].str);
+        }
     }
     free(wum->nodes);
+    sm_image_close(wum->image);
+    free(wum);
 }
 
 int wum_insert(Wum *wum, const char *p, int plen) {
+    int id = wum->id_num++;
+    if (wum->image != NULL) {
+        return -1;
+    }
     if (plen <= 0) {
         return 0;
     }
@@ -46,6 +54,7 @@ int wum_insert(Wum *wum, const char *p, int plen) {
         wum->nsize = size;
     }
     wum_slist_node_t *node = &wum->nodes[wum->pnum++];
+    node->id = id;
     node->len = plen;
     node->next = NULL;
     node->str = (char *)malloc(plen + 1);
@@ -53,6 +62,9 @@ int wum_insert(Wum *wum, const char *p, int plen) {
     if (wum->min_len > plen) {
         wum->min_len = plen;
     }
+    if (wum->max_len < plen) {
+        wum->max_len = plen;
+    }
     wum->stbl.size += plen; // 后续通过该值计算shift表大小
     return 0;
 }
@@ -131,6 +143,9 @@ static void wum_shift_set(Wum *wum, wum_slist_node_t *node) {
 }
 
 void wum_build(Wum *wum) {
+    if (wum->image != NULL) {
+        return;
+    }
     if (wum->block_size > wum->min_len) {
         wum->block_size = wum->min_len;
     }
@@ -162,7 +177,170 @@ void wum_build(Wum *wum) {
     }
 }
 
-void wum_search(const Wum *wum, const char *s, int slen, match_result_t *result) {
+/**
+ * @brief Wum对象在映像中的记录
+ */
+typedef struct {
+    int32_t pnum;       // 模式串数量
+    int32_t id_num;     // 已分配的模式串id数
+    int32_t min_len;    // 最小模式串长度
+    int32_t max_len;    // 最大模式串长度
+    int32_t block_size; // 字符块大小
+    int32_t sbase;      // 位移表基数
+    int32_t hbase;      // 哈希表基数
+    int32_t shift;      // 位移表所在的段，不使用位移表时为-1
+    int32_t lists;      // 哈希表链表首节点下标所在的段
+    int32_t nodes;      // 字符串节点记录所在的段
+    int32_t strs;       // 字符串所在的段
+} wum_image_t;
+
+int wum_save(const Wum *wum, const char *path) {
+    if (wum->htbl.lists == NULL) {
+        return -1;
+    }
+    int pnum = wum->pnum;
+    int cap = wum->htbl.cap;
+    int64_t slen = 0;
+    for (int i = 0; i < pnum; i++) {
+        slen += wum->nodes[i].len + 1;
+    }
+    sm_image_strnode_t *recs = (sm_image_strnode_t *)malloc(sizeof(sm_image_strnode_t) * (pnum > 0 ? pnum : 1));
+    int32_t *firsts = (int32_t *)malloc(sizeof(int32_t) * cap);
+    char *strs = (char *)malloc(slen > 0 ? slen : 1);
+    int ret = -1;
+    if (recs != NULL && firsts != NULL && strs != NULL) {
+        for (int i = 0, off = 0; i < pnum; i++) {
+            const wum_slist_node_t *node = &wum->nodes[i];
+            recs[i].id = node->id;
+            recs[i].len = node->len;
+            recs[i].off = off;
+            recs[i].next = node->next != NULL ? (int32_t)(node->next - wum->nodes) : -1;
+            memcpy(strs + off, node->str, node->len + 1);
+            off += node->len + 1;
+        }
+        for (int i = 0; i < cap; i++) {
+            firsts[i] = wum->htbl.lists[i].first != NULL ? (int32_t)(wum->htbl.lists[i].first - wum->nodes) : -1;
+        }
+        sm_image_writer_t w;
+        wum_image_t meta;
+        sm_image_writer_init(&w, SM_IMAGE_WUM);
+        sm_image_add(&w, &meta, sizeof(meta));
+        meta.pnum = pnum;
+        meta.id_num = wum->id_num;
+        meta.min_len = wum->min_len;
+        meta.max_len = wum->max_len;
+        meta.block_size = wum->block_size;
+        meta.sbase = wum->stbl.base;
+        meta.hbase = wum->htbl.base;
+        meta.shift = wum->stbl.shift != NULL ? sm_image_add(&w, wum->stbl.shift, sizeof(int) * wum->stbl.size) : -1;
+        meta.lists = sm_image_add(&w, firsts, sizeof(int32_t) * cap);
+        meta.nodes = sm_image_add(&w, recs, sizeof(sm_image_strnode_t) * pnum);
+        meta.strs = sm_image_add(&w, strs, slen);
+        ret = sm_image_write(&w, path);
+    }
+    free(recs);
+    free(firsts);
+    free(strs);
+    return ret;
+}
+
+/**
+ * @brief 按节点记录重建哈希表链表，字符串指向映像中的字符串段
+ * 
+ * @param wum  Wum对象，映像已打开
+ * @param meta Wum对象记录
+ * @return int 0:成功 -1:记录与段不符或内存不足
+ */
+static int wum_image_link(Wum *wum, const wum_image_t *meta) {
+    const sm_image_t *img = wum->image;
+    int pnum = meta->pnum;
+    int cap = 1 << meta->hbase;
+    uint64_t slen = 0;
+    const char *strs = (const char *)sm_image_section(img, meta->strs, &slen);
+    const sm_image_strnode_t *recs = (const sm_image_strnode_t *)sm_image_get(img, meta->nodes,
+                                                                              sizeof(sm_image_strnode_t) * (uint64_t)pnum);
+    const int32_t *firsts = (const int32_t *)sm_image_get(img, meta->lists, sizeof(int32_t) * (uint64_t)cap);
+    wum->nodes = (wum_slist_node_t *)calloc(pnum > 0 ? pnum : 1, sizeof(wum_slist_node_t));
+    wum->htbl.lists = (wum_slist_t *)calloc(cap, sizeof(wum_slist_t));
+    if (strs == NULL || recs == NULL || firsts == NULL || wum->nodes == NULL || wum->htbl.lists == NULL) {
+        return -1;
+    }
+    wum->nsize = pnum > 0 ? pnum : 1;
+    wum->pnum = pnum;
+    wum->htbl.cap = cap;
+    wum->htbl.base = meta->hbase;
+    for (int i = 0; i < pnum; i++) {
+        const sm_image_strnode_t *rec = &recs[i];
+        if (rec->len < wum->min_len || rec->off < 0 || (uint64_t)rec->off + rec->len >= slen
+            || strs[rec->off + rec->len] != '\0' || rec->next < -1 || rec->next >= pnum) {
+            return -1;
+        }
+        wum->nodes[i].id = rec->id;
+        wum->nodes[i].len = rec->len;
+        wum->nodes[i].str = (char *)strs + rec->off;
+        wum->nodes[i].next = rec->next != -1 ? &wum->nodes[rec->next] : NULL;
+    }
+    for (int i = 0; i < cap; i++) {
+        if (firsts[i] < -1 || firsts[i] >= pnum) {
+            return -1;
+        }
+        wum->htbl.lists[i].first = firsts[i] != -1 ? &wum->nodes[firsts[i]] : NULL;
+    }
+    // 块长小于最小模式串长度时才使用位移表
+    if (wum->block_size < wum->min_len) {
+        if (meta->sbase < 0 || meta->sbase > 30) {
+            return -1;
+        }
+        wum->stbl.base = meta->sbase;
+        wum->stbl.size = 1 << meta->sbase;
+        wum->stbl.shift = (int *)sm_image_get(img, meta->shift, sizeof(int) * (uint64_t)wum->stbl.size);
+        if (wum->stbl.shift == NULL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+Wum* wum_load(const char *path, int verify) {
+    sm_image_t *img = sm_image_open(path, SM_IMAGE_WUM, verify);
+    if (img == NULL) {
+        return NULL;
+    }
+    const wum_image_t *meta = (const wum_image_t *)sm_image_get(img, 0, sizeof(wum_image_t));
+    if (meta == NULL || meta->pnum < 0 || meta->hbase < 0 || meta->hbase > 30 || meta->block_size <= 0
+        || meta->block_size > meta->min_len) {
+        sm_image_close(img);
+        return NULL;
+    }
+    Wum *wum = (Wum *)calloc(1, sizeof(Wum));
+    if (wum == NULL) {
+        sm_image_close(img);
+        return NULL;
+    }
+    wum->image = img;
+    wum->id_num = meta->id_num;
+    wum->min_len = meta->min_len;
+    wum->max_len = meta->max_len;
+    wum->block_size = meta->block_size;
+    if (wum_image_link(wum, meta) != 0) {
+        wum_destroy(wum);
+        return NULL;
+    }
+    return wum;
+}
+
+/**
+ * @brief 扫描主循环
+ * 
+ * @param wum  Wum对象
+ * @param s    字符串
+ * @param slen 字符串长度
+ * @param base 字符串首字符的绝对偏移
+ * @param cb   回调函数
+ * @param ctx  回调上下文
+ * @return int 0:扫描完成 -1:被回调终止
+ */
+SM_INLINE int wum_search_core(const Wum *wum, const char *s, int slen, int64_t base, match_callback_t cb, void *ctx) {
     int hash = 0;
     int min_len = wum->min_len;
     int block_size = wum->block_size;
@@ -179,10 +357,111 @@ void wum_search(const Wum *wum, const char *s, int slen, match_result_t *result)
         wum_slist_node_t *node = list->first;
         while (node != NULL) {
             if (node->len - 1 <= i && (memcmp(node->str, s + i - node->len + 1, node->len) == 0)) {
-                match_result_append(result, node->len, i - node->len + 1);
+                if (match_emit(cb, ctx, node->len, base + i - node->len + 1, node->id) != 0) {
+                    return -1;
+                }
             }
             node = node->next;
         }
         shift = 1;
     }
+    return 0;
+}
+
+void wum_search(const Wum *wum, const char *s, int slen, match_result_t *result) {
+    wum_search_core(wum, s, slen, 0, match_result_callback, result);
+}
+
+int wum_search_cb(const Wum *wum, const char *s, int slen, match_callback_t cb, void *ctx) {
+    return wum_search_core(wum, s, slen, 0, cb, ctx);
+}
+
+int64_t wum_count(const Wum *wum, const char *s, int slen) {
+    int64_t count = 0;
+    wum_search_core(wum, s, slen, 0, match_count_callback, &count);
+    return count;
+}
+
+int wum_contains(const Wum *wum, const char *s, int slen) {
+    return wum_search_core(wum, s, slen, 0, match_stop_callback, NULL) != 0;
+}
+
+wum_stream_t* wum_stream_create(const Wum *wum) {
+    wum_stream_t *stream = (wum_stream_t *)malloc(sizeof(wum_stream_t));
+    if (stream == NULL) {
+        return NULL;
+    }
+    int keep = wum->max_len > 0 ? wum->max_len - 1 : 0;
+    stream->buf = (char *)malloc(keep * 2 + 1);
+    if (stream->buf == NULL) {
+        free(stream);
+        return NULL;
+    }
+    stream->wum = wum;
+    wum_stream_reset(stream);
+    return stream;
+}
+
+void wum_stream_destroy(wum_stream_t *stream) {
+    free(stream->buf);
+    free(stream);
+}
+
+void wum_stream_reset(wum_stream_t *stream) {
+    stream->tlen = 0;
+    stream->offset = 0;
+}
+
+/**
+ * @brief 跨块匹配过滤上下文
+ */
+typedef struct {
+    match_callback_t cb; // 用户回调函数
+    void *ctx;           // 用户回调上下文
+    int64_t bound;       // 当前块首字符的绝对偏移
+} wum_stream_filter_t;
+
+/**
+ * @brief 只保留跨越块边界的匹配，其余匹配由上一块或当前块单独扫描得到
+ */
+static int wum_stream_filter(const match_item_t *item, void *ctx) {
+    wum_stream_filter_t *filter = (wum_stream_filter_t *)ctx;
+    if (item->pos < filter->bound && item->pos + item->len > filter->bound) {
+        return filter->cb(item, filter->ctx);
+    }
+    return 0;
+}
+
+int wum_stream_search_cb(wum_stream_t *stream, const char *s, int slen, match_callback_t cb, void *ctx) {
+    const Wum *wum = stream->wum;
+    int keep = wum->max_len > 0 ? wum->max_len - 1 : 0;
+    int hlen = slen < keep ? slen : keep;
+    // 拼接上一块末尾和当前块开头，匹配跨越边界的模式串
+    memcpy(stream->buf + stream->tlen, s, hlen);
+    if (stream->tlen > 0) {
+        wum_stream_filter_t filter = {cb, ctx, stream->offset};
+        if (wum_search_core(wum, stream->buf, stream->tlen + hlen, stream->offset - stream->tlen,
+                            wum_stream_filter, &filter) != 0) {
+            return -1;
+        }
+    }
+    if (wum_search_core(wum, s, slen, stream->offset, cb, ctx) != 0) {
+        return -1;
+    }
+    // 保留末尾max_len-1字节
+    if (slen >= keep) {
+        memcpy(stream->buf, s + slen - keep, keep);
+        stream->tlen = keep;
+    } else {
+        int total = stream->tlen + slen;
+        int tlen = total < keep ? total : keep;
+        memmove(stream->buf, stream->buf + total - tlen, tlen);
+        stream->tlen = tlen;
+    }
+    stream->offset += slen;
+    return 0;
+}
+
+void wum_stream_search(wum_stream_t *stream, const char *s, int slen, match_result_t *result) {
+    wum_stream_search_cb(stream, s, slen, match_result_callback, result);
 }
\ No newline at end of file
@@ -0,0 +1,747 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "trie.h"
+#include "ac.h"
+#include "oracle.h"
+#include "shift.h"
+#include "bndm.h"
+#include "horspool.h"
+#include "wum.h"
+#include "dat.h"
+
+/**
+ * 多模式串匹配性能测试
+ *
+ * 对每个语料（english/dna/random/log或文件）和每个模式串数量生成一份词典，
+ * 每个引擎在独立的子进程中构建并扫描，输出构建时间、峰值内存、扫描吞吐量和匹配数。
+ *
+ * 示例：bench_xmsm -c dna,english -n 10,1000,100000 -l 4-16 -f json
+ *       bench_xmsm -M batch -D 200 -e ac_full,ac_part
+ */
+
+#define BENCH_DEFAULT_TEXT_MB   16
+// 语料长度以int表示，生成语料最大2047MB
+#define BENCH_MAX_TEXT_MB       2047
+#define BENCH_DEFAULT_REPEAT    3
+#define BENCH_DEFAULT_MATCH_CAP 4096
+#define BENCH_DEFAULT_DOC_LEN   200
+#define BENCH_MAX_LIST          32
+
+typedef struct {
+    const char *name;
+    void* (*build)(const char **patterns, int pnum);
+    void (*search)(const void *engine, const char *s, int slen, match_result_t *result);
+    void (*destroy)(void *engine);
+    int64_t (*count)(const void *engine, const char *s, int slen);  // 可选，计数模式
+    int (*contains)(const void *engine, const char *s, int slen);   // 可选，存在判断模式
+    long (*batch)(const void *engine, const match_doc_t *docs, int ndocs); // 可选，批量文档模式，返回匹配数
+} bench_engine_t;
+
+typedef enum {
+    BENCH_MODE_SEARCH,   // 生成匹配结果
+    BENCH_MODE_COUNT,    // 只统计匹配数
+    BENCH_MODE_CONTAINS, // 只判断是否存在匹配
+    BENCH_MODE_DOCS,     // 语料切分为短文档，逐个调用search
+    BENCH_MODE_BATCH,    // 语料切分为短文档，调用批量匹配接口
+} BenchMode;
+
+typedef struct {
+    const char *corpus[BENCH_MAX_LIST]; // 语料类型
+    int cnum;
+    int pnums[BENCH_MAX_LIST];          // 模式串数量
+    int nnum;
+    const char *engines;  // 引擎列表，逗号分隔，NULL表示全部
+    const char *dist;     // 模式串长度分布
+    const char *input;    // 输入文件，替代生成语料
+    int min_len;          // 最小模式串长度
+    int max_len;          // 最大模式串长度
+    int text_mb;          // 生成语料大小（MB）
+    int repeat;           // 扫描次数，取最快一次
+    int hit;              // 从语料中截取的模式串比例（%）
+    int cap;              // 匹配结果缓冲区大小
+    int doc_len;          // 文档模式下的文档长度
+    int json;             // 输出json lines，否则csv
+    BenchMode mode;       // 扫描模式
+    uint64_t seed;        // 随机数种子
+} bench_opts_t;
+
+static uint64_t rng_state = 88172645463325252ULL;
+
+static uint64_t rng_next() {
+    // xorshift64*，保证不同平台结果一致
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+static int rng_range(int lo, int hi) {
+    return lo + (int)(rng_next() % (uint64_t)(hi - lo + 1));
+}
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static long peak_rss_kb() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;
+#else
+    return ru.ru_maxrss;
+#endif
+}
+
+// ---------------------------------------------------------------- 引擎适配
+
+static void* trie_bench_build(const char **patterns, int pnum) {
+    return trie_create_ex(patterns, pnum, STTABLE_TYPE_ARRAY);
+}
+
+static void trie_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    trie_search((const Trie *)engine, s, slen, result);
+}
+
+static void trie_bench_destroy(void *engine) {
+    trie_destroy((Trie *)engine);
+}
+
+static void* ac_full_bench_build(const char **patterns, int pnum) {
+    return ac_create_ex(patterns, pnum, AC_LEVEL_FULL);
+}
+
+static void* ac_full_bfs_bench_build(const char **patterns, int pnum) {
+    AC *ac = ac_create_ex(patterns, pnum, AC_LEVEL_FULL);
+    ac_relayout(ac, NULL);
+    return ac;
+}
+
+static void* ac_cls_bench_build(const char **patterns, int pnum) {
+    AC *ac = ac_create(AC_LEVEL_FULL);
+    for (int i = 0; i < pnum; i++) {
+        ac_insert(ac, patterns[i], strlen(patterns[i]));
+    }
+    ac_build_ex(ac, 1);
+    return ac;
+}
+
+static void* ac_part_bench_build(const char **patterns, int pnum) {
+    return ac_create_ex(patterns, pnum, AC_LEVEL_PART);
+}
+
+static AC* ac_typed_build(const char **patterns, int pnum, ACLevel level, STTableType sttype) {
+    AC *ac = ac_create_typed(level, sttype);
+    for (int i = 0; i < pnum; i++) {
+        ac_insert(ac, patterns[i], strlen(patterns[i]));
+    }
+    ac_build(ac);
+    return ac;
+}
+
+static void* ac_bitmap_bench_build(const char **patterns, int pnum) {
+    return ac_typed_build(patterns, pnum, AC_LEVEL_PART, STTABLE_TYPE_BITMAP);
+}
+
+static void* ac_hybrid_bench_build(const char **patterns, int pnum) {
+    return ac_typed_build(patterns, pnum, AC_LEVEL_PART, STTABLE_TYPE_HYBRID);
+}
+
+static void* ac_diff_bench_build(const char **patterns, int pnum) {
+    return ac_typed_build(patterns, pnum, AC_LEVEL_FULL, STTABLE_TYPE_HYBRID);
+}
+
+static void* ac_part_bfs_bench_build(const char **patterns, int pnum) {
+    AC *ac = ac_create_ex(patterns, pnum, AC_LEVEL_PART);
+    ac_relayout(ac, NULL);
+    return ac;
+}
+
+static void ac_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    ac_search((const AC *)engine, s, slen, result);
+}
+
+static void ac_bench_destroy(void *engine) {
+    ac_destroy((AC *)engine);
+}
+
+static int64_t ac_bench_count(const void *engine, const char *s, int slen) {
+    return ac_count((const AC *)engine, s, slen);
+}
+
+static int ac_bench_contains(const void *engine, const char *s, int slen) {
+    return ac_contains((const AC *)engine, s, slen);
+}
+
+/**
+ * @brief 批量匹配回调，只统计匹配数
+ */
+static int count_batch_callback(int doc, const match_item_t *item, void *ctx) {
+    (void)doc;
+    (void)item;
+    ++*(long *)ctx;
+    return 0;
+}
+
+static long ac_bench_batch(const void *engine, const match_doc_t *docs, int ndocs) {
+    long matches = 0;
+    ac_search_batch_cb((const AC *)engine, docs, ndocs, count_batch_callback, &matches);
+    return matches;
+}
+
+static void* sbom_bench_build(const char **patterns, int pnum) {
+    return oracle_create_ex(patterns, pnum);
+}
+
+static void* sbom_bitmap_bench_build(const char **patterns, int pnum) {
+    Oracle *orc = oracle_create_typed(STTABLE_TYPE_BITMAP);
+    for (int i = 0; i < pnum; i++) {
+        oracle_insert(orc, patterns[i], strlen(patterns[i]));
+    }
+    oracle_build(orc);
+    return orc;
+}
+
+static void sbom_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    oracle_search((const Oracle *)engine, s, slen, result);
+}
+
+static void sbom_bench_destroy(void *engine) {
+    oracle_destroy((Oracle *)engine);
+}
+
+static int64_t sbom_bench_count(const void *engine, const char *s, int slen) {
+    return oracle_count((const Oracle *)engine, s, slen);
+}
+
+static int sbom_bench_contains(const void *engine, const char *s, int slen) {
+    return oracle_contains((const Oracle *)engine, s, slen);
+}
+
+static void* shift_bench_build(const char **patterns, int pnum) {
+    ShiftNFA *snfa = shift_nfa_create();
+    for (int i = 0; i < pnum; i++) {
+        if (shift_nfa_insert(snfa, patterns[i], strlen(patterns[i])) != 0) {
+            shift_nfa_destroy(snfa);
+            return NULL;
+        }
+    }
+    shift_nfa_build(snfa);
+    return snfa;
+}
+
+static void shift_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    shift_nfa_search((const ShiftNFA *)engine, s, slen, result);
+}
+
+static void shift_bench_destroy(void *engine) {
+    shift_nfa_destroy((ShiftNFA *)engine);
+}
+
+static void* bndm_bench_build(const char **patterns, int pnum) {
+    BndmNFA *nfa = bndm_nfa_create();
+    for (int i = 0; i < pnum; i++) {
+        if (bndm_nfa_insert(nfa, patterns[i], strlen(patterns[i])) != 0) {
+            bndm_nfa_destroy(nfa);
+            return NULL;
+        }
+    }
+    bndm_nfa_build(nfa);
+    return nfa;
+}
+
+static void bndm_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    bndm_nfa_search((const BndmNFA *)engine, s, slen, result);
+}
+
+static void bndm_bench_destroy(void *engine) {
+    bndm_nfa_destroy((BndmNFA *)engine);
+}
+
+static void* horspool_bench_build(const char **patterns, int pnum) {
+    return horspool_create_ex(patterns, pnum, 2);
+}
+
+static void horspool_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    horspool_trie_search((const Horspool *)engine, s, slen, result);
+}
+
+static void horspool_bench_destroy(void *engine) {
+    horspool_destroy((Horspool *)engine);
+}
+
+static void* wum_bench_build(const char **patterns, int pnum) {
+    return wum_create_ex(patterns, pnum, 2);
+}
+
+static void wum_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    wum_search((const Wum *)engine, s, slen, result);
+}
+
+static void wum_bench_destroy(void *engine) {
+    wum_destroy((Wum *)engine);
+}
+
+static int64_t wum_bench_count(const void *engine, const char *s, int slen) {
+    return wum_count((const Wum *)engine, s, slen);
+}
+
+static int wum_bench_contains(const void *engine, const char *s, int slen) {
+    return wum_contains((const Wum *)engine, s, slen);
+}
+
+static void* dat_bench_build(const char **patterns, int pnum) {
+    return dat_create_ex(patterns, pnum);
+}
+
+static void dat_bench_search(const void *engine, const char *s, int slen, match_result_t *result) {
+    dat_search((const DATrie *)engine, s, slen, result);
+}
+
+static void dat_bench_destroy(void *engine) {
+    dat_destroy((DATrie *)engine);
+}
+
+static const bench_engine_t engines[] = {
+    {"trie",     trie_bench_build,     trie_bench_search,     trie_bench_destroy,     NULL,             NULL,                NULL},
+    {"ac_full",  ac_full_bench_build,  ac_bench_search,       ac_bench_destroy,       ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_full_bfs", ac_full_bfs_bench_build, ac_bench_search, ac_bench_destroy,     ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_cls",   ac_cls_bench_build,   ac_bench_search,       ac_bench_destroy,       ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_diff",  ac_diff_bench_build,  ac_bench_search,       ac_bench_destroy,       ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_part",  ac_part_bench_build,  ac_bench_search,       ac_bench_destroy,       ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_part_bfs", ac_part_bfs_bench_build, ac_bench_search, ac_bench_destroy,     ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_bitmap", ac_bitmap_bench_build, ac_bench_search,   ac_bench_destroy,       ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"ac_hybrid", ac_hybrid_bench_build, ac_bench_search,   ac_bench_destroy,       ac_bench_count,   ac_bench_contains,   ac_bench_batch},
+    {"sbom",     sbom_bench_build,     sbom_bench_search,     sbom_bench_destroy,     sbom_bench_count, sbom_bench_contains, NULL},
+    {"sbom_bitmap", sbom_bitmap_bench_build, sbom_bench_search, sbom_bench_destroy, sbom_bench_count, sbom_bench_contains, NULL},
+    {"shift",    shift_bench_build,    shift_bench_search,    shift_bench_destroy,    NULL,             NULL,                NULL},
+    {"bndm",     bndm_bench_build,     bndm_bench_search,     bndm_bench_destroy,     NULL,             NULL,                NULL},
+    {"horspool", horspool_bench_build, horspool_bench_search, horspool_bench_destroy, NULL,             NULL,                NULL},
+    {"wum",      wum_bench_build,      wum_bench_search,      wum_bench_destroy,      wum_bench_count,  wum_bench_contains,  NULL},
+    {"dat",      dat_bench_build,      dat_bench_search,      dat_bench_destroy,      NULL,             NULL,                NULL},
+};
+
+// ---------------------------------------------------------------- 语料生成
+
+static const char *words[] = {
+    "the", "of", "and", "to", "in", "a", "is", "that", "for", "it", "as", "was", "with", "be",
+    "by", "on", "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have",
+    "an", "had", "they", "you", "were", "their", "one", "all", "we", "can", "her", "has",
+    "there", "been", "if", "more", "when", "will", "would", "who", "so", "no", "time", "people",
+    "year", "way", "day", "thing", "world", "life", "hand", "part", "child", "woman", "place",
+    "work", "week", "case", "point", "government", "company", "number", "group", "problem",
+    "fact", "string", "pattern", "matching", "automaton", "search", "algorithm", "memory",
+    "network", "system", "program", "question", "important", "different", "following",
+    "information", "development", "understand", "national", "business", "experience",
+};
+
+static const char *log_levels[] = {"INFO", "DEBUG", "WARN", "ERROR"};
+static const char *log_methods[] = {"GET", "POST", "PUT", "DELETE"};
+static const char *log_paths[] = {"/api/v1/items", "/api/v1/users", "/static/js/app.js", "/login", "/api/v2/search"};
+
+static void gen_english(char *s, int slen) {
+    int nwords = sizeof(words) / sizeof(words[0]);
+    int i = 0;
+    int head = 1;
+    while (i < slen) {
+        // 近似zipf分布：小下标的单词更常见
+        int k = (int)(rng_next() % nwords);
+        k = (int)(rng_next() % (k + 1));
+        const char *w = words[k];
+        for (int j = 0; w[j] != '\0' && i < slen; j++) {
+            s[i++] = (head && j == 0) ? w[j] - 'a' + 'A' : w[j];
+        }
+        head = 0;
+        if (i < slen) {
+            int r = rng_range(0, 15);
+            if (r == 0) {
+                s[i++] = '.';
+                head = 1;
+            } else if (r == 1) {
+                s[i++] = ',';
+            }
+        }
+        if (i < slen) {
+            s[i++] = ' ';
+        }
+    }
+}
+
+static void gen_dna(char *s, int slen) {
+    static const char acgt[] = "ACGT";
+    for (int i = 0; i < slen; i++) {
+        s[i] = acgt[rng_next() & 3];
+    }
+}
+
+static void gen_random(char *s, int slen) {
+    // 各引擎以char为下标访问转移表，且模式串以'\0'结尾，因此取1-127；
+    // DAT以DAT_STOP_CHAR作为模式串结束标记，需要排除
+    for (int i = 0; i < slen; i++) {
+        char c = 0;
+        while (c == 0 || c == DAT_STOP_CHAR) {
+            c = (char)rng_range(1, 127);
+        }
+        s[i] = c;
+    }
+}
+
+static void gen_log(char *s, int slen) {
+    char line[256];
+    int i = 0;
+    for (int n = 0; i < slen; n++) {
+        int len = snprintf(line, sizeof(line),
+            "2024-03-%02d %02d:%02d:%02d.%03d %s [worker-%d] %s %s/%d status=%d latency=%dms user=u%d\n",
+            rng_range(1, 28), rng_range(0, 23), rng_range(0, 59), rng_range(0, 59), rng_range(0, 999),
+            log_levels[rng_range(0, 3)], rng_range(0, 31), log_methods[rng_range(0, 3)],
+            log_paths[rng_range(0, 4)], rng_range(1, 99999), rng_range(0, 9) == 0 ? 500 : 200,
+            rng_range(1, 999), rng_range(1, 9999));
+        for (int j = 0; j < len && i < slen; j++) {
+            s[i++] = line[j];
+        }
+    }
+}
+
+static void gen_corpus(const char *type, char *s, int slen) {
+    if (strcmp(type, "dna") == 0) {
+        gen_dna(s, slen);
+    } else if (strcmp(type, "random") == 0) {
+        gen_random(s, slen);
+    } else if (strcmp(type, "log") == 0) {
+        gen_log(s, slen);
+    } else {
+        gen_english(s, slen);
+    }
+}
+
+static char* load_file(const char *path, int *slen) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size < 0 || size > INT32_MAX - 1) {
+        fclose(fp);
+        return NULL;
+    }
+    char *s = (char *)malloc(size + 1);
+    *slen = (int)fread(s, 1, size, fp);
+    s[*slen] = '\0';
+    fclose(fp);
+    return s;
+}
+
+// ---------------------------------------------------------------- 词典生成
+
+static int gen_length(const bench_opts_t *opts) {
+    if (strcmp(opts->dist, "fixed") == 0) {
+        return opts->max_len;
+    }
+    if (strcmp(opts->dist, "short") == 0) {
+        // 几何分布，短模式串居多
+        int len = opts->min_len;
+        while (len < opts->max_len && (rng_next() & 1)) {
+            ++len;
+        }
+        return len;
+    }
+    return rng_range(opts->min_len, opts->max_len);
+}
+
+/**
+ * @brief 生成词典，hit%的模式串截取自语料，其余来自同类型的随机语料
+ */
+static char** gen_patterns(const bench_opts_t *opts, const char *type, const char *s, int slen, int pnum) {
+    int miss_len = 1 << 20;
+    char *miss = (char *)malloc(miss_len);
+    gen_corpus(type, miss, miss_len);
+    char **patterns = (char **)malloc(sizeof(char *) * pnum);
+    for (int i = 0; i < pnum; i++) {
+        int len = gen_length(opts);
+        int from_text = (int)(rng_next() % 100) < opts->hit && slen > len;
+        const char *src = from_text ? s : miss;
+        int src_len = from_text ? slen : miss_len;
+        int pos = (int)(rng_next() % (uint64_t)(src_len - len));
+        patterns[i] = (char *)malloc(len + 1);
+        memcpy(patterns[i], src + pos, len);
+        patterns[i][len] = '\0';
+        // 文件语料可能包含'\0'，替换掉以免截断模式串
+        for (int j = 0; j < len; j++) {
+            if (patterns[i][j] == '\0') {
+                patterns[i][j] = ' ';
+            }
+        }
+    }
+    free(miss);
+    return patterns;
+}
+
+// ---------------------------------------------------------------- 测试执行
+
+static void print_header(const bench_opts_t *opts) {
+    if (!opts->json) {
+        printf("corpus,text_bytes,patterns,len_dist,min_len,max_len,engine,mode,status,"
+               "build_ms,peak_mem_kb,scan_ms,mbps,matches\n");
+    }
+}
+
+static void print_record(const bench_opts_t *opts, const char *corpus, int slen, int pnum,
+    const char *engine, const char *status, double build_ms, long mem_kb, double scan_ms, long matches) {
+    static const char *modes[] = {"search", "count", "contains", "docs", "batch"};
+    const char *mode = modes[opts->mode];
+    double mbps = scan_ms > 0 ? slen / (1024.0 * 1024.0) / (scan_ms / 1e3) : 0;
+    if (opts->json) {
+        printf("{\"corpus\":\"%s\",\"text_bytes\":%d,\"patterns\":%d,\"len_dist\":\"%s\","
+               "\"min_len\":%d,\"max_len\":%d,\"engine\":\"%s\",\"mode\":\"%s\",\"status\":\"%s\","
+               "\"build_ms\":%.3f,\"peak_mem_kb\":%ld,\"scan_ms\":%.3f,\"mbps\":%.2f,\"matches\":%ld}\n",
+               corpus, slen, pnum, opts->dist, opts->min_len, opts->max_len, engine, mode, status,
+               build_ms, mem_kb, scan_ms, mbps, matches);
+    } else {
+        printf("%s,%d,%d,%s,%d,%d,%s,%s,%s,%.3f,%ld,%.3f,%.2f,%ld\n",
+               corpus, slen, pnum, opts->dist, opts->min_len, opts->max_len, engine, mode, status,
+               build_ms, mem_kb, scan_ms, mbps, matches);
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief 匹配结果输出函数，只统计匹配数
+ */
+static int count_sink(const match_item_t *items, int size, void *ctx) {
+    (void)items;
+    *(long *)ctx += size;
+    return 0;
+}
+
+/**
+ * @brief 在子进程中运行单个引擎，进程隔离保证峰值内存统计互不干扰
+ */
+static void run_engine(const bench_opts_t *opts, const bench_engine_t *engine, const char *corpus,
+    const char *s, int slen, const char **patterns, int pnum) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return;
+    }
+    if (pid > 0) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            print_record(opts, corpus, slen, pnum, engine->name, "crashed", 0, 0, 0, 0);
+        }
+        return;
+    }
+    long matches = 0;
+    match_result_t *result = match_result_create_ex(opts->cap, MATCH_RESULT_SINK);
+    match_result_set_sink(result, count_sink, &matches);
+    long mem0 = peak_rss_kb();
+    double t0 = now_ms();
+    void *e = engine->build(patterns, pnum);
+    double build_ms = now_ms() - t0;
+    long mem_kb = peak_rss_kb() - mem0;
+    if (e == NULL) {
+        print_record(opts, corpus, slen, pnum, engine->name, "skipped", build_ms, mem_kb, 0, 0);
+        _exit(0);
+    }
+    if ((opts->mode == BENCH_MODE_COUNT && engine->count == NULL)
+        || (opts->mode == BENCH_MODE_CONTAINS && engine->contains == NULL)
+        || (opts->mode == BENCH_MODE_BATCH && engine->batch == NULL)) {
+        print_record(opts, corpus, slen, pnum, engine->name, "unsupported", build_ms, mem_kb, 0, 0);
+        _exit(0);
+    }
+    // 文档模式下把语料切分为定长短文档
+    int ndocs = 0;
+    match_doc_t *docs = NULL;
+    if (opts->mode == BENCH_MODE_DOCS || opts->mode == BENCH_MODE_BATCH) {
+        ndocs = (slen + opts->doc_len - 1) / opts->doc_len;
+        docs = (match_doc_t *)malloc(sizeof(match_doc_t) * (ndocs > 0 ? ndocs : 1));
+        for (int i = 0; i < ndocs; i++) {
+            docs[i].s = s + (long)i * opts->doc_len;
+            docs[i].len = slen - i * opts->doc_len < opts->doc_len ? slen - i * opts->doc_len : opts->doc_len;
+        }
+    }
+    double scan_ms = -1;
+    for (int r = 0; r < opts->repeat; r++) {
+        match_result_reset(result);
+        matches = 0;
+        t0 = now_ms();
+        if (opts->mode == BENCH_MODE_COUNT) {
+            matches = engine->count(e, s, slen);
+        } else if (opts->mode == BENCH_MODE_CONTAINS) {
+            matches = engine->contains(e, s, slen);
+        } else if (opts->mode == BENCH_MODE_BATCH) {
+            matches = engine->batch(e, docs, ndocs);
+        } else if (opts->mode == BENCH_MODE_DOCS) {
+            for (int i = 0; i < ndocs; i++) {
+                engine->search(e, docs[i].s, docs[i].len, result);
+            }
+            match_result_flush(result);
+        } else {
+            engine->search(e, s, slen, result);
+            match_result_flush(result);
+        }
+        double ms = now_ms() - t0;
+        if (scan_ms < 0 || ms < scan_ms) {
+            scan_ms = ms;
+        }
+    }
+    print_record(opts, corpus, slen, pnum, engine->name, "ok", build_ms, mem_kb, scan_ms, matches);
+    free(docs);
+    engine->destroy(e);
+    match_result_destroy(result);
+    _exit(0);
+}
+
+static int engine_selected(const bench_opts_t *opts, const char *name) {
+    if (opts->engines == NULL) {
+        return 1;
+    }
+    int len = strlen(name);
+    for (const char *p = opts->engines; (p = strstr(p, name)) != NULL; p += len) {
+        if ((p == opts->engines || p[-1] == ',') && (p[len] == ',' || p[len] == '\0')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void run_corpus(const bench_opts_t *opts, const char *corpus) {
+    int slen = 0;
+    char *s = NULL;
+    if (opts->input != NULL) {
+        s = load_file(opts->input, &slen);
+        if (s == NULL) {
+            fprintf(stderr, "bench_xmsm: cannot read %s\n", opts->input);
+            return;
+        }
+    } else {
+        slen = opts->text_mb * 1024 * 1024;
+        s = (char *)malloc(slen + 1);
+        if (s == NULL) {
+            fprintf(stderr, "bench_xmsm: cannot allocate %d MB corpus\n", opts->text_mb);
+            return;
+        }
+        gen_corpus(corpus, s, slen);
+        s[slen] = '\0';
+    }
+    for (int n = 0; n < opts->nnum; n++) {
+        int pnum = opts->pnums[n];
+        char **patterns = gen_patterns(opts, corpus, s, slen, pnum);
+        for (int i = 0; i < (int)(sizeof(engines) / sizeof(engines[0])); i++) {
+            if (engine_selected(opts, engines[i].name)) {
+                run_engine(opts, &engines[i], corpus, s, slen, (const char **)patterns, pnum);
+            }
+        }
+        for (int i = 0; i < pnum; i++) {
+            free(patterns[i]);
+        }
+        free(patterns);
+    }
+    free(s);
+}
+
+static int split_list(char *arg, const char **list) {
+    int num = 0;
+    for (char *tok = strtok(arg, ","); tok != NULL && num < BENCH_MAX_LIST; tok = strtok(NULL, ",")) {
+        list[num++] = tok;
+    }
+    return num;
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: bench_xmsm [options]\n"
+        "  -c list   corpora: english,dna,random,log (default english)\n"
+        "  -i file   scan a file instead of a generated corpus\n"
+        "  -s MB     generated corpus size, at most %d (default %d)\n"
+        "  -n list   pattern counts, e.g. 10,1000,1000000 (default 10,100,1000)\n"
+        "  -l a-b    pattern length range (default 4-16)\n"
+        "  -d dist   length distribution: uniform,fixed,short (default uniform)\n"
+        "  -e list   engines (default all): trie,ac_full,ac_full_bfs,ac_cls,ac_diff,ac_part,ac_part_bfs,ac_bitmap,ac_hybrid,sbom,sbom_bitmap,shift,bndm,horspool,wum,dat\n"
+        "  -r num    scan repetitions, fastest is reported (default %d)\n"
+        "  -h pct    percentage of patterns sampled from the corpus (default 50)\n"
+        "  -m num    match buffer size, flushed to a counting sink when full (default %d)\n"
+        "  -S seed   random seed\n"
+        "  -M mode   scan mode: search,count,contains,docs,batch (default search)\n"
+        "            docs/batch split the corpus into short documents scanned one by one / in batch\n"
+        "  -D len    document length for docs/batch modes (default %d)\n"
+        "  -f fmt    output format: csv,json (default csv)\n",
+        BENCH_MAX_TEXT_MB, BENCH_DEFAULT_TEXT_MB, BENCH_DEFAULT_REPEAT, BENCH_DEFAULT_MATCH_CAP, BENCH_DEFAULT_DOC_LEN);
+}
+
+int main(int argc, char *argv[]) {
+    bench_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.corpus[0] = "english";
+    opts.cnum = 1;
+    opts.pnums[0] = 10;
+    opts.pnums[1] = 100;
+    opts.pnums[2] = 1000;
+    opts.nnum = 3;
+    opts.dist = "uniform";
+    opts.min_len = 4;
+    opts.max_len = 16;
+    opts.text_mb = BENCH_DEFAULT_TEXT_MB;
+    opts.repeat = BENCH_DEFAULT_REPEAT;
+    opts.hit = 50;
+    opts.cap = BENCH_DEFAULT_MATCH_CAP;
+    opts.doc_len = BENCH_DEFAULT_DOC_LEN;
+    opts.seed = rng_state;
+    int opt = 0;
+    const char *list[BENCH_MAX_LIST];
+    while ((opt = getopt(argc, argv, "c:i:s:n:l:d:e:r:h:m:D:S:M:f:")) != -1) {
+        switch (opt) {
+            case 'c': opts.cnum = split_list(optarg, opts.corpus); break;
+            case 'i': opts.input = optarg; opts.corpus[0] = "file"; opts.cnum = 1; break;
+            case 's': opts.text_mb = atoi(optarg); break;
+            case 'n':
+                opts.nnum = split_list(optarg, list);
+                for (int i = 0; i < opts.nnum; i++) {
+                    opts.pnums[i] = atoi(list[i]);
+                }
+                break;
+            case 'l':
+                if (sscanf(optarg, "%d-%d", &opts.min_len, &opts.max_len) != 2) {
+                    opts.max_len = opts.min_len;
+                }
+                break;
+            case 'd': opts.dist = optarg; break;
+            case 'e': opts.engines = optarg; break;
+            case 'r': opts.repeat = atoi(optarg); break;
+            case 'h': opts.hit = atoi(optarg); break;
+            case 'm': opts.cap = atoi(optarg); break;
+            case 'D': opts.doc_len = atoi(optarg); break;
+            case 'S': opts.seed = strtoull(optarg, NULL, 10); break;
+            case 'M':
+                opts.mode = strcmp(optarg, "count") == 0 ? BENCH_MODE_COUNT
+                    : strcmp(optarg, "contains") == 0 ? BENCH_MODE_CONTAINS
+                    : strcmp(optarg, "docs") == 0 ? BENCH_MODE_DOCS
+                    : strcmp(optarg, "batch") == 0 ? BENCH_MODE_BATCH : BENCH_MODE_SEARCH;
+                break;
+            case 'f': opts.json = strcmp(optarg, "json") == 0; break;
+            default: usage(); return 1;
+        }
+    }
+    if (opts.min_len <= 0 || opts.max_len < opts.min_len || opts.repeat <= 0 || opts.text_mb <= 0
+        || opts.text_mb > BENCH_MAX_TEXT_MB || opts.doc_len <= 0) {
+        usage();
+        return 1;
+    }
+    print_header(&opts);
+    for (int i = 0; i < opts.cnum; i++) {
+        rng_state = opts.seed != 0 ? opts.seed : 1;
+        run_corpus(&opts, opts.corpus[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+
+#define RANDOM_ROUNDS 300
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    return x->len - y->len;
+}
+
+/**
+ * @brief 匹配项按位置和长度排序后逐项比较，含模式串id
+ */
+static int result_equal(match_result_t *got, match_result_t *exp) {
+    qsort(got->items, got->size, sizeof(match_item_t), item_cmp);
+    qsort(exp->items, exp->size, sizeof(match_item_t), item_cmp);
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    return ok;
+}
+
+/**
+ * @brief 逐位置比较得到未删除模式串的全部匹配，id为模式串下标
+ */
+static void brute_search(const char *s, int slen, const char **patterns, int pnum, const int *removed,
+                         match_result_t *result) {
+    for (int i = 0; i < slen; i++) {
+        for (int k = 0; k < pnum; k++) {
+            int plen = strlen(patterns[k]);
+            if (!removed[k] && i + plen <= slen && memcmp(s + i, patterns[k], plen) == 0) {
+                match_result_append(result, plen, i, k);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 构建后增量插入和删除，与按最终模式串集合重新构建的自动机对比
+ * 插入顺序相同、删除在构建前完成时状态编号一致，suff、next、outn应逐项相等
+ */
+static void ac_incr_round(STTableType type, const char **patterns, int pnum, const char *s, int slen,
+                          unsigned *seed, int round) {
+    int removed[32] = {0};
+    int half = pnum / 2;
+    AC *ac = ac_create_typed(AC_LEVEL_PART, type);
+    for (int k = 0; k < half; k++) {
+        ac_insert(ac, patterns[k], strlen(patterns[k]));
+    }
+    ac_build(ac);
+    for (int k = half; k < pnum; k++) {
+        check(ac_insert(ac, patterns[k], strlen(patterns[k])) >= 0, "ac incr insert", round);
+    }
+    for (int k = 0; k < pnum; k++) {
+        if (rand_next(seed) % 4 == 0) {
+            check(ac_remove(ac, patterns[k], strlen(patterns[k])) == 0, "ac incr remove", round);
+            removed[k] = 1;
+        }
+    }
+    check(ac_remove(ac, "\x01\x02\x03", 3) == -1, "ac incr remove missing", round);
+
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    match_result_t *exp = match_result_create_ex(16, MATCH_RESULT_GROW);
+    brute_search(s, slen, patterns, pnum, removed, exp);
+    ac_search(ac, s, slen, got);
+    check(result_equal(got, exp), "ac incr search", round);
+    check(ac_count(ac, s, slen) == exp->size, "ac incr count", round);
+
+    AC *ref = ac_create_typed(AC_LEVEL_PART, type);
+    for (int k = 0; k < pnum; k++) {
+        ac_insert(ref, patterns[k], strlen(patterns[k]));
+    }
+    for (int k = 0; k < pnum; k++) {
+        if (removed[k]) {
+            ac_remove(ref, patterns[k], strlen(patterns[k]));
+        }
+    }
+    ac_build(ref);
+    int ok = ref->trie->state_num == ac->trie->state_num;
+    for (int i = 0; ok && i < ref->trie->state_num; i++) {
+        ok = ref->next[i] == ac->next[i] && ref->suff[i] == ac->suff[i] && ref->outn[i] == ac->outn[i];
+    }
+    check(ok, "ac incr rebuilt tables", round);
+
+    // 增量修改后重新构建，结果不变
+    ac_build(ac);
+    got->size = 0;
+    ac_search(ac, s, slen, got);
+    check(result_equal(got, exp), "ac incr rebuild search", round);
+
+    // 重新插入删除过的模式串，分配新id，匹配数恢复
+    int removed_none[32] = {0};
+    exp->size = 0;
+    brute_search(s, slen, patterns, pnum, removed_none, exp);
+    for (int k = 0; k < pnum; k++) {
+        if (removed[k]) {
+            ac_insert(ac, patterns[k], strlen(patterns[k]));
+        }
+    }
+    check(ac_count(ac, s, slen) == exp->size, "ac incr reinsert count", round);
+
+    match_result_destroy(got);
+    match_result_destroy(exp);
+    ac_destroy(ref);
+    ac_destroy(ac);
+}
+
+/**
+ * @brief 随机模式串集合，逐个状态转移表实现检查增量插入和删除
+ */
+static void ac_incr_random_test() {
+    const char *alphas[] = {"ab", "ACGT", "abcdefghij", "\x01\x02\x03\x07\x80\xff"};
+    int anum = sizeof(alphas) / sizeof(alphas[0]);
+    STTableType types[] = {STTABLE_TYPE_LIST, STTABLE_TYPE_ARRAY, STTABLE_TYPE_HASHT, STTABLE_TYPE_DBARR,
+                           STTABLE_TYPE_OHASH, STTABLE_TYPE_BITMAP, STTABLE_TYPE_HYBRID};
+    int tnum = sizeof(types) / sizeof(types[0]);
+    unsigned seed = 12345;
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        const char *alpha = alphas[round % anum];
+        int an = strlen(alpha);
+        char buf[32][12];
+        const char *patterns[32];
+        int pnum = 0;
+        int num = 1 + rand_next(&seed) % 32;
+        for (int i = 0; i < num; i++) {
+            int len = 1 + rand_next(&seed) % 10;
+            for (int j = 0; j < len; j++) {
+                buf[pnum][j] = alpha[rand_next(&seed) % an];
+            }
+            buf[pnum][len] = '\0';
+            int dup = 0;
+            for (int k = 0; k < pnum && !dup; k++) {
+                dup = strcmp(buf[k], buf[pnum]) == 0;
+            }
+            if (!dup) {
+                patterns[pnum] = buf[pnum];
+                ++pnum;
+            }
+        }
+        char s[256];
+        int slen = 1 + rand_next(&seed) % 255;
+        for (int i = 0; i < slen; i++) {
+            s[i] = alpha[rand_next(&seed) % an];
+        }
+        for (int t = 0; t < tnum; t++) {
+            ac_incr_round(types[t], patterns, pnum, s, slen, &seed, round);
+        }
+    }
+}
+
+int main() {
+    ac_incr_random_test();
+    printf("test_ac_incr: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+
+#define RANDOM_ROUNDS 300
+#define MAX_PATTERN_NUM 30
+#define MAX_PATTERN_LEN 8
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+/**
+ * @brief 检查完全自动机的输出划分和展平的输出列表
+ * 有输出的状态恰为id不小于out_min的状态；每个状态的输出列表与逐个比较得到的结果一致：
+ * 状态对应的串以之为后缀的模式串，重复插入的只取第一次的id，按长度从长到短排列
+ */
+static int ac_output_ok(const AC *ac, const char **patterns, int pnum) {
+    const Trie *trie = ac->trie;
+    if (ac->out_min < 1 || ac->out_min > trie->state_num) {
+        return 0;
+    }
+    for (int i = 0; i < trie->state_num; i++) {
+        char str[MAX_PATTERN_LEN];
+        int depth = trie->states[i].depth;
+        for (int j = i, d = depth; j != 0; j = trie->states[j].parent) {
+            str[--d] = trie->states[j].c;
+        }
+        int num = 0;
+        const ac_output_t *out = i >= ac->out_min ? ac->outs + ac->outl[i - ac->out_min].off : NULL;
+        for (int len = depth; len > 0; len--) {
+            int pid = -1;
+            for (int k = 0; k < pnum && pid == -1; k++) {
+                if ((int)strlen(patterns[k]) == len && memcmp(str + depth - len, patterns[k], len) == 0) {
+                    pid = k;
+                }
+            }
+            if (pid == -1) {
+                continue;
+            }
+            if (out == NULL || num >= ac->outl[i - ac->out_min].num || out[num].len != len || out[num].pid != pid) {
+                return 0;
+            }
+            ++num;
+        }
+        if (ac->outn[i] != num || (num != 0) != (i >= ac->out_min)) {
+            return 0;
+        }
+        if (out != NULL && ac->outl[i - ac->out_min].num != num) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 随机模式串集合，检查数组表和混合表完全自动机构建及重新布局后的输出划分
+ */
+static void ac_output_random_test() {
+    unsigned seed = 12345;
+    char buf[MAX_PATTERN_NUM][MAX_PATTERN_LEN + 1];
+    const char *patterns[MAX_PATTERN_NUM];
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        int pnum = 1 + rand_next(&seed) % MAX_PATTERN_NUM;
+        int sigma = 2 + round % 3;
+        for (int k = 0; k < pnum; k++) {
+            int len = 1 + rand_next(&seed) % MAX_PATTERN_LEN;
+            for (int j = 0; j < len; j++) {
+                buf[k][j] = 'a' + rand_next(&seed) % sigma;
+            }
+            buf[k][len] = '\0';
+            patterns[k] = buf[k];
+        }
+
+        AC *ac = ac_create_ex(patterns, pnum, AC_LEVEL_FULL);
+        check(ac_output_ok(ac, patterns, pnum), "array build", round);
+        check(ac_relayout(ac, NULL) == 0 && ac_output_ok(ac, patterns, pnum), "array relayout", round);
+        ac_destroy(ac);
+
+        ac = ac_create_typed(AC_LEVEL_FULL, STTABLE_TYPE_HYBRID);
+        for (int k = 0; k < pnum; k++) {
+            ac_insert(ac, patterns[k], strlen(patterns[k]));
+        }
+        ac_build(ac);
+        check(ac_output_ok(ac, patterns, pnum), "hybrid build", round);
+        ac_destroy(ac);
+    }
+}
+
+int main() {
+    ac_output_random_test();
+    printf("test_ac_output: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
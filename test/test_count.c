@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+#include "oracle.h"
+#include "wum.h"
+
+#define RANDOM_ROUNDS 1000
+#define MAX_PATTERN_NUM 16
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+/**
+ * @brief 逐位置比较统计匹配个数
+ */
+static int64_t brute_count(const char *s, int slen, const char **patterns, int pnum) {
+    int64_t count = 0;
+    for (int i = 0; i < slen; i++) {
+        for (int k = 0; k < pnum; k++) {
+            int plen = strlen(patterns[k]);
+            if (i + plen <= slen && memcmp(s + i, patterns[k], plen) == 0) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 计数与存在性判断分别和逐位置比较、完整匹配结果对比
+ */
+static void count_check(const char *name, int64_t count, int contains, int64_t size, int64_t exp, int round) {
+    check(count == exp && size == exp && contains == (exp != 0), name, round);
+}
+
+/**
+ * @brief 随机模式串集合和文本，检查各引擎的只计数与只判断存在的匹配模式
+ * 字母表较小时匹配密集，较大时常有不含任何匹配的文本，两种情况都覆盖
+ */
+static void count_random_test() {
+    unsigned seed = 12345;
+    char buf[MAX_PATTERN_NUM][12];
+    const char *patterns[MAX_PATTERN_NUM];
+    char s[256];
+    STTableType types[] = {STTABLE_TYPE_LIST, STTABLE_TYPE_ARRAY, STTABLE_TYPE_HASHT, STTABLE_TYPE_DBARR,
+                           STTABLE_TYPE_OHASH, STTABLE_TYPE_BITMAP, STTABLE_TYPE_HYBRID};
+    int ntypes = sizeof(types) / sizeof(types[0]);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        int sigma = round % 2 == 0 ? 3 : 20;
+        int pnum = 1 + rand_next(&seed) % MAX_PATTERN_NUM;
+        for (int k = 0; k < pnum; k++) {
+            int dup;
+            do {
+                int len = 1 + rand_next(&seed) % 10;
+                for (int j = 0; j < len; j++) {
+                    buf[k][j] = 'a' + rand_next(&seed) % sigma;
+                }
+                buf[k][len] = '\0';
+                dup = 0;
+                for (int i = 0; i < k && !dup; i++) {
+                    dup = strcmp(buf[i], buf[k]) == 0;
+                }
+            } while (dup);
+            patterns[k] = buf[k];
+        }
+        int slen = rand_next(&seed) % sizeof(s);
+        for (int i = 0; i < slen; i++) {
+            s[i] = 'a' + rand_next(&seed) % sigma;
+        }
+        int64_t exp = brute_count(s, slen, patterns, pnum);
+        match_result_t *result = match_result_create_ex(64, MATCH_RESULT_GROW);
+
+        AC *ac = ac_create_ex(patterns, pnum, AC_LEVEL_FULL);
+        match_result_reset(result);
+        ac_search(ac, s, slen, result);
+        count_check("ac full", ac_count(ac, s, slen), ac_contains(ac, s, slen), result->size, exp, round);
+        ac_destroy(ac);
+
+        STTableType type = types[round % ntypes];
+        ac = ac_create_typed(AC_LEVEL_PART, type);
+        for (int k = 0; k < pnum; k++) {
+            ac_insert(ac, patterns[k], strlen(patterns[k]));
+        }
+        ac_build(ac);
+        match_result_reset(result);
+        ac_search(ac, s, slen, result);
+        count_check("ac part", ac_count(ac, s, slen), ac_contains(ac, s, slen), result->size, exp, round);
+        ac_destroy(ac);
+
+        Wum *wum = wum_create_ex(patterns, pnum, 1 + round % 3);
+        match_result_reset(result);
+        wum_search(wum, s, slen, result);
+        count_check("wum", wum_count(wum, s, slen), wum_contains(wum, s, slen), result->size, exp, round);
+        wum_destroy(wum);
+
+        Oracle *orc = oracle_create_ex(patterns, pnum);
+        match_result_reset(result);
+        oracle_search(orc, s, slen, result);
+        count_check("sbom", oracle_count(orc, s, slen), oracle_contains(orc, s, slen), result->size, exp, round);
+        oracle_destroy(orc);
+
+        match_result_destroy(result);
+    }
+}
+
+int main() {
+    count_random_test();
+    printf("test_count: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dat.h"
+
+#define RANDOM_ROUNDS 3000
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    return x->len - y->len;
+}
+
+/**
+ * @brief 与逐位置比较的结果对比，模式串互不相同，匹配项按位置和长度排序后逐项相等
+ */
+static int dat_matches_brute(const char *s, int slen, const char **patterns, int pnum) {
+    DATrie *dat = dat_create_ex(patterns, pnum);
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    match_result_t *exp = match_result_create_ex(16, MATCH_RESULT_GROW);
+    dat_search(dat, s, slen, got);
+    for (int i = 0; i < slen; i++) {
+        for (int k = 0; k < pnum; k++) {
+            int plen = strlen(patterns[k]);
+            if (i + plen <= slen && memcmp(s + i, patterns[k], plen) == 0) {
+                match_result_append(exp, plen, i, k);
+            }
+        }
+    }
+    qsort(got->items, got->size, sizeof(match_item_t), item_cmp);
+    qsort(exp->items, exp->size, sizeof(match_item_t), item_cmp);
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    match_result_destroy(got);
+    match_result_destroy(exp);
+    dat_destroy(dat);
+    return ok;
+}
+
+/**
+ * @brief 后缀比较不越过文本长度，文本截断处不能匹配
+ */
+static void dat_tail_bound_test() {
+    const char *p[] = {"abcd"};
+    const char *s = "abcd";
+    for (int slen = 0; slen <= 4; slen++) {
+        check(dat_matches_brute(s, slen, p, 1), "dat tail bound", slen);
+    }
+}
+
+/**
+ * @brief 根节点下的0x01转移落在根节点单元上，不能当作空闲单元覆盖根节点
+ */
+static void dat_root_cell_test() {
+    const char *p[] = {"\x08\x09\x07\x01\x06\x07", "\x01\x06\x05", "\x03\x07"};
+    const char *s = "\x01\x06\x05\x08\x09\x07\x01\x06\x07\x03\x07";
+    check(dat_matches_brute(s, strlen(s), p, 3), "dat root cell", 0);
+}
+
+/**
+ * @brief 随机模式串集合，覆盖叶子节点重定位、冲突节点为源节点父节点等构建路径
+ */
+static void dat_random_test() {
+    const char *alphas[] = {"ab", "ACGT", "abcdefghij", "\x01\x02\x03\x07\x80\xff"};
+    int anum = sizeof(alphas) / sizeof(alphas[0]);
+    unsigned seed = 12345;
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        const char *alpha = alphas[round % anum];
+        int an = strlen(alpha);
+        char buf[32][12];
+        const char *patterns[32];
+        int pnum = 0;
+        int num = 1 + rand_next(&seed) % 32;
+        for (int i = 0; i < num; i++) {
+            int len = 1 + rand_next(&seed) % 10;
+            for (int j = 0; j < len; j++) {
+                buf[pnum][j] = alpha[rand_next(&seed) % an];
+            }
+            buf[pnum][len] = '\0';
+            int dup = 0;
+            for (int k = 0; k < pnum && !dup; k++) {
+                dup = strcmp(buf[k], buf[pnum]) == 0;
+            }
+            if (!dup) {
+                patterns[pnum] = buf[pnum];
+                ++pnum;
+            }
+        }
+        char s[256];
+        int slen = 1 + rand_next(&seed) % 255;
+        for (int i = 0; i < slen; i++) {
+            s[i] = alpha[rand_next(&seed) % an];
+        }
+        check(dat_matches_brute(s, slen, patterns, pnum), "dat random", round);
+    }
+}
+
+int main() {
+    dat_tail_bound_test();
+    dat_root_cell_test();
+    dat_random_test();
+    printf("test_dat: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
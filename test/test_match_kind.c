@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+#include "dat.h"
+
+#define RANDOM_ROUNDS 1000
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    return x->len - y->len;
+}
+
+/**
+ * @brief 匹配项按位置和长度排序后逐项比较，含模式串id
+ */
+static int result_equal(match_result_t *got, const match_result_t *exp) {
+    qsort(got->items, got->size, sizeof(match_item_t), item_cmp);
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    return ok;
+}
+
+/**
+ * @brief 逐位置比较得到指定语义的匹配，结果按位置排序
+ * 标准语义报告全部匹配；不重叠语义从左到右取起点最左的匹配，
+ * 起点相同时最左优先取下标最小的模式串，最左最长取最长的模式串，之后从匹配结束处继续
+ */
+static void brute_search_kind(const char *s, int slen, const char **patterns, int pnum, MatchKind kind,
+                              match_result_t *result) {
+    for (int i = 0; i < slen;) {
+        int best = -1, blen = 0;
+        for (int k = 0; k < pnum; k++) {
+            int plen = strlen(patterns[k]);
+            if (i + plen > slen || memcmp(s + i, patterns[k], plen) != 0) {
+                continue;
+            }
+            if (kind == MATCH_KIND_STANDARD) {
+                match_result_append(result, plen, i, k);
+            } else if (best == -1 || (kind == MATCH_KIND_LEFTMOST_LONGEST && plen > blen)) {
+                best = k;
+                blen = plen;
+            }
+        }
+        if (best != -1) {
+            match_result_append(result, blen, i, best);
+            i += blen;
+        } else {
+            ++i;
+        }
+    }
+    qsort(result->items, result->size, sizeof(match_item_t), item_cmp);
+}
+
+/**
+ * @brief 随机模式串集合，各自动机配置和DAT的三种匹配语义与逐位置比较的结果对比
+ */
+static void match_kind_random_test() {
+    const char *alphas[] = {"ab", "ACGT", "abcdefghij", "\x01\x02\x03\x07\x80\xff"};
+    int anum = sizeof(alphas) / sizeof(alphas[0]);
+    STTableType types[] = {STTABLE_TYPE_LIST, STTABLE_TYPE_ARRAY, STTABLE_TYPE_HASHT, STTABLE_TYPE_DBARR,
+                           STTABLE_TYPE_OHASH, STTABLE_TYPE_BITMAP, STTABLE_TYPE_HYBRID};
+    int tnum = sizeof(types) / sizeof(types[0]);
+    MatchKind kinds[] = {MATCH_KIND_STANDARD, MATCH_KIND_LEFTMOST_FIRST, MATCH_KIND_LEFTMOST_LONGEST};
+    const char *names[] = {"standard", "leftmost-first", "leftmost-longest"};
+    unsigned seed = 12345;
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        const char *alpha = alphas[round % anum];
+        int an = strlen(alpha);
+        char buf[32][12];
+        const char *patterns[32];
+        int pnum = 0;
+        int num = 1 + rand_next(&seed) % 32;
+        for (int i = 0; i < num; i++) {
+            int len = 1 + rand_next(&seed) % 10;
+            for (int j = 0; j < len; j++) {
+                buf[pnum][j] = alpha[rand_next(&seed) % an];
+            }
+            buf[pnum][len] = '\0';
+            int dup = 0;
+            for (int k = 0; k < pnum && !dup; k++) {
+                dup = strcmp(buf[k], buf[pnum]) == 0;
+            }
+            if (!dup) {
+                patterns[pnum] = buf[pnum];
+                ++pnum;
+            }
+        }
+        char s[256];
+        int slen = 1 + rand_next(&seed) % 255;
+        for (int i = 0; i < slen; i++) {
+            s[i] = alpha[rand_next(&seed) % an];
+        }
+        // 不完全自动机覆盖全部状态转移表实现，完全自动机覆盖数组和混合表
+        AC *acs[9];
+        for (int t = 0; t < tnum; t++) {
+            acs[t] = ac_create_typed(AC_LEVEL_PART, types[t]);
+        }
+        acs[7] = ac_create_typed(AC_LEVEL_FULL, STTABLE_TYPE_ARRAY);
+        acs[8] = ac_create_typed(AC_LEVEL_FULL, STTABLE_TYPE_HYBRID);
+        for (int t = 0; t < 9; t++) {
+            for (int k = 0; k < pnum; k++) {
+                ac_insert(acs[t], patterns[k], strlen(patterns[k]));
+            }
+            ac_build(acs[t]);
+        }
+        DATrie *dat = dat_create_ex(patterns, pnum);
+        for (int m = 0; m < 3; m++) {
+            match_result_t *exp = match_result_create_ex(16, MATCH_RESULT_GROW);
+            match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+            brute_search_kind(s, slen, patterns, pnum, kinds[m], exp);
+            for (int t = 0; t < 9; t++) {
+                got->size = 0;
+                ac_search_kind(acs[t], s, slen, kinds[m], got);
+                check(result_equal(got, exp), names[m], round);
+            }
+            got->size = 0;
+            dat_search_kind(dat, s, slen, kinds[m], got);
+            check(result_equal(got, exp), names[m], round);
+            match_result_destroy(got);
+            match_result_destroy(exp);
+        }
+        dat_destroy(dat);
+        for (int t = 0; t < 9; t++) {
+            ac_destroy(acs[t]);
+        }
+    }
+}
+
+int main() {
+    match_kind_random_test();
+    printf("test_match_kind: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
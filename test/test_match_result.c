@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+#include "xssm.h"
+
+#define BATCH_ROUNDS 200
+#define BATCH_MAX_DOCS (3 * AC_BATCH_LANES + 5)
+
+static int failed = 0;
+
+static void check(int cond, const char *name) {
+    if (!cond) {
+        printf("%s failed\n", name);
+        ++failed;
+    }
+}
+
+/**
+ * @brief 固定容量模式下容量满后继续扫描，丢弃的匹配全部计入dropped
+ */
+static void fixed_overflow_test() {
+    const char *p[] = {"he", "she", "his", "hers", "e"};
+    const char *s = "ushershehishe";
+    ACLevel levels[] = {AC_LEVEL_PART, AC_LEVEL_FULL};
+    for (int i = 0; i < 2; i++) {
+        AC *ac = ac_create_ex(p, 5, levels[i]);
+        match_result_t *all = match_result_create_ex(4, MATCH_RESULT_GROW);
+        match_result_t *result = match_result_create(2);
+        ac_search(ac, s, strlen(s), all);
+        ac_search(ac, s, strlen(s), result);
+        check(all->size == 11, "fixed overflow: all matches");
+        check(result->size == 2 && result->dropped == all->size - 2, "fixed overflow: dropped count");
+        match_result_destroy(result);
+        match_result_destroy(all);
+        ac_destroy(ac);
+    }
+}
+
+/**
+ * @brief 批量匹配中一个文档的固定容量结果满后，其他文档的匹配不受影响
+ */
+static void batch_fixed_overflow_test() {
+    const char *p[] = {"he", "she", "his", "hers", "e"};
+    const char *s = "ushershehishe";
+    AC *ac = ac_create_ex(p, 5, AC_LEVEL_FULL);
+    match_doc_t docs[2] = {{s, (int)strlen(s)}, {s, (int)strlen(s)}};
+    match_result_t *results[2] = {match_result_create(2), match_result_create_ex(4, MATCH_RESULT_GROW)};
+    ac_search_batch(ac, docs, 2, results);
+    check(results[0]->size == 2 && results[0]->dropped == 9, "batch fixed overflow: dropped count");
+    check(results[1]->size == 11, "batch fixed overflow: other document");
+    match_result_destroy(results[0]);
+    match_result_destroy(results[1]);
+    ac_destroy(ac);
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+/**
+ * @brief 两个结果的匹配项逐项相同，顺序也相同
+ */
+static int result_same(const match_result_t *got, const match_result_t *exp) {
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    return ok;
+}
+
+/**
+ * @brief 批量回调把匹配项按文档下标分发到各自的结果，收到stop_at个匹配项后要求停止
+ */
+typedef struct {
+    match_result_t **results;
+    int received;
+    int stop_at;  // 0表示不停止
+} batch_sink_t;
+
+static int batch_sink(int doc, const match_item_t *item, void *ctx) {
+    batch_sink_t *sink = (batch_sink_t *)ctx;
+    match_result_append(sink->results[doc], item->len, item->pos, item->id);
+    ++sink->received;
+    return sink->stop_at > 0 && sink->received >= sink->stop_at;
+}
+
+/**
+ * @brief 随机文档集合批量匹配，每个文档的结果与单独匹配完全相同
+ * 文档数不是交错路数的整数倍，含空文档和长短悬殊的文档，交错扫描中途有路提前结束
+ */
+static void batch_random_test() {
+    const char *p[] = {"ab", "abc", "bca", "c", "cabca", "bb", "aaaa"};
+    static char buf[BATCH_MAX_DOCS][600];
+    match_doc_t docs[BATCH_MAX_DOCS];
+    match_result_t *exp[BATCH_MAX_DOCS], *got[BATCH_MAX_DOCS], *cbgot[BATCH_MAX_DOCS];
+    for (int i = 0; i < BATCH_MAX_DOCS; i++) {
+        exp[i] = match_result_create_ex(16, MATCH_RESULT_GROW);
+        got[i] = match_result_create_ex(16, MATCH_RESULT_GROW);
+        cbgot[i] = match_result_create_ex(16, MATCH_RESULT_GROW);
+    }
+    unsigned seed = 12345;
+    AC *acs[3] = {ac_create_ex(p, 7, AC_LEVEL_PART), ac_create_ex(p, 7, AC_LEVEL_FULL),
+                  ac_create_typed(AC_LEVEL_FULL, STTABLE_TYPE_HYBRID)};
+    for (int k = 0; k < 7; k++) {
+        ac_insert(acs[2], p[k], strlen(p[k]));
+    }
+    ac_build(acs[2]);
+    const char *names[3] = {"batch part", "batch full", "batch full hybrid"};
+    for (int round = 0; round < BATCH_ROUNDS; round++) {
+        int ndocs = rand_next(&seed) % (BATCH_MAX_DOCS + 1);
+        for (int d = 0; d < ndocs; d++) {
+            int len = rand_next(&seed) % 4 == 0 ? 0 : (int)(rand_next(&seed) % sizeof(buf[d]));
+            for (int i = 0; i < len; i++) {
+                buf[d][i] = 'a' + rand_next(&seed) % 3;
+            }
+            docs[d].s = buf[d];
+            docs[d].len = len;
+        }
+        for (int a = 0; a < 3; a++) {
+            int64_t total = 0;
+            for (int d = 0; d < ndocs; d++) {
+                match_result_reset(exp[d]);
+                match_result_reset(got[d]);
+                match_result_reset(cbgot[d]);
+                ac_search(acs[a], docs[d].s, docs[d].len, exp[d]);
+                total += exp[d]->size;
+            }
+            ac_search_batch(acs[a], docs, ndocs, got);
+            batch_sink_t sink = {cbgot, 0, 0};
+            int ret = ac_search_batch_cb(acs[a], docs, ndocs, batch_sink, &sink);
+            int ok = ret == 0 && sink.received == total;
+            for (int d = 0; ok && d < ndocs; d++) {
+                ok = result_same(got[d], exp[d]) && result_same(cbgot[d], exp[d]);
+            }
+            check(ok, names[a]);
+
+            if (total > 1) {
+                batch_sink_t stop = {cbgot, 0, (int)(1 + rand_next(&seed) % total)};
+                ret = ac_search_batch_cb(acs[a], docs, ndocs, batch_sink, &stop);
+                check(ret == -1 && stop.received == stop.stop_at, "batch callback stop");
+            }
+        }
+    }
+    for (int a = 0; a < 3; a++) {
+        ac_destroy(acs[a]);
+    }
+    for (int i = 0; i < BATCH_MAX_DOCS; i++) {
+        match_result_destroy(exp[i]);
+        match_result_destroy(got[i]);
+        match_result_destroy(cbgot[i]);
+    }
+}
+
+/**
+ * @brief 输出函数收到stop_at个匹配项后要求停止
+ */
+typedef struct {
+    int received;
+    int stop_at;
+} stop_sink_t;
+
+static int stop_sink(const match_item_t *items, int size, void *ctx) {
+    (void)items;
+    stop_sink_t *sink = (stop_sink_t *)ctx;
+    sink->received += size;
+    return sink->received >= sink->stop_at;
+}
+
+#define SINK_STOP_TEST(name, create, search, destroy)                      \
+    do {                                                                   \
+        stop_sink_t sink = {0, 4};                                         \
+        match_result_t *result = match_result_create(1);                   \
+        match_result_set_sink(result, stop_sink, &sink);                   \
+        void *obj = create(p, plen);                                       \
+        search(obj, s, slen, result);                                      \
+        match_result_flush(result);                                        \
+        destroy(obj);                                                      \
+        check(sink.received == sink.stop_at, name ": sink stop");          \
+        match_result_destroy(result);                                      \
+    } while (0)
+
+/**
+ * @brief 输出函数要求停止后单模式串扫描立即结束，停止要求保持到重置
+ */
+static void sink_stop_test() {
+    const char *s = "abababababababababababababababab";
+    const char *p = "ab";
+    int slen = strlen(s), plen = strlen(p);
+    SINK_STOP_TEST("kmp", kmp_pattern_create, kmp_pattern_search, kmp_pattern_destroy);
+    SINK_STOP_TEST("fam", fam_pattern_create, fam_pattern_search, fam_pattern_destroy);
+    SINK_STOP_TEST("shift and", shift_and_pattern_create, shift_and_pattern_search, shift_and_pattern_destroy);
+    SINK_STOP_TEST("shift or", shift_or_pattern_create, shift_or_pattern_search, shift_or_pattern_destroy);
+    SINK_STOP_TEST("bm", bm_pattern_create, bm_pattern_search, bm_pattern_destroy);
+    SINK_STOP_TEST("horspool", horspool_pattern_create, horspool_pattern_search, horspool_pattern_destroy);
+    SINK_STOP_TEST("sunday", sunday_pattern_create, sunday_pattern_search, sunday_pattern_destroy);
+    SINK_STOP_TEST("bndm", bndm_pattern_create, bndm_pattern_search, bndm_pattern_destroy);
+    SINK_STOP_TEST("bom", bom_pattern_create, bom_pattern_search, bom_pattern_destroy);
+    SINK_STOP_TEST("karp rabin", kr_pattern_create, kr_pattern_search, kr_pattern_destroy);
+
+    stop_sink_t sink = {0, 1};
+    match_result_t *result = match_result_create(1);
+    match_result_set_sink(result, stop_sink, &sink);
+    match_result_append(result, 2, 0, 0);
+    check(match_result_append(result, 2, 2, 0) != 0, "sink stop: stop on full");
+    check(match_result_append(result, 2, 4, 0) != 0 && match_result_flush(result) != 0, "sink stop: sticky");
+    check(sink.received == 1, "sink stop: no calls after stop");
+    match_result_reset(result);
+    check(match_result_append(result, 2, 0, 0) == 0 && match_result_flush(result) != 0 && sink.received == 2,
+          "sink stop: reset");
+    match_result_destroy(result);
+}
+
+int main() {
+    fixed_overflow_test();
+    batch_fixed_overflow_test();
+    batch_random_test();
+    sink_stop_test();
+    printf("test_match_result: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
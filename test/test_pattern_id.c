@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+#include "bndm.h"
+#include "dat.h"
+#include "horspool.h"
+#include "oracle.h"
+#include "shift.h"
+#include "trie.h"
+#include "wum.h"
+
+#define RANDOM_ROUNDS 300
+#define MAX_PATTERN_NUM 40
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    if (x->len != y->len) {
+        return x->len - y->len;
+    }
+    return x->id - y->id;
+}
+
+/**
+ * @brief 匹配项按位置、长度和模式串id排序后逐项比较
+ */
+static int result_equal(match_result_t *got, const match_result_t *exp) {
+    qsort(got->items, got->size, sizeof(match_item_t), item_cmp);
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    return ok;
+}
+
+/**
+ * @brief 逐位置比较得到期望结果，id为模式串的插入下标，重复的模式串只以第一次的下标报告一次
+ */
+static void brute_search(const char *s, int slen, const char **patterns, int pnum, match_result_t *result) {
+    for (int i = 0; i < slen; i++) {
+        for (int k = 0; k < pnum; k++) {
+            int plen = strlen(patterns[k]);
+            int first = 1;
+            for (int j = 0; j < k && first; j++) {
+                first = strcmp(patterns[j], patterns[k]) != 0;
+            }
+            if (first && i + plen <= slen && memcmp(s + i, patterns[k], plen) == 0) {
+                match_result_append(result, plen, i, k);
+            }
+        }
+    }
+    qsort(result->items, result->size, sizeof(match_item_t), item_cmp);
+}
+
+/**
+ * @brief 随机模式串集合，多数模式串等长且含重复插入，检查各引擎报告的模式串id
+ * 等长模式串只能靠id区分；重复插入仍会占用一个id，之后的模式串id不前移
+ */
+static void pattern_id_random_test() {
+    unsigned seed = 12345;
+    char buf[MAX_PATTERN_NUM][8];
+    const char *patterns[MAX_PATTERN_NUM];
+    char s[512];
+    match_result_t *exp = match_result_create_ex(256, MATCH_RESULT_GROW);
+    match_result_t *got = match_result_create_ex(256, MATCH_RESULT_GROW);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        int pnum = 1 + rand_next(&seed) % MAX_PATTERN_NUM;
+        int plen = 2 + round % 4;
+        for (int k = 0; k < pnum; k++) {
+            if (k > 0 && rand_next(&seed) % 8 == 0) {
+                strcpy(buf[k], buf[rand_next(&seed) % k]);
+            } else {
+                int len = plen;
+                if (rand_next(&seed) % 4 == 0) {
+                    len = 1 + rand_next(&seed) % 7;
+                }
+                for (int j = 0; j < len; j++) {
+                    buf[k][j] = 'a' + rand_next(&seed) % 3;
+                }
+                buf[k][len] = '\0';
+            }
+            patterns[k] = buf[k];
+        }
+        int slen = rand_next(&seed) % sizeof(s);
+        for (int i = 0; i < slen; i++) {
+            s[i] = 'a' + rand_next(&seed) % 3;
+        }
+        match_result_reset(exp);
+        brute_search(s, slen, patterns, pnum, exp);
+
+        Trie *trie = trie_create_ex(patterns, pnum, STTABLE_TYPE_ARRAY);
+        match_result_reset(got);
+        trie_search(trie, s, slen, got);
+        check(result_equal(got, exp), "trie", round);
+        trie_destroy(trie);
+
+        AC *ac = ac_create_ex(patterns, pnum, AC_LEVEL_FULL);
+        match_result_reset(got);
+        ac_search(ac, s, slen, got);
+        check(result_equal(got, exp), "ac full", round);
+        ac_destroy(ac);
+
+        ac = ac_create_ex(patterns, pnum, AC_LEVEL_PART);
+        match_result_reset(got);
+        ac_search(ac, s, slen, got);
+        check(result_equal(got, exp), "ac part", round);
+        ac_destroy(ac);
+
+        Wum *wum = wum_create_ex(patterns, pnum, 1);
+        match_result_reset(got);
+        wum_search(wum, s, slen, got);
+        check(result_equal(got, exp), "wum", round);
+        wum_destroy(wum);
+
+        Oracle *orc = oracle_create_ex(patterns, pnum);
+        match_result_reset(got);
+        oracle_search(orc, s, slen, got);
+        check(result_equal(got, exp), "sbom", round);
+        oracle_destroy(orc);
+
+        ShiftNFA *snfa = shift_nfa_create_ex(patterns, pnum);
+        match_result_reset(got);
+        shift_nfa_search(snfa, s, slen, got);
+        check(result_equal(got, exp), "shift", round);
+        shift_nfa_destroy(snfa);
+
+        BndmNFA *bnfa = bndm_nfa_create_ex(patterns, pnum);
+        match_result_reset(got);
+        bndm_nfa_search(bnfa, s, slen, got);
+        check(result_equal(got, exp), "bndm", round);
+        bndm_nfa_destroy(bnfa);
+
+        Horspool *hsp = horspool_create_ex(patterns, pnum, 1);
+        match_result_reset(got);
+        horspool_trie_search(hsp, s, slen, got);
+        check(result_equal(got, exp), "horspool", round);
+        horspool_destroy(hsp);
+
+        DATrie *dat = dat_create_ex(patterns, pnum);
+        match_result_reset(got);
+        dat_search(dat, s, slen, got);
+        check(result_equal(got, exp), "dat", round);
+        dat_destroy(dat);
+    }
+    match_result_destroy(got);
+    match_result_destroy(exp);
+}
+
+int main() {
+    pattern_id_random_test();
+    printf("test_pattern_id: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ac.h"
+#include "dat.h"
+
+#define BIG_PATTERN_NUM 2000
+
+static int failed = 0;
+
+static void check(int cond, const char *name) {
+    if (!cond) {
+        printf("%s failed\n", name);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+/**
+ * @brief 已加载的映像被新映像覆盖保存后继续匹配
+ * 新映像比旧映像小，原地截断重写时旧映射越过文件末尾的页面会触发SIGBUS
+ */
+static void image_resave_test() {
+    const char *path = "test_smimage.img";
+    static char buf[BIG_PATTERN_NUM][12];
+    static const char *big[BIG_PATTERN_NUM];
+    unsigned seed = 12345;
+    for (int i = 0; i < BIG_PATTERN_NUM; i++) {
+        for (int j = 0; j < 11; j++) {
+            buf[i][j] = 'a' + rand_next(&seed) % 26;
+        }
+        buf[i][11] = '\0';
+        big[i] = buf[i];
+    }
+    const char *small[] = {"zz"};
+    char s[64];
+    snprintf(s, sizeof(s), "xx%szz%s", big[0], big[BIG_PATTERN_NUM - 1]);
+    int slen = strlen(s);
+
+    AC *built = ac_create_ex(big, BIG_PATTERN_NUM, AC_LEVEL_FULL);
+    check(ac_save(built, path) == 0, "ac resave: save");
+    ac_destroy(built);
+    AC *ac = ac_load(path, 1);
+    check(ac != NULL, "ac resave: load");
+    built = ac_create_ex(small, 1, AC_LEVEL_FULL);
+    check(ac_save(built, path) == 0, "ac resave: save over loaded");
+    ac_destroy(built);
+    if (ac != NULL) {
+        check(ac_count(ac, s, slen) == 2, "ac resave: old image search");
+        ac_destroy(ac);
+    }
+    ac = ac_load(path, 1);
+    check(ac != NULL && ac_count(ac, s, slen) == 1, "ac resave: new image search");
+    if (ac != NULL) {
+        ac_destroy(ac);
+    }
+
+    DATrie *dbuilt = dat_create_ex(big, BIG_PATTERN_NUM);
+    check(dat_save(dbuilt, path) == 0, "dat resave: save");
+    dat_destroy(dbuilt);
+    DATrie *dat = dat_load(path, 1);
+    check(dat != NULL, "dat resave: load");
+    dbuilt = dat_create_ex(small, 1);
+    check(dat_save(dbuilt, path) == 0, "dat resave: save over loaded");
+    dat_destroy(dbuilt);
+    if (dat != NULL) {
+        match_result_t *result = match_result_create(16);
+        dat_search(dat, s, slen, result);
+        check(result->size == 2, "dat resave: old image search");
+        match_result_destroy(result);
+        dat_destroy(dat);
+    }
+    remove(path);
+}
+
+int main() {
+    image_resave_test();
+    printf("test_smimage: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
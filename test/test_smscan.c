@@ -0,0 +1,288 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "smscan.h"
+
+// 文本长度足以让8个线程各分到不少于SMSCAN_PARALLEL_MIN_SIZE的数据，且不能整除线程数
+#define TEXT_SIZE (8 * SMSCAN_PARALLEL_MIN_SIZE + 13)
+#define PATTERN_NUM 6
+#define MAX_THREADS 8
+// 流式扫描的文本跨过若干个读块边界，且不是读块大小的整数倍
+#define STREAM_SIZE (4 * SMSCAN_READ_SIZE + 17)
+
+static int failed = 0;
+
+// arg为并行扫描的线程数或管道每次写入的字节数
+static void check(int cond, const char *name, int arg) {
+    if (!cond) {
+        printf("%s failed, arg %d\n", name, arg);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    return x->len - y->len;
+}
+
+/**
+ * @brief 匹配项按位置和长度排序后逐项比较，含模式串id
+ */
+static int result_equal(match_result_t *got, const match_result_t *exp) {
+    qsort(got->items, got->size, sizeof(match_item_t), item_cmp);
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    return ok;
+}
+
+/**
+ * @brief 逐位置比较得到的期望结果，按位置和长度排序
+ */
+static match_result_t *brute_result(const char **p, int pnum, const char *s, int slen) {
+    match_result_t *exp = match_result_create_ex(1024, MATCH_RESULT_GROW);
+    for (int i = 0; i < slen; i++) {
+        for (int k = 0; k < pnum; k++) {
+            int plen = strlen(p[k]);
+            if (i + plen <= slen && memcmp(s + i, p[k], plen) == 0) {
+                match_result_append(exp, plen, i, k);
+            }
+        }
+    }
+    qsort(exp->items, exp->size, sizeof(match_item_t), item_cmp);
+    return exp;
+}
+
+/**
+ * @brief 1到MAX_THREADS个线程并行扫描，与逐位置比较的结果对比，接缝处不重复不遗漏
+ */
+static void parallel_check(const char *name, const match_scanner_t *scanner, const char *s,
+                           const match_result_t *exp) {
+    for (int n = 1; n <= MAX_THREADS; n++) {
+        match_result_t *got = match_result_create_ex(1024, MATCH_RESULT_GROW);
+        int ret = match_scan_parallel(scanner, s, TEXT_SIZE, n, got);
+        check(ret == 0 && result_equal(got, exp), name, n);
+        match_result_destroy(got);
+    }
+}
+
+/**
+ * @brief 随机文本和模式串，逐个引擎检查并行扫描
+ */
+static void parallel_scan_test() {
+    const char *alpha = "abcd";
+    unsigned seed = 12345;
+    char buf[PATTERN_NUM][12];
+    const char *p[PATTERN_NUM];
+    int pnum = 0;
+    while (pnum < PATTERN_NUM) {
+        int len = 3 + rand_next(&seed) % 6;
+        for (int j = 0; j < len; j++) {
+            buf[pnum][j] = alpha[rand_next(&seed) % 4];
+        }
+        buf[pnum][len] = '\0';
+        int dup = 0;
+        for (int k = 0; k < pnum && !dup; k++) {
+            dup = strcmp(buf[k], buf[pnum]) == 0;
+        }
+        if (!dup) {
+            p[pnum] = buf[pnum];
+            ++pnum;
+        }
+    }
+    char *s = (char *)malloc(TEXT_SIZE);
+    for (int i = 0; i < TEXT_SIZE; i++) {
+        s[i] = alpha[rand_next(&seed) % 4];
+    }
+    match_result_t *exp = brute_result(p, pnum, s, TEXT_SIZE);
+
+    match_scanner_t scanner;
+    Trie *trie = trie_create_ex(p, pnum, STTABLE_TYPE_ARRAY);
+    match_scanner_init_trie(&scanner, trie);
+    parallel_check("trie", &scanner, s, exp);
+    trie_destroy(trie);
+
+    AC *ac = ac_create_ex(p, pnum, AC_LEVEL_FULL);
+    match_scanner_init_ac(&scanner, ac);
+    parallel_check("ac", &scanner, s, exp);
+    ac_destroy(ac);
+
+    Oracle *orc = oracle_create_ex(p, pnum);
+    match_scanner_init_oracle(&scanner, orc);
+    parallel_check("sbom", &scanner, s, exp);
+    oracle_destroy(orc);
+
+    ShiftNFA *snfa = shift_nfa_create_ex(p, pnum);
+    match_scanner_init_shift_nfa(&scanner, snfa);
+    parallel_check("shift", &scanner, s, exp);
+    shift_nfa_destroy(snfa);
+
+    Horspool *hsp = horspool_create_ex(p, pnum, 1);
+    match_scanner_init_horspool(&scanner, hsp);
+    parallel_check("horspool", &scanner, s, exp);
+    horspool_destroy(hsp);
+
+    Wum *wum = wum_create_ex(p, pnum, 1);
+    match_scanner_init_wum(&scanner, wum);
+    parallel_check("wum", &scanner, s, exp);
+    wum_destroy(wum);
+
+    DATrie *dat = dat_create_ex(p, pnum);
+    match_scanner_init_dat(&scanner, dat);
+    parallel_check("dat", &scanner, s, exp);
+    dat_destroy(dat);
+
+    match_result_destroy(exp);
+    free(s);
+}
+
+typedef struct {
+    int fd;
+    const char *s;
+    int slen;
+    int chunk;  // 每次写入的字节数
+} pipe_writer_t;
+
+static void *pipe_writer(void *arg) {
+    pipe_writer_t *w = (pipe_writer_t *)arg;
+    for (int off = 0; off < w->slen;) {
+        int n = w->slen - off < w->chunk ? w->slen - off : w->chunk;
+        ssize_t m = write(w->fd, w->s + off, n);
+        if (m <= 0) {
+            break;
+        }
+        off += (int)m;
+    }
+    close(w->fd);
+    return NULL;
+}
+
+/**
+ * @brief 经管道分块读取扫描，写端按chunk字节分批写入使读块边界落在不同位置
+ */
+static void pipe_check(const char *name, const match_scanner_t *scanner, const char *s, int slen, int chunk,
+                       const match_result_t *exp) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        check(0, name, chunk);
+        return;
+    }
+    pipe_writer_t w = {fds[1], s, slen, chunk};
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, pipe_writer, &w) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        check(0, name, chunk);
+        return;
+    }
+    match_result_t *got = match_result_create_ex(1024, MATCH_RESULT_GROW);
+    int ret = match_scan_fd(scanner, fds[0], match_result_callback, got);
+    pthread_join(tid, NULL);
+    close(fds[0]);
+    check(ret == 0 && result_equal(got, exp), name, chunk);
+    match_result_destroy(got);
+}
+
+/**
+ * @brief 映射普通文件扫描
+ */
+static void file_check(const char *name, const match_scanner_t *scanner, const char *path,
+                       const match_result_t *exp) {
+    match_result_t *got = match_result_create_ex(1024, MATCH_RESULT_GROW);
+    int ret = match_scan_file(scanner, path, match_result_callback, got);
+    check(ret == 0 && result_equal(got, exp), name, 0);
+    match_result_destroy(got);
+}
+
+/**
+ * @brief 文件描述符扫描：普通文件走映射，管道走分块读取
+ * 每个读块边界上都放一个跨边界的模式串，检查保留max_len-1字节的重叠区不重复不遗漏
+ */
+static void fd_scan_test() {
+    const char *path = "test_smscan.txt";
+    const char *alpha = "abcd";
+    const char *p[] = {"abcdabcdabcd", "dcba", "xyzzy", "ab", "cab", "zz"};
+    int pnum = sizeof(p) / sizeof(p[0]);
+    unsigned seed = 54321;
+    char *s = (char *)malloc(STREAM_SIZE);
+    for (int i = 0; i < STREAM_SIZE; i++) {
+        s[i] = alpha[rand_next(&seed) % 4];
+    }
+    for (int b = SMSCAN_READ_SIZE, k = 0; b < STREAM_SIZE; b += SMSCAN_READ_SIZE, k++) {
+        // 最长模式串恰好只留1个字节在边界之后，或较短模式串跨在边界中间
+        if (k % 2 == 0) {
+            memcpy(s + b - 11, p[0], 12);
+        } else {
+            memcpy(s + b - 3, p[2], 5);
+        }
+    }
+    match_result_t *exp = brute_result(p, pnum, s, STREAM_SIZE);
+    const char *empty = "";
+    match_result_t *none = brute_result(p, pnum, empty, 0);
+
+    FILE *fp = fopen(path, "wb");
+    check(fp != NULL && fwrite(s, 1, STREAM_SIZE, fp) == STREAM_SIZE && fclose(fp) == 0, "fd: write file", 0);
+    int chunks[] = {SMSCAN_READ_SIZE, 4096, 4093, 1};
+
+    match_scanner_t scanner;
+    AC *ac = ac_create_ex(p, pnum, AC_LEVEL_FULL);
+    Wum *wum = wum_create_ex(p, pnum, 1);
+    DATrie *dat = dat_create_ex(p, pnum);
+    for (int e = 0; e < 3; e++) {
+        const char *name = e == 0 ? "fd ac" : e == 1 ? "fd wum" : "fd dat";
+        if (e == 0) {
+            match_scanner_init_ac(&scanner, ac);
+        } else if (e == 1) {
+            match_scanner_init_wum(&scanner, wum);
+        } else {
+            match_scanner_init_dat(&scanner, dat);
+        }
+        file_check(name, &scanner, path, exp);
+        for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            // 逐字节写入时只验证一个引擎，避免测试过慢
+            if (chunks[c] > 1 || e == 0) {
+                pipe_check(name, &scanner, s, STREAM_SIZE, chunks[c], exp);
+            }
+        }
+        pipe_check(name, &scanner, empty, 0, 1, none);
+    }
+    ac_destroy(ac);
+    wum_destroy(wum);
+    dat_destroy(dat);
+
+    // 空的普通文件走分块读取
+    fp = fopen(path, "wb");
+    check(fp != NULL && fclose(fp) == 0, "fd: truncate file", 0);
+    ac = ac_create_ex(p, pnum, AC_LEVEL_FULL);
+    match_scanner_init_ac(&scanner, ac);
+    file_check("fd ac empty file", &scanner, path, none);
+    ac_destroy(ac);
+    check(match_scan_file(&scanner, "test_smscan.missing", match_result_callback, none) == -2, "fd: missing file",
+          0);
+
+    remove(path);
+    match_result_destroy(none);
+    match_result_destroy(exp);
+    free(s);
+}
+
+int main() {
+    parallel_scan_test();
+    fd_scan_test();
+    printf("test_smscan: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
@@ -0,0 +1,374 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trie.h"
+#include "ac.h"
+#include "oracle.h"
+
+#define RANDOM_ROUNDS 300
+#define MAX_PATTERN_NUM 32
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+    if (!cond) {
+        printf("%s failed, round %d\n", name, round);
+        ++failed;
+    }
+}
+
+static unsigned rand_next(unsigned *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    return x->len - y->len;
+}
+
+/**
+ * @brief 随机测试用例，模式串互不相同
+ */
+typedef struct {
+    char buf[MAX_PATTERN_NUM][12];
+    const char *patterns[MAX_PATTERN_NUM];
+    int pnum;
+    char s[256];
+    int slen;
+} sttable_case_t;
+
+static void case_random(sttable_case_t *tc, unsigned *seed, int round) {
+    const char *alphas[] = {"ab", "ACGT", "abcdefghij", "\x01\x02\x03\x07\x80\xff"};
+    const char *alpha = alphas[round % (sizeof(alphas) / sizeof(alphas[0]))];
+    int an = strlen(alpha);
+    int num = 1 + rand_next(seed) % MAX_PATTERN_NUM;
+    tc->pnum = 0;
+    for (int i = 0; i < num; i++) {
+        char *p = tc->buf[tc->pnum];
+        int len = 1 + rand_next(seed) % 10;
+        for (int j = 0; j < len; j++) {
+            p[j] = alpha[rand_next(seed) % an];
+        }
+        p[len] = '\0';
+        int dup = 0;
+        for (int k = 0; k < tc->pnum && !dup; k++) {
+            dup = strcmp(tc->buf[k], p) == 0;
+        }
+        if (!dup) {
+            tc->patterns[tc->pnum] = p;
+            ++tc->pnum;
+        }
+    }
+    tc->slen = 1 + rand_next(seed) % 255;
+    for (int i = 0; i < tc->slen; i++) {
+        tc->s[i] = alpha[rand_next(seed) % an];
+    }
+}
+
+/**
+ * @brief 与逐位置比较的结果对比，匹配项按位置和长度排序后逐项相等，含模式串id
+ */
+static int case_matches_brute(const sttable_case_t *tc, match_result_t *got) {
+    match_result_t *exp = match_result_create_ex(16, MATCH_RESULT_GROW);
+    for (int i = 0; i < tc->slen; i++) {
+        for (int k = 0; k < tc->pnum; k++) {
+            int plen = strlen(tc->patterns[k]);
+            if (i + plen <= tc->slen && memcmp(tc->s + i, tc->patterns[k], plen) == 0) {
+                match_result_append(exp, plen, i, k);
+            }
+        }
+    }
+    qsort(got->items, got->size, sizeof(match_item_t), item_cmp);
+    qsort(exp->items, exp->size, sizeof(match_item_t), item_cmp);
+    int ok = got->size == exp->size;
+    for (int i = 0; ok && i < exp->size; i++) {
+        ok = got->items[i].pos == exp->items[i].pos && got->items[i].len == exp->items[i].len
+             && got->items[i].id == exp->items[i].id;
+    }
+    match_result_destroy(exp);
+    return ok;
+}
+
+/**
+ * @brief 指定状态转移表上的trie树和不完全AC自动机匹配，与逐位置比较的结果对比
+ */
+static void search_backend_test(STTableType type, const char *name) {
+    char trie_name[32], ac_name[32];
+    snprintf(trie_name, sizeof(trie_name), "%s trie", name);
+    snprintf(ac_name, sizeof(ac_name), "%s ac", name);
+    unsigned seed = 12345;
+    sttable_case_t tc;
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        case_random(&tc, &seed, round);
+        Trie *trie = trie_create_ex(tc.patterns, tc.pnum, type);
+        got->size = 0;
+        trie_search(trie, tc.s, tc.slen, got);
+        check(case_matches_brute(&tc, got), trie_name, round);
+        trie_destroy(trie);
+
+        AC *ac = ac_create_typed(AC_LEVEL_PART, type);
+        for (int k = 0; k < tc.pnum; k++) {
+            ac_insert(ac, tc.patterns[k], strlen(tc.patterns[k]));
+        }
+        ac_build(ac);
+        got->size = 0;
+        ac_search(ac, tc.s, tc.slen, got);
+        check(case_matches_brute(&tc, got), ac_name, round);
+        ac_destroy(ac);
+    }
+    match_result_destroy(got);
+}
+
+/**
+ * @brief 随机设置、改写和查询转移，与平行的二维数组对比，适用于不依赖trie树的实现
+ *
+ * @param tbl    状态转移表
+ * @param name   名称
+ * @param nstate 状态数
+ * @param nset   设置次数
+ */
+static void sttable_roundtrip(sttable_t *tbl, const char *name, int nstate, int nset) {
+    int *ref = (int *)malloc(sizeof(int) * nstate * CHARSET_SIZE);
+    memset(ref, -1, sizeof(int) * nstate * CHARSET_SIZE);
+    unsigned seed = 12345;
+    for (int i = 0; i < nset; i++) {
+        int fid = rand_next(&seed) % nstate;
+        int c = rand_next(&seed) % CHARSET_SIZE;
+        int tid = rand_next(&seed) % nstate;
+        check(sttable_set(tbl, fid, (char)c, tid) == 0, name, i);
+        ref[fid * CHARSET_SIZE + c] = tid;
+    }
+    int ok = 1;
+    for (int fid = 0; ok && fid < nstate; fid++) {
+        for (int c = 0; ok && c < CHARSET_SIZE; c++) {
+            ok = sttable_get(tbl, fid, (char)c) == ref[fid * CHARSET_SIZE + c];
+        }
+    }
+    check(ok, name, 0);
+    free(ref);
+}
+
+/**
+ * @brief 开放寻址散列表：超过探测上限时扩容重建，扩容前后的转移都能取回
+ */
+static void ohash_test() {
+    sttable_t *tbl = sttable_create(STTABLE_TYPE_OHASH);
+    sttable_roundtrip(tbl, "ohash roundtrip", 2000, 20000);
+    check(tbl->ost.bits > STTABLE_OHASH_DEFAULT_BITS, "ohash grows", 0);
+    check(tbl->ost.max_probe <= STTABLE_OHASH_MAX_PROBE, "ohash probe bound", 0);
+    sttable_destroy(tbl);
+    search_backend_test(STTABLE_TYPE_OHASH, "ohash");
+}
+
+/**
+ * @brief 双数组：先插入一半模式串并匹配，再插入其余模式串，冲突时迁移的单元保持来源和目标一致
+ */
+static void dbarr_test() {
+    unsigned seed = 12345;
+    sttable_case_t tc;
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        case_random(&tc, &seed, round);
+        int half = tc.pnum / 2;
+        Trie *trie = trie_create_ex(tc.patterns, half, STTABLE_TYPE_DBARR);
+        trie_search(trie, tc.s, tc.slen, got);
+        for (int k = half; k < tc.pnum; k++) {
+            trie_insert(trie, tc.patterns[k], strlen(tc.patterns[k]));
+        }
+        got->size = 0;
+        trie_search(trie, tc.s, tc.slen, got);
+        check(case_matches_brute(&tc, got), "dbarr incremental trie", round);
+        trie_destroy(trie);
+    }
+    match_result_destroy(got);
+    search_backend_test(STTABLE_TYPE_DBARR, "dbarr");
+}
+
+/**
+ * @brief 位图稀疏表：往返测试覆盖段满后迁移扩容；各状态转移表上的SBOM与逐位置比较的结果对比
+ */
+static void bitmap_test() {
+    sttable_t *tbl = sttable_create(STTABLE_TYPE_BITMAP);
+    sttable_roundtrip(tbl, "bitmap roundtrip", 500, 20000);
+    sttable_destroy(tbl);
+    search_backend_test(STTABLE_TYPE_BITMAP, "bitmap");
+
+    STTableType types[] = {STTABLE_TYPE_LIST, STTABLE_TYPE_ARRAY, STTABLE_TYPE_HASHT,
+                           STTABLE_TYPE_OHASH, STTABLE_TYPE_BITMAP, STTABLE_TYPE_HYBRID};
+    unsigned seed = 12345;
+    sttable_case_t tc;
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        case_random(&tc, &seed, round);
+        for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+            Oracle *orc = oracle_create_typed(types[t]);
+            for (int k = 0; k < tc.pnum; k++) {
+                oracle_insert(orc, tc.patterns[k], strlen(tc.patterns[k]));
+            }
+            oracle_build(orc);
+            got->size = 0;
+            oracle_search(orc, tc.s, tc.slen, got);
+            check(case_matches_brute(&tc, got), "typed sbom", round);
+            oracle_destroy(orc);
+        }
+    }
+    match_result_destroy(got);
+    check(oracle_create_typed(STTABLE_TYPE_DBARR) == NULL, "typed sbom rejects dbarr", 0);
+}
+
+/**
+ * @brief 混合表：浅层状态转为稠密行，深层状态保留在位图稀疏表，两类状态的转移都能取回
+ */
+static void hybrid_test() {
+    const char *p[] = {"abcdef", "abxyz", "b", "zz"};
+    Trie *trie = trie_create_ex(p, 4, STTABLE_TYPE_HYBRID);
+    int rnum = trie->sttbl->yst.rnum;
+    check(rnum > 0 && rnum < trie->state_num, "hybrid dense rows", 0);
+    int ok = 1;
+    for (int i = 1; ok && i < trie->state_num; i++) {
+        ok = trie_get_trans(trie, trie->states[i].parent, trie->states[i].c) == i;
+    }
+    check(ok, "hybrid roundtrip", 0);
+    trie_destroy(trie);
+    search_backend_test(STTABLE_TYPE_HYBRID, "hybrid");
+}
+
+/**
+ * @brief 混合表构建完全自动机：稀疏状态只保存与默认稠密行不同的转移，匹配、计数与逐位置比较的结果一致
+ */
+static void hybrid_diff_test() {
+    unsigned seed = 12345;
+    sttable_case_t tc;
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        case_random(&tc, &seed, round);
+        AC *ac = ac_create_typed(AC_LEVEL_FULL, STTABLE_TYPE_HYBRID);
+        for (int k = 0; k < tc.pnum; k++) {
+            ac_insert(ac, tc.patterns[k], strlen(tc.patterns[k]));
+        }
+        ac_build(ac);
+        check(ac->trie->sttbl->yst.dflt != NULL, "hybrid diff built", round);
+        got->size = 0;
+        ac_search(ac, tc.s, tc.slen, got);
+        int64_t count = ac_count(ac, tc.s, tc.slen);
+        check(case_matches_brute(&tc, got) && count == got->size, "hybrid diff ac", round);
+        ac_destroy(ac);
+    }
+    match_result_destroy(got);
+}
+
+/**
+ * @brief 有序子节点数组：往返测试覆盖段满后迁移扩容，各状态的转移字符按无符号值严格升序
+ */
+static void list_test() {
+    sttable_t *tbl = sttable_create(STTABLE_TYPE_LIST);
+    sttable_roundtrip(tbl, "list roundtrip", 500, 20000);
+    const struct _sttable_list_s *lst = &tbl->lst;
+    int ok = 1;
+    for (int i = 0; ok && i < 500; i++) {
+        const sttable_list_node_t *node = &lst->nodes[i];
+        for (int j = 1; ok && j < node->num; j++) {
+            ok = lst->chars[node->off + j - 1] < lst->chars[node->off + j];
+        }
+    }
+    check(ok, "list sorted", 0);
+    sttable_destroy(tbl);
+    search_backend_test(STTABLE_TYPE_LIST, "list");
+}
+
+/**
+ * @brief 旧状态与map换算后的新状态深度、终止标记和模式串id一致，新编号按广度优先顺序深度不减
+ */
+static int relayout_map_ok(const TrieState *old, int num, const Trie *trie, const int *map) {
+    if (trie->state_num != num) {
+        return 0;
+    }
+    for (int i = 0; i < num; i++) {
+        const TrieState *state = &trie->states[map[i]];
+        if (state->depth != old[i].depth || state->is_fin != old[i].is_fin
+            || (old[i].is_fin && state->pid != old[i].pid)) {
+            return 0;
+        }
+        if (i > 0 && trie->states[i].depth < trie->states[i - 1].depth) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 广度优先重新编号：trie树在各状态转移表上重排后匹配不变，map换算正确；
+ * 数组和混合表按逆序置换原地重新编号后匹配不变；AC自动机重排后匹配不变
+ */
+static void relayout_test() {
+    STTableType types[] = {STTABLE_TYPE_LIST, STTABLE_TYPE_ARRAY, STTABLE_TYPE_HASHT, STTABLE_TYPE_DBARR,
+                           STTABLE_TYPE_OHASH, STTABLE_TYPE_BITMAP, STTABLE_TYPE_HYBRID};
+    int tnum = sizeof(types) / sizeof(types[0]);
+    unsigned seed = 12345;
+    sttable_case_t tc;
+    match_result_t *got = match_result_create_ex(16, MATCH_RESULT_GROW);
+    for (int round = 0; round < RANDOM_ROUNDS; round++) {
+        case_random(&tc, &seed, round);
+        for (int t = 0; t < tnum; t++) {
+            Trie *trie = trie_create_ex(tc.patterns, tc.pnum, types[t]);
+            int num = trie->state_num;
+            TrieState *old = (TrieState *)malloc(sizeof(TrieState) * num);
+            int *map = (int *)malloc(sizeof(int) * num);
+            memcpy(old, trie->states, sizeof(TrieState) * num);
+            check(trie_relayout(trie, map) == 0 && relayout_map_ok(old, num, trie, map), "trie relayout map", round);
+            got->size = 0;
+            trie_search(trie, tc.s, tc.slen, got);
+            check(case_matches_brute(&tc, got), "trie relayout search", round);
+            if (types[t] == STTABLE_TYPE_ARRAY || types[t] == STTABLE_TYPE_HYBRID) {
+                // 初始状态不变，其余状态逆序
+                for (int i = 1; i < num; i++) {
+                    map[i] = num - i;
+                }
+                map[0] = 0;
+                check(trie_renumber(trie, map) == 0, "trie renumber", round);
+                got->size = 0;
+                trie_search(trie, tc.s, tc.slen, got);
+                check(case_matches_brute(&tc, got), "trie renumber search", round);
+            }
+            free(map);
+            free(old);
+            trie_destroy(trie);
+
+            AC *ac = ac_create_typed(AC_LEVEL_PART, types[t]);
+            for (int k = 0; k < tc.pnum; k++) {
+                ac_insert(ac, tc.patterns[k], strlen(tc.patterns[k]));
+            }
+            ac_build(ac);
+            check(ac_relayout(ac, NULL) == 0, "ac relayout", round);
+            got->size = 0;
+            ac_search(ac, tc.s, tc.slen, got);
+            check(case_matches_brute(&tc, got), "ac relayout search", round);
+            ac_destroy(ac);
+        }
+        AC *ac = ac_create_ex(tc.patterns, tc.pnum, AC_LEVEL_FULL);
+        check(ac_relayout(ac, NULL) == 0, "ac full relayout", round);
+        got->size = 0;
+        ac_search(ac, tc.s, tc.slen, got);
+        check(case_matches_brute(&tc, got), "ac full relayout search", round);
+        ac_destroy(ac);
+    }
+    match_result_destroy(got);
+}
+
+int main() {
+    ohash_test();
+    dbarr_test();
+    bitmap_test();
+    hybrid_test();
+    hybrid_diff_test();
+    list_test();
+    relayout_test();
+    printf("test_sttable: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
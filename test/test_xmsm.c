@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "trie.h"
@@ -13,10 +14,50 @@
 
 static STTableType type = STTABLE_TYPE_ARRAY;
 
+static int failed = 0;
+
+// 期望的匹配项，以长度为0的项结尾
+typedef struct {
+    int pos;
+    int len;
+} expect_item_t;
+
+static int item_cmp(const void *a, const void *b) {
+    const match_item_t *x = (const match_item_t *)a, *y = (const match_item_t *)b;
+    if (x->pos != y->pos) {
+        return x->pos < y->pos ? -1 : 1;
+    }
+    return x->len - y->len;
+}
+
+/**
+ * @brief 匹配项按位置和长度排序后与期望逐项比较
+ */
+static void check_result(const char *name, match_result_t *result, const expect_item_t *expect) {
+    int num = 0;
+    while (expect[num].len != 0) {
+        ++num;
+    }
+    qsort(result->items, result->size, sizeof(match_item_t), item_cmp);
+    int ok = result->size == num;
+    for (int i = 0; ok && i < num; i++) {
+        ok = result->items[i].pos == expect[i].pos && result->items[i].len == expect[i].len;
+    }
+    if (!ok) {
+        printf("%s failed\n", name);
+        ++failed;
+    }
+}
+
+// 文本AGATACGATATATAC中各模式串的全部匹配
+static const expect_item_t all_matches[] = {
+    {2, 2}, {4, 7}, {5, 3}, {7, 2}, {7, 7}, {8, 5}, {9, 2}, {11, 2}, {0, 0}
+};
+
 static void print_result(const char *name, const char *s, const match_result_t* result) {
     printf("%16s: ", name);
     for (int i = 0; i < result->size; i++) {
-        int pos = result->items[i].pos;
+        int pos = (int)result->items[i].pos;
         printf("(%d, %c", pos, s[pos]);
         for (int j = 1; j < result->items[i].len; j++) {
             printf("%c", s[pos + j]);
@@ -26,19 +67,12 @@ static void print_result(const char *name, const char *s, const match_result_t*
     printf("\n");
 }
 
-static void print_state(Trie *trie) {
-    trie_make_bfs(trie);
-    for (int i = 0; i < trie->state_num; i++) {
-        TrieState *state = trie->bfs_states[i];
-        printf("state: id=%d depth=%d char=%c\n", state->id, state->depth, state->c);
-    }
-}
-
 static void trie_search_test(const char *s, int slen, const char **patterns, int num) {
     Trie* trie = trie_create_ex(patterns, num, type);
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     trie_search(trie, s, slen, result);
     print_result("trie search", s, result);
+    check_result("trie search", result, all_matches);
     match_result_destroy(result);
     trie_destroy(trie);
 }
@@ -48,6 +82,7 @@ static void ac_full_search_test(const char *s, int slen, const char **patterns,
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     ac_search(ac, s, slen, result);
     print_result("ac_full search", s, result);
+    check_result("ac_full search", result, all_matches);
     match_result_destroy(result);
     ac_destroy(ac);
 }
@@ -57,15 +92,60 @@ static void ac_part_search_test(const char *s, int slen, const char **patterns,
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     ac_search(ac, s, slen, result);
     print_result("ac_part search", s, result);
+    check_result("ac_part search", result, all_matches);
+    match_result_destroy(result);
+    ac_destroy(ac);
+}
+
+static void ac_image_search_test(const char *s, int slen, const char **patterns, int num) {
+    const char *path = "test_xmsm_ac.img";
+    AC* built = ac_create_ex(patterns, num, AC_LEVEL_FULL);
+    int ret = ac_save(built, path);
+    ac_destroy(built);
+    AC* ac = ret == 0 ? ac_load(path, 1) : NULL;
+    if (ac == NULL) {
+        printf("ac_image load failed\n");
+        ++failed;
+        remove(path);
+        return;
+    }
+    match_result_t *result = match_result_create(MAX_MATCH_NUM);
+    ac_search(ac, s, slen, result);
+    print_result("ac_image search", s, result);
+    check_result("ac_image search", result, all_matches);
+    match_result_destroy(result);
+    ac_destroy(ac);
+    remove(path);
+}
+
+/**
+ * @brief 最左优先按模式串顺序取同一起点的匹配，最左最长取同一起点最长的匹配
+ */
+static void ac_kind_search_test() {
+    const char *s = "Samwise and Sam";
+    const char *p[] = {"Sam", "Samwise"};
+    const expect_item_t first[] = {{0, 3}, {12, 3}, {0, 0}};
+    const expect_item_t longest[] = {{0, 7}, {12, 3}, {0, 0}};
+    int slen = strlen(s);
+    AC* ac = ac_create_ex(p, 2, AC_LEVEL_FULL);
+    match_result_t *result = match_result_create(MAX_MATCH_NUM);
+    ac_search_kind(ac, s, slen, MATCH_KIND_LEFTMOST_FIRST, result);
+    print_result("ac leftmost-first search", s, result);
+    check_result("ac leftmost-first search", result, first);
+    result->size = 0;
+    ac_search_kind(ac, s, slen, MATCH_KIND_LEFTMOST_LONGEST, result);
+    print_result("ac leftmost-longest search", s, result);
+    check_result("ac leftmost-longest search", result, longest);
     match_result_destroy(result);
     ac_destroy(ac);
 }
 
 static void sbom_search_test(const char *s, int slen, const char **patterns, int num) {
-    Oracle *orc = oracle_create_ex(patterns, num, type);
+    Oracle *orc = oracle_create_ex(patterns, num);
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     oracle_search(orc, s, slen, result);
     print_result("sbom search", s, result);
+    check_result("sbom search", result, all_matches);
     match_result_destroy(result);
     oracle_destroy(orc);
 }
@@ -75,6 +155,7 @@ static void shift_search_test(const char *s, int slen, const char **patterns, in
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     shift_nfa_search(nfa, s, slen, result);
     print_result("shift search", s, result);
+    check_result("shift search", result, all_matches);
     match_result_destroy(result);
     shift_nfa_destroy(nfa);
 }
@@ -84,6 +165,7 @@ static void bndm_search_test(const char *s, int slen, const char **patterns, int
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     bndm_nfa_search(nfa, s, slen, result);
     print_result("bndm search", s, result);
+    check_result("bndm search", result, all_matches);
     match_result_destroy(result);
     bndm_nfa_destroy(nfa);
 }
@@ -93,6 +175,7 @@ static void horspool_search_test(const char *s, int slen, const char **patterns,
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     horspool_trie_search(hsp, s, slen, result);
     print_result("horspool search", s, result);
+    check_result("horspool search", result, all_matches);
     match_result_destroy(result);
     horspool_destroy(hsp);
 }
@@ -102,6 +185,7 @@ static void wum_search_test(const char *s, int slen, const char **patterns, int
     match_result_t *result = match_result_create(MAX_MATCH_NUM);
     wum_search(wum, s, slen, result);
     print_result("wum search", s, result);
+    check_result("wum search", result, all_matches);
     match_result_destroy(result);
     wum_destroy(wum);
 }
@@ -118,10 +202,13 @@ int main() {
     trie_search_test(s, slen, p, pnum);
     ac_full_search_test(s, slen, p, pnum);
     ac_part_search_test(s, slen, p, pnum);
+    ac_image_search_test(s, slen, p, pnum);
+    ac_kind_search_test();
     sbom_search_test(s, slen, p, pnum);
     shift_search_test(s, slen, p, pnum);
     bndm_search_test(s, slen, p, pnum);
     horspool_search_test(s, slen, p, pnum);
     wum_search_test(s, slen, p, pnum);
-    return 0;
-}
\ No newline at end of file
+    printf("test_xmsm: %s\n", failed ? "FAILED" : "OK");
+    return failed != 0;
+}
@@ -1,6 +1,125 @@
+#include <stdlib.h>
 #include <string.h>
 #include "xssm.h"
 
+#define RANDOM_ROUNDS 2000
+
+static int failed = 0;
+
+static void check(int cond, const char *name, int round) {
+	if (!cond) {
+		printf("%s failed, round %d\n", name, round);
+		++failed;
+	}
+}
+
+static unsigned rand_next(unsigned *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 16;
+}
+
+/**
+ * @brief 与逐位置比较的结果对比，单模式串的匹配按位置递增报告
+ */
+static int matches_brute(const match_result_t *result, const char *s, int slen, const char *p, int plen) {
+	int num = 0;
+	for (int i = 0; i + plen <= slen; i++) {
+		if (memcmp(s + i, p, plen) == 0) {
+			if (num >= result->size || result->items[num].pos != i || result->items[num].len != plen) {
+				return 0;
+			}
+			++num;
+		}
+	}
+	return num == result->size;
+}
+
+/**
+ * @brief 预编译一个模式串并匹配，与逐位置比较的结果对比
+ * 文本拷贝到恰好slen字节的堆内存，越过文本末尾的读取由地址检查发现
+ */
+#define PATTERN_CHECK(name, create, search, destroy)                                   \
+	do {                                                                           \
+		void *obj = create(p, plen);                                               \
+		check(obj != NULL, name ": create", round);                                \
+		if (obj != NULL) {                                                         \
+			result->size = 0;                                                      \
+			search(obj, text, slen, result);                                       \
+			check(matches_brute(result, text, slen, p, plen), name, round);       \
+			destroy(obj);                                                          \
+		}                                                                          \
+	} while (0)
+
+static void pattern_check_all(const char *s, int slen, const char *p, int plen, int round) {
+	char *text = (char *)malloc(slen > 0 ? slen : 1);
+	memcpy(text, s, slen);
+	match_result_t *result = match_result_create_ex(16, MATCH_RESULT_GROW);
+	PATTERN_CHECK("kmp", kmp_pattern_create, kmp_pattern_search, kmp_pattern_destroy);
+	PATTERN_CHECK("fam", fam_pattern_create, fam_pattern_search, fam_pattern_destroy);
+	PATTERN_CHECK("bm", bm_pattern_create, bm_pattern_search, bm_pattern_destroy);
+	PATTERN_CHECK("horspool", horspool_pattern_create, horspool_pattern_search, horspool_pattern_destroy);
+	PATTERN_CHECK("sunday", sunday_pattern_create, sunday_pattern_search, sunday_pattern_destroy);
+	PATTERN_CHECK("bom", bom_pattern_create, bom_pattern_search, bom_pattern_destroy);
+	PATTERN_CHECK("karp rabin", kr_pattern_create, kr_pattern_search, kr_pattern_destroy);
+	// 位并行算法的模式串不超过64个字符
+	if (plen <= 64) {
+		PATTERN_CHECK("shift and", shift_and_pattern_create, shift_and_pattern_search, shift_and_pattern_destroy);
+		PATTERN_CHECK("shift or", shift_or_pattern_create, shift_or_pattern_search, shift_or_pattern_destroy);
+		PATTERN_CHECK("bndm", bndm_pattern_create, bndm_pattern_search, bndm_pattern_destroy);
+	}
+	match_result_destroy(result);
+	free(text);
+}
+
+/**
+ * @brief 随机文本和模式串，覆盖高位字节、模式串长于文本和文本末尾的匹配
+ */
+static void pattern_random_test() {
+	const char *alphas[] = {"ab", "ACGT", "abcdefghij", "\x01\x80\x81\xfe\xff"};
+	int anum = sizeof(alphas) / sizeof(alphas[0]);
+	unsigned seed = 12345;
+	for (int round = 0; round < RANDOM_ROUNDS; round++) {
+		const char *alpha = alphas[round % anum];
+		int an = strlen(alpha);
+		char s[256], p[80];
+		int slen = rand_next(&seed) % 200;
+		int plen = 1 + rand_next(&seed) % 70;
+		for (int i = 0; i < slen; i++) {
+			s[i] = alpha[rand_next(&seed) % an];
+		}
+		// 多数模式串取自文本，保证有匹配；文本末尾的子串覆盖结尾处的读取
+		int from = slen >= plen ? (int)(rand_next(&seed) % 3) : 0;
+		for (int j = 0; j < plen; j++) {
+			p[j] = alpha[rand_next(&seed) % an];
+		}
+		if (from == 1) {
+			memcpy(p, s + rand_next(&seed) % (slen - plen + 1), plen);
+		} else if (from == 2) {
+			memcpy(p, s + slen - plen, plen);
+		}
+		pattern_check_all(s, slen, p, plen, round);
+	}
+}
+
+/**
+ * @brief 边界情况：模式串长于文本、位并行算法的64字符上限、sunday读取文本末尾之后的字符
+ */
+static void pattern_bound_test() {
+	char s[130], p[65];
+	memset(s, 'a', sizeof(s));
+	memset(p, 'a', sizeof(p));
+	pattern_check_all(s, 3, p, 4, 0);
+	pattern_check_all(s, 0, p, 1, 0);
+	pattern_check_all(s, sizeof(s), p, 64, 0);
+	pattern_check_all(s, sizeof(s), p, 65, 0);
+	check(shift_and_pattern_create(p, 65) == NULL, "shift and: plen 65", 0);
+	check(shift_or_pattern_create(p, 65) == NULL, "shift or: plen 65", 0);
+	check(bndm_pattern_create(p, 65) == NULL, "bndm: plen 65", 0);
+	// 匹配恰好结束在文本末尾时，sunday不能读取s[slen]
+	pattern_check_all("xxabcd", 6, "abcd", 4, 0);
+	pattern_check_all("abcd", 4, "abcd", 4, 0);
+}
+
 typedef struct {
 	char name[16];
 	void (*func) (const char *, const char *, int, int);
@@ -27,10 +146,13 @@ int main() {
 	//const char *p = "ATATA";
 	int slen = strlen(s);
 	int plen = strlen(p);
-	for (int i = 0; i < sizeof(funcs) / sizeof(ssm_func_t); i++) {
+	for (size_t i = 0; i < sizeof(funcs) / sizeof(ssm_func_t); i++) {
 		printf("%10s: ", funcs[i].name);
 		funcs[i].func(s, p, slen, plen);
 		printf("\n");
 	}
-	return 0;
+	pattern_random_test();
+	pattern_bound_test();
+	printf("test_xssm: %s\n", failed ? "FAILED" : "OK");
+	return failed != 0;
 }
\ No newline at end of file